@@ -1,33 +1,57 @@
 TEMPLATE =   app
-QT +=   xml widgets
+QT +=   widgets
 
 HEADERS =   mainwindow.h \
             projectview.h \
             version.h \
-            treewidgetitem.h \
+            scriptmodel.h \
             scriptconf.h \
             scriptqueue.h \
             scriptprocess.h \
+            scriptjob.h \
+            resourceusage.h \
+            benchmark.h \
+            runstate.h \
+            sweep.h \
+            resultcache.h \
+            processsampler.h \
+            projectreader.h \
+            logwriter.h \
             textedit.h \
             lineedit.h \
             scripttree.h \
             filesystemtreeview.h \
             texteditmonitor.h \
             monitorview.h \
-            settings.h
+            settings.h \
+            outputcoalescer.h \
+            consoleview.h
 SOURCES =   main.cpp \
             projectview.cpp \
             mainwindow.cpp \
-            treewidgetitem.cpp \
+            scriptmodel.cpp \
             scriptconf.cpp \
             scriptqueue.cpp \
             scriptprocess.cpp \
+            scriptjob.cpp \
+            resourceusage.cpp \
+            benchmark.cpp \
+            runstate.cpp \
+            sweep.cpp \
+            resultcache.cpp \
+            processsampler.cpp \
+            projectreader.cpp \
+            logwriter.cpp \
             textedit.cpp \
             lineedit.cpp \
             scripttree.cpp \
             filesystemtreeview.cpp \
             texteditmonitor.cpp \
             monitorview.cpp \
-            settings.cpp
+            settings.cpp \
+            outputcoalescer.cpp \
+            consoleview.cpp
+unix:HEADERS +=   spawnserver.h
+unix:SOURCES +=   spawnserver.cpp
 TRANSLATIONS =   qrunner_it.ts qrunner_de.ts qrunner_fr.ts
 RESOURCES =   qrunner.qrc
@@ -0,0 +1,501 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QFile>
+#include <QtCore/QDir>
+#include <QtCore/QXmlStreamWriter>
+#include <QtCore/QAtomicInt>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "version.h"
+#include "scriptjob.h"
+#include "scriptqueue.h"
+#include "scriptprocess.h"
+#include "projectreader.h"
+#ifndef Q_OS_WIN
+  #include "spawnserver.h"
+#endif
+
+/**
+ * The exit codes of the benchmarks
+ */
+enum ExitCode { Success = 0, BenchFailed = 1, BadArguments = 2 };
+
+/**
+ * The memory allocations of the whole process, all the threads included
+ */
+static QBasicAtomicInt s_allocations = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+#ifdef __GLIBC__
+/*
+ * Count the allocations: malloc(), calloc() and realloc() defined here are
+ * used instead of the glibc ones, new included, and call their glibc implementation
+ */
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+  s_allocations.ref();
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+  s_allocations.ref();
+  return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+  s_allocations.ref();
+  return __libc_realloc(ptr, size);
+}
+#endif
+
+/**
+ * Hide the debug messages: the benchmarks write just their results
+ */
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+  Q_UNUSED(context);
+  if (type != QtDebugMsg)
+    fprintf(stderr, "%s\n", qPrintable(msg));
+}
+
+
+/**
+ * @returns the microseconds each item took
+ */
+static double perItem(qint64 nsecs, int count)
+{
+  return (count > 0) ? nsecs / 1000.0 / count : 0;
+}
+
+
+/**
+ * Complete synthetic scripts through the finish path of the queue: the
+ * scheduler starts each script and the script ends correctly as soon as it
+ * started, without a process, so what is measured is the bookkeeping of the
+ * queue (executedOK(), the free slot, the next ready script) and the lookups
+ *
+ * @param count is the number of scripts
+ *
+ * @returns the exit code of the benchmark
+ */
+static int benchQueue(int count)
+{
+  // the log directory cannot be created: the scripts don't write anything
+  QTemporaryDir dir;
+  QFile blocker(dir.path() + "/blocker");
+  if (!dir.isValid() || !blocker.open(QIODevice::WriteOnly))
+  {
+    fprintf(stderr, "cannot create the temporary directory\n");
+    return BenchFailed;
+  }
+  blocker.close();
+
+  ScriptQueue queue;
+  queue.assignBaseDir(blocker.fileName() + "/logs");
+
+  QElapsedTimer timer;
+  timer.start();
+  QList<ScriptProcess*> scripts;
+  for (int i = 0; i < count; i++)
+  {
+    ScriptJob job;
+    job.setName(QString("/qrunner-bench/script%1.sh").arg(i));
+    ScriptProcess *proc = queue.add(job, i + 1);
+
+    // the script ends correctly when it starts: its log that cannot be opened is not heard
+    QObject::disconnect(proc, SIGNAL(finishedBad(ScriptProcess*)), &queue, 0);
+    QObject::connect(proc, SIGNAL(running(ScriptProcess*)), proc, SIGNAL(finishedOK(ScriptProcess*)));
+    scripts.append(proc);
+  }
+  qint64 queued = timer.nsecsElapsed();
+
+  // the scripts end while they start: the whole queue is done when run() returns
+  timer.restart();
+  queue.run();
+  qint64 finished = timer.nsecsElapsed();
+  int ended = queue.countDone();
+
+  timer.restart();
+  int found = 0;
+  for (int i = 0; i < scripts.size(); i++)
+  {
+    if (queue.lookforScript(scripts.at(i)) == i + 1)
+      found++;
+  }
+  qint64 looked = timer.nsecsElapsed();
+
+  printf("queue: %d scripts\n", count);
+  printf("  queued              %8.3f us/script\n", perItem(queued, count));
+  printf("  started and ended   %8.3f us/script (%d ended)\n", perItem(finished, count), ended);
+  printf("  lookforScript()     %8.3f us/script (%d found)\n", perItem(looked, count), found);
+  return ((ended == count) && (found == count)) ? Success : BenchFailed;
+}
+
+
+/**
+ * Execute a script that writes some text on its standard output and count the
+ * memory allocations of QRunner while it reads the output and writes the log:
+ * the spawn helper path (readSpawnedOutput()) or the QProcess one (readChannel())
+ *
+ * @param mbytes is the MB the script writes
+ * @param spawned is true if the spawn helper started the script
+ *
+ * @returns the exit code of the benchmark
+ */
+static int benchOutput(int mbytes, bool spawned)
+{
+#ifndef __GLIBC__
+  Q_UNUSED(mbytes);
+  Q_UNUSED(spawned);
+  fprintf(stderr, "the allocations are counted only with the GNU C library\n");
+  return BenchFailed;
+#else
+  QTemporaryDir dir;
+  QFile script(dir.path() + "/output.sh");
+  if (!dir.isValid() || !script.open(QIODevice::WriteOnly))
+  {
+    fprintf(stderr, "cannot create the temporary directory\n");
+    return BenchFailed;
+  }
+  script.write("#!/bin/sh\n"
+               "# write $1 bytes of text on the standard output\n"
+               "yes 'QRunner benchmark output: 0123456789 abcdefghijklmnopqrstuvwxyz' | head -c \"$1\"\n");
+  script.close();
+  script.setPermissions(script.permissions() | QFile::ExeOwner);
+
+#ifndef Q_OS_WIN
+  if (spawned && !SpawnServer::instance())
+  {
+    fprintf(stderr, "the spawn helper is not running\n");
+    return BenchFailed;
+  }
+#endif
+
+  ScriptJob job;
+  job.setName(script.fileName());
+  job.setParameters(QString::number((qint64)mbytes * 1024 * 1024));
+  ScriptQueue queue;
+  queue.assignBaseDir(dir.path() + "/logs");
+  queue.setMaxParallel(1);
+  ScriptProcess *proc = queue.add(job);
+  // queued: the script can fail before the event loop is running
+  QObject::connect(&queue, SIGNAL(allScriptExecuted()), QCoreApplication::instance(), SLOT(quit()),
+    Qt::QueuedConnection);
+
+  // the allocations to start the script and the event loop are counted too
+  QElapsedTimer timer;
+  timer.start();
+  int before = s_allocations.load();
+  queue.run();
+  QCoreApplication::exec();
+  int allocations = s_allocations.load() - before;
+  qint64 elapsed = timer.elapsed();
+
+  printf("output: %d MB %s\n", mbytes, spawned ? "from the spawn helper (readSpawnedOutput)" :
+    "from QProcess (readChannel)");
+  printf("  allocations         %8d (%.1f per MB)\n", allocations, (mbytes > 0) ? (double)allocations / mbytes : 0);
+  printf("  elapsed             %8lld ms\n", elapsed);
+  if (proc->returnCode() != 0)
+  {
+    fprintf(stderr, "the script failed with exit code %d\n", proc->returnCode());
+    return BenchFailed;
+  }
+  return Success;
+#endif
+}
+
+
+/**
+ * Check that the points of a sweep that only changes the parameters get the
+ * QRunner environment, PATH included, plus their task variables
+ *
+ * @returns the exit code of the check
+ */
+static int checkSweepEnvironment()
+{
+  QTemporaryDir dir;
+  QFile script(dir.path() + "/env.sh");
+  if (!dir.isValid() || !script.open(QIODevice::WriteOnly))
+  {
+    fprintf(stderr, "cannot create the temporary directory\n");
+    return BenchFailed;
+  }
+  script.write("#!/bin/sh\n"
+               "# fail if the environment has been replaced by the task variables\n"
+               "test -n \"$PATH\" && test -n \"$QRUNNER_TASK_ID\"\n");
+  script.close();
+  script.setPermissions(script.permissions() | QFile::ExeOwner);
+
+  Sweep sweep;
+  sweep.addParameters(QStringList() << "first" << "second");
+  ScriptJob job;
+  job.setName(script.fileName());
+  job.setSweep(sweep);
+
+  ScriptQueue queue;
+  queue.assignBaseDir(dir.path() + "/logs");
+  QList<ScriptProcess*> points = queue.addSweep(job);
+  QObject::connect(&queue, SIGNAL(allScriptExecuted()), QCoreApplication::instance(), SLOT(quit()),
+    Qt::QueuedConnection);
+  queue.run();
+  QCoreApplication::exec();
+
+  int failed = 0;
+  for (int i = 0; i < points.size(); i++)
+  {
+    if (points.at(i)->returnCode() != 0)
+    {
+      fprintf(stderr, "the sweep point %d did not get PATH\n", points.at(i)->taskId());
+      failed++;
+    }
+  }
+  printf("sweep-env: %d points, %d without PATH\n", points.size(), failed);
+  return (failed == 0) ? Success : BenchFailed;
+}
+
+
+/**
+ * This class reads a project and just counts its groups and scripts
+ *
+ * @author Giovanni Venturi
+ */
+class CountingReader : public ProjectReader
+{
+  public:
+    CountingReader()
+    {
+      m_groups = m_scripts = 0;
+    }
+
+    /**
+     * @returns the number of groups read, the sub groups included
+     */
+    int groups() const
+    {
+      return m_groups;
+    }
+
+    /**
+     * @returns the number of scripts read
+     */
+    int scripts() const
+    {
+      return m_scripts;
+    }
+
+  protected:
+    void beginGroup(const QString& name, bool checked, const QString& mode, int timeout)
+    {
+      Q_UNUSED(name);
+      Q_UNUSED(checked);
+      Q_UNUSED(mode);
+      Q_UNUSED(timeout);
+      m_groups++;
+    }
+
+    void endGroup()
+    {
+    }
+
+    void addScript(const QString& fileName, bool checked, const ScriptJob& job)
+    {
+      Q_UNUSED(fileName);
+      Q_UNUSED(checked);
+      Q_UNUSED(job);
+      m_scripts++;
+    }
+
+  private:
+    /**
+     * The number of groups read
+     */
+    int m_groups;
+
+    /**
+     * The number of scripts read
+     */
+    int m_scripts;
+};
+
+
+/**
+ * Write a project with some scripts and time how long reading it takes. The
+ * project has 100 groups, each one with sub groups of 20 scripts in their own
+ * directory; the scripts have parameters, an environment variable and wait for
+ * the previous script of their sub group
+ *
+ * @param count is the number of scripts
+ *
+ * @returns the exit code of the benchmark
+ */
+static int benchLoad(int count)
+{
+  QTemporaryDir dir;
+  QFile project(dir.path() + "/bench.qrprj");
+  if (!dir.isValid() || !project.open(QIODevice::WriteOnly))
+  {
+    fprintf(stderr, "cannot create the temporary directory\n");
+    return BenchFailed;
+  }
+
+  const int ScriptsPerSubgroup = 20;
+  int subgroups = (count + ScriptsPerSubgroup - 1) / ScriptsPerSubgroup;
+  int subgroupsPerGroup = (subgroups + 99) / 100;
+
+  QXmlStreamWriter xml(&project);
+  xml.setAutoFormatting(true);
+  xml.writeStartDocument();
+  xml.writeStartElement("project");
+  for (int i = 0, sub = 0; sub < subgroups; i++)
+  {
+    xml.writeStartElement("group");
+    xml.writeAttribute("name", QString("group %1").arg(i));
+    xml.writeAttribute("checked", "true");
+    xml.writeAttribute("mode", "parallel:4");
+    for (int j = 0; (j < subgroupsPerGroup) && (sub < subgroups); j++, sub++)
+    {
+      // the reader checks that the directory of the scripts exists
+      QString path = QString("%1/scripts/%2").arg(dir.path()).arg(sub);
+      QDir().mkpath(path);
+
+      xml.writeStartElement("subgroup");
+      xml.writeAttribute("name", QString("subgroup %1").arg(sub));
+      xml.writeAttribute("checked", "true");
+      xml.writeAttribute("mode", "serial");
+      for (int k = 0; (k < ScriptsPerSubgroup) && (sub * ScriptsPerSubgroup + k < count); k++)
+      {
+        int id = sub * ScriptsPerSubgroup + k;
+        xml.writeStartElement("file");
+        xml.writeAttribute("path", path);
+        xml.writeAttribute("name", QString("script%1.sh").arg(id));
+        xml.writeAttribute("checked", "true");
+        xml.writeAttribute("parameters", QString("--input data%1.txt --verbose").arg(id));
+        xml.writeAttribute("id", QString("s%1").arg(id));
+        if (k > 0)
+          xml.writeAttribute("after", QString("s%1").arg(id - 1));
+        xml.writeStartElement("environment");
+        xml.writeEmptyElement("env");
+        xml.writeAttribute("name", "QRUNNER_BENCH");
+        xml.writeAttribute("value", QString::number(id));
+        xml.writeEndElement();
+        xml.writeEndElement();
+      }
+      xml.writeEndElement();
+    }
+    xml.writeEndElement();
+  }
+  xml.writeEndElement();
+  xml.writeEndDocument();
+  project.close();
+
+  // the best of some reads: the first one warms up the file system cache
+  qint64 best = -1;
+  int groups = 0;
+  int scripts = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    CountingReader reader;
+    QElapsedTimer timer;
+    timer.start();
+    if (!reader.read(project.fileName()))
+    {
+      fprintf(stderr, "%s\n", qPrintable(reader.errorString()));
+      return BenchFailed;
+    }
+    qint64 elapsed = timer.nsecsElapsed();
+    if ((best < 0) || (elapsed < best))
+      best = elapsed;
+    groups = reader.groups();
+    scripts = reader.scripts();
+  }
+
+  printf("load: %d scripts in %d groups, %lld KB\n", scripts, groups, project.size() / 1024);
+  printf("  ProjectReader::read() %8.3f ms (%.3f us/script)\n", best / 1000000.0, perItem(best, count));
+  return (scripts == count) ? Success : BenchFailed;
+}
+
+
+int main(int argc, char *argv[])
+{
+#ifndef Q_OS_WIN
+  // fork the helper that starts the scripts before any thread is created:
+  //  not when the output read by QProcess is measured
+  bool helper = true;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "output-qprocess") == 0)
+      helper = false;
+  }
+  if (helper)
+    SpawnServer::start();
+#endif
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("qrunner-bench");
+  QCoreApplication::setApplicationVersion(qrunnerVersion);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Measure the QRunner internals on synthetic workloads");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption countOption(QStringList() << "n" << "count",
+    "Use <n> scripts (default: 50000 for queue, 20000 for load).", "n");
+  parser.addOption(countOption);
+  QCommandLineOption mbytesOption(QStringList() << "m" << "mbytes",
+    "Make the script write <mb> MB of output (default: 64).", "mb", "64");
+  parser.addOption(mbytesOption);
+  QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "Show the debug messages.");
+  parser.addOption(verboseOption);
+  parser.addPositionalArgument("benchmark", "The benchmark to run: \"queue\" (the finish path of the scripts), "
+    "\"output\" (the allocations per MB of output read from the spawn helper), \"output-qprocess\" "
+    "(the same from QProcess), \"load\" (the time to read a generated project) or \"sweep-env\" "
+    "(check that the sweep points inherit the environment).");
+  parser.process(app);
+
+  if (parser.positionalArguments().size() != 1)
+    parser.showHelp(BadArguments);
+
+  if (!parser.isSet(verboseOption))
+    qInstallMessageHandler(quietMessageHandler);
+
+  QString benchmark = parser.positionalArguments().at(0);
+  if (benchmark == "queue")
+    return benchQueue(parser.isSet(countOption) ? parser.value(countOption).toInt() : 50000);
+  if ((benchmark == "output") || (benchmark == "output-qprocess"))
+    return benchOutput(parser.value(mbytesOption).toInt(), benchmark == "output");
+  if (benchmark == "sweep-env")
+    return checkSweepEnvironment();
+  if (benchmark == "load")
+    return benchLoad(parser.isSet(countOption) ? parser.value(countOption).toInt() : 20000);
+
+  fprintf(stderr, "unknown benchmark: %s\n", qPrintable(benchmark));
+  return BadArguments;
+}
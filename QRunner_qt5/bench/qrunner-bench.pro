@@ -0,0 +1,33 @@
+TEMPLATE =   app
+TARGET =   qrunner-bench
+QT =   core
+CONFIG +=   console
+CONFIG -=   app_bundle
+INCLUDEPATH +=   ..
+
+HEADERS =   ../version.h \
+            ../scriptjob.h \
+            ../resourceusage.h \
+            ../benchmark.h \
+            ../runstate.h \
+            ../sweep.h \
+            ../resultcache.h \
+            ../processsampler.h \
+            ../scriptprocess.h \
+            ../scriptqueue.h \
+            ../projectreader.h \
+            ../logwriter.h
+SOURCES =   main.cpp \
+            ../scriptjob.cpp \
+            ../resourceusage.cpp \
+            ../benchmark.cpp \
+            ../runstate.cpp \
+            ../sweep.cpp \
+            ../resultcache.cpp \
+            ../processsampler.cpp \
+            ../scriptprocess.cpp \
+            ../scriptqueue.cpp \
+            ../projectreader.cpp \
+            ../logwriter.cpp
+unix:HEADERS +=   ../spawnserver.h
+unix:SOURCES +=   ../spawnserver.cpp
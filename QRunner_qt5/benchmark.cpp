@@ -0,0 +1,309 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonArray>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include <math.h>
+
+#include "benchmark.h"
+
+namespace
+{
+  // a median has to grow by more than this fraction to be a regression...
+  const double Tolerance = 0.05;
+
+  // ...and by more than this many baseline standard deviations
+  const double Deviations = 2.0;
+
+  /**
+   * @returns the percentile @p p (0-1) of the sorted @p values, interpolating between two values
+   */
+  double percentile(const QList<double>& values, double p)
+  {
+    double position = (values.size() - 1) * p;
+    int lower = (int)floor(position);
+    if (lower + 1 >= values.size())
+      return values.last();
+    return values.at(lower) + (position - lower) * (values.at(lower + 1) - values.at(lower));
+  }
+
+  /**
+   * @returns the statistics read from the JSON object written by a previous benchmark
+   */
+  Benchmark::Statistics readStatistics(const QJsonObject& json)
+  {
+    Benchmark::Statistics stats;
+    stats.count = json.value("count").toInt();
+    stats.min = json.value("min").toDouble();
+    stats.mean = json.value("mean").toDouble();
+    stats.median = json.value("median").toDouble();
+    stats.p95 = json.value("p95").toDouble();
+    stats.stddev = json.value("stddev").toDouble();
+    return stats;
+  }
+}
+
+Benchmark::Benchmark()
+{
+  m_failedRuns = 0;
+  m_hasBaseline = false;
+  m_baselineWall.count = m_baselineCpu.count = 0;
+}
+
+
+void Benchmark::addRun(double wallTime, const ResourceUsage& usage, bool ok)
+{
+  if (!ok)
+  {
+    // the time of a failed run doesn't tell how fast the script is
+    m_failedRuns++;
+    return;
+  }
+
+  m_runs.append(runs() + 1);
+  m_wallTimes.append(wallTime);
+  if (usage.isValid())
+    m_cpuTimes.append((usage.userTime() + usage.systemTime()) / 1000.0);
+}
+
+
+int Benchmark::runs() const
+{
+  return m_wallTimes.size() + m_failedRuns;
+}
+
+
+int Benchmark::failedRuns() const
+{
+  return m_failedRuns;
+}
+
+
+Benchmark::Statistics Benchmark::wallTime() const
+{
+  return statistics(m_wallTimes, m_runs);
+}
+
+
+Benchmark::Statistics Benchmark::cpuTime() const
+{
+  // the CPU time is compared only if all the runs have it
+  if (m_cpuTimes.size() != m_wallTimes.size())
+    return statistics(QList<double>(), QList<int>());
+  return statistics(m_cpuTimes, m_runs);
+}
+
+
+bool Benchmark::loadBaseline(const QString& fileName)
+{
+  m_hasBaseline = false;
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+  if (!json.value("wall_ms").isObject())
+  {
+    qDebug() << fileName << "is not a benchmark results file";
+    return false;
+  }
+
+  m_baselineWall = readStatistics(json.value("wall_ms").toObject());
+  m_baselineCpu = readStatistics(json.value("cpu_ms").toObject());
+  m_hasBaseline = (m_baselineWall.count > 0);
+  return m_hasBaseline;
+}
+
+
+bool Benchmark::hasBaseline() const
+{
+  return m_hasBaseline;
+}
+
+
+bool Benchmark::regressed() const
+{
+  if (!m_hasBaseline)
+    return false;
+
+  return slower(wallTime(), m_baselineWall) || slower(cpuTime(), m_baselineCpu);
+}
+
+
+QJsonObject Benchmark::toJson() const
+{
+  QJsonObject json;
+  json.insert("runs", runs());
+  json.insert("failed_runs", m_failedRuns);
+  json.insert("wall_ms", toJson(wallTime()));
+
+  Statistics cpu = cpuTime();
+  if (cpu.count > 0)
+    json.insert("cpu_ms", toJson(cpu));
+
+  if (m_hasBaseline)
+  {
+    QJsonObject baseline;
+    baseline.insert("wall_median_ms", m_baselineWall.median);
+    if (m_baselineCpu.count > 0)
+      baseline.insert("cpu_median_ms", m_baselineCpu.median);
+    baseline.insert("regression", regressed());
+    json.insert("baseline", baseline);
+  }
+  return json;
+}
+
+
+bool Benchmark::save(const QString& fileName) const
+{
+  // a results file is never left half written: it can become a baseline
+  QSaveFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << "cannot create file in writing: " << fileName;
+    return false;
+  }
+
+  file.write(QJsonDocument(toJson()).toJson());
+  return file.commit();
+}
+
+
+QString Benchmark::summary() const
+{
+  Statistics wall = wallTime();
+  if (wall.count == 0)
+    return QCoreApplication::translate("Benchmark", "Benchmark: all the %1 runs failed").arg(runs());
+
+  QString text = QCoreApplication::translate("Benchmark",
+    "Benchmark of %1 runs: elapsed median %2 ms (min %3, mean %4, p95 %5, stddev %6)")
+    .arg(runs())
+    .arg(wall.median, 0, 'f', 1).arg(wall.min, 0, 'f', 1).arg(wall.mean, 0, 'f', 1)
+    .arg(wall.p95, 0, 'f', 1).arg(wall.stddev, 0, 'f', 1);
+
+  Statistics cpu = cpuTime();
+  if (cpu.count > 0)
+    text += QCoreApplication::translate("Benchmark", ", CPU median %1 ms (stddev %2)")
+      .arg(cpu.median, 0, 'f', 1).arg(cpu.stddev, 0, 'f', 1);
+
+  if (!wall.outliers.isEmpty())
+    text += QCoreApplication::translate("Benchmark", ", %n outlier(s)", 0, wall.outliers.size());
+  if (m_failedRuns > 0)
+    text += QCoreApplication::translate("Benchmark", ", %n failed run(s)", 0, m_failedRuns);
+
+  if (m_hasBaseline)
+  {
+    text += QCoreApplication::translate("Benchmark", "; baseline median %1 ms (%2%3%)")
+      .arg(m_baselineWall.median, 0, 'f', 1)
+      .arg(wall.median >= m_baselineWall.median ? "+" : "")
+      .arg(m_baselineWall.median > 0 ? (wall.median / m_baselineWall.median - 1.0) * 100.0 : 0.0, 0, 'f', 1);
+    if (regressed())
+      text += QCoreApplication::translate("Benchmark", ": REGRESSION");
+  }
+  return text;
+}
+
+
+bool Benchmark::saveBaseline(const QString& fileName, const QString& baseline)
+{
+  if (!QFile::exists(fileName))
+    return false;
+
+  QFile::remove(baseline);
+  return QFile::copy(fileName, baseline);
+}
+
+
+Benchmark::Statistics Benchmark::statistics(const QList<double>& values, const QList<int>& runs)
+{
+  Statistics stats;
+  stats.count = values.size();
+  stats.min = stats.mean = stats.median = stats.p95 = stats.stddev = 0.0;
+  if (values.isEmpty())
+    return stats;
+
+  QList<double> sorted = values;
+  qSort(sorted);
+  stats.min = sorted.first();
+  stats.median = percentile(sorted, 0.5);
+  stats.p95 = percentile(sorted, 0.95);
+
+  double sum = 0.0;
+  for (int i = 0; i < values.size(); i++)
+    sum += values.at(i);
+  stats.mean = sum / values.size();
+
+  // the sample standard deviation: the runs are a sample of all the possible ones
+  if (values.size() > 1)
+  {
+    double squares = 0.0;
+    for (int i = 0; i < values.size(); i++)
+      squares += (values.at(i) - stats.mean) * (values.at(i) - stats.mean);
+    stats.stddev = sqrt(squares / (values.size() - 1));
+  }
+
+  // the Tukey fences: 1.5 interquartile ranges out of the quartiles
+  if (values.size() >= 4)
+  {
+    double q1 = percentile(sorted, 0.25);
+    double q3 = percentile(sorted, 0.75);
+    double low = q1 - 1.5 * (q3 - q1);
+    double high = q3 + 1.5 * (q3 - q1);
+    for (int i = 0; i < values.size(); i++)
+    {
+      if ((values.at(i) < low) || (values.at(i) > high))
+        stats.outliers.append(runs.at(i));
+    }
+  }
+  return stats;
+}
+
+
+QJsonObject Benchmark::toJson(const Statistics& stats)
+{
+  QJsonObject json;
+  json.insert("count", stats.count);
+  json.insert("min", stats.min);
+  json.insert("mean", stats.mean);
+  json.insert("median", stats.median);
+  json.insert("p95", stats.p95);
+  json.insert("stddev", stats.stddev);
+
+  QJsonArray outliers;
+  for (int i = 0; i < stats.outliers.size(); i++)
+    outliers.append(stats.outliers.at(i));
+  json.insert("outliers", outliers);
+  return json;
+}
+
+
+bool Benchmark::slower(const Statistics& current, const Statistics& baseline)
+{
+  if ((current.count == 0) || (baseline.count == 0))
+    return false;
+
+  return current.median > baseline.median + qMax(Tolerance * baseline.median, Deviations * baseline.stddev);
+}
@@ -0,0 +1,196 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QJsonObject>
+
+#include "resourceusage.h"
+
+/**
+ * This class collects the measured runs of a script executed in benchmark
+ * mode (the warmup runs are not given to it) and computes the statistics
+ * of the elapsed and of the CPU time: minimum, mean, median, 95th percentile,
+ * standard deviation and the runs out of the Tukey fences (outliers). The
+ * results can be compared with a baseline, the results of a previous
+ * benchmark saved with \ref saveBaseline(): a median slower than the
+ * baseline one by more than the noise is a regression
+ *
+ * @author Giovanni Venturi
+ */
+class Benchmark
+{
+  public:
+    /**
+     * The statistics of a set of times in milliseconds
+     */
+    struct Statistics
+    {
+      int count;              // 0 if nothing has been measured
+      double min;
+      double mean;
+      double median;
+      double p95;
+      double stddev;
+      QList<int> outliers;    // the runs, from 1, out of the Tukey fences
+    };
+
+    /**
+     * Create an empty benchmark without baseline
+     */
+    Benchmark();
+
+    /**
+     * Add a measured run
+     *
+     * @param wallTime is the elapsed time in milliseconds
+     * @param usage is what the run used: the CPU time is taken if it's valid
+     * @param ok is false if the run failed: it's counted but not measured
+     */
+    void addRun(double wallTime, const ResourceUsage& usage, bool ok);
+
+    /**
+     * @returns the number of measured runs, the failed ones included
+     */
+    int runs() const;
+
+    /**
+     * @returns the number of failed runs
+     */
+    int failedRuns() const;
+
+    /**
+     * @returns the statistics of the elapsed time
+     */
+    Statistics wallTime() const;
+
+    /**
+     * @returns the statistics of the CPU time (user + system), empty if it was not measured
+     */
+    Statistics cpuTime() const;
+
+    /**
+     * Read the baseline to compare with: it's the results file of a previous benchmark
+     *
+     * @param fileName is the baseline file
+     *
+     * @returns false if the file is missing or it's not a benchmark results file
+     */
+    bool loadBaseline(const QString& fileName);
+
+    /**
+     * @returns true if a baseline has been loaded
+     */
+    bool hasBaseline() const;
+
+    /**
+     * @returns true if the elapsed or the CPU time median got slower than the baseline
+     * one by more than 5% and twice its standard deviation
+     */
+    bool regressed() const;
+
+    /**
+     * @returns the results as JSON object: the statistics and the comparison with the baseline
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * Write the results into a file
+     *
+     * @param fileName is the results file
+     *
+     * @returns false if the file cannot be written
+     */
+    bool save(const QString& fileName) const;
+
+    /**
+     * @returns one line telling the medians, the spread, the outliers and the comparison with the baseline
+     */
+    QString summary() const;
+
+    /**
+     * Make the results of a benchmark the baseline of the next ones
+     *
+     * @param fileName is the results file
+     * @param baseline is the baseline file, replaced if it exists
+     *
+     * @returns false if the results cannot be copied
+     */
+    static bool saveBaseline(const QString& fileName, const QString& baseline);
+
+  private:
+    /**
+     * @returns the statistics of @p values
+     *
+     * @param values are the times in milliseconds
+     * @param runs are the run numbers of the times: they tell the outliers
+     */
+    static Statistics statistics(const QList<double>& values, const QList<int>& runs);
+
+    /**
+     * @returns the statistics as JSON object
+     */
+    static QJsonObject toJson(const Statistics& stats);
+
+    /**
+     * @returns true if @p current is slower than @p baseline by more than the noise
+     */
+    static bool slower(const Statistics& current, const Statistics& baseline);
+
+  private:
+    /**
+     * The run numbers, from 1, of the runs that ended correctly
+     */
+    QList<int> m_runs;
+
+    /**
+     * The elapsed time of the runs that ended correctly in milliseconds
+     */
+    QList<double> m_wallTimes;
+
+    /**
+     * The CPU time of the runs that ended correctly in milliseconds, when it's known
+     */
+    QList<double> m_cpuTimes;
+
+    /**
+     * The number of failed runs
+     */
+    int m_failedRuns;
+
+    /**
+     * The elapsed time statistics of the baseline
+     */
+    Statistics m_baselineWall;
+
+    /**
+     * The CPU time statistics of the baseline, empty if it was not measured
+     */
+    Statistics m_baselineCpu;
+
+    /**
+     * true if a baseline has been loaded
+     */
+    bool m_hasBaseline;
+};
+
+#endif
@@ -0,0 +1,249 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTimer>
+
+#include <stdio.h>
+
+#include "clirunner.h"
+#include "scriptqueue.h"
+#include "scriptprocess.h"
+#include "benchmark.h"
+
+CliRunner::CliRunner(const QString& basedir, int maxParallel, QObject *parent)
+  : QObject(parent), m_out(stdout)
+{
+  m_disabled = 0;
+  m_scripts = m_succeeded = m_failed = 0;
+  m_saveBaseline = false;
+  m_selection = RunState::AllScripts;
+
+  m_queue = new ScriptQueue(this);
+  m_queue->assignBaseDir(basedir);
+  m_queue->setMaxParallel(maxParallel);
+
+  connect(m_queue, SIGNAL(scriptStarted(ScriptProcess*)), SLOT(scriptStarted(ScriptProcess*)));
+  connect(m_queue, SIGNAL(scriptEnded(ScriptProcess*,bool)), SLOT(scriptEnded(ScriptProcess*,bool)));
+  connect(m_queue, SIGNAL(skipped(ScriptProcess*)), SLOT(scriptSkipped(ScriptProcess*)));
+  connect(m_queue, SIGNAL(allScriptExecuted()), SLOT(finished()));
+
+  m_stateTimer = new QTimer(this);
+  m_stateTimer->setSingleShot(true);
+  m_stateTimer->setInterval(1000);
+  connect(m_stateTimer, SIGNAL(timeout()), SLOT(saveRunState()));
+}
+
+
+CliRunner::~CliRunner()
+{
+  // the application can quit before the queue ended
+  if (m_stateTimer->isActive())
+    saveRunState();
+}
+
+
+bool CliRunner::load(const QString& filename)
+{
+  m_disabled = 0;
+
+  // the last outcomes choose the scripts to queue
+  if (!m_runState.load(RunState::fileFor(filename)))
+    fprintf(stderr, "%s is not a state file: all the scripts are not run\n",
+      qPrintable(RunState::fileFor(filename)));
+  return read(filename);
+}
+
+
+void CliRunner::setSelection(RunState::Selection selection)
+{
+  m_selection = selection;
+}
+
+
+void CliRunner::setSaveBaseline(bool save)
+{
+  m_saveBaseline = save;
+}
+
+
+void CliRunner::setGracePeriod(int seconds)
+{
+  m_queue->setGracePeriod(seconds);
+}
+
+
+void CliRunner::setCacheSize(int mbytes)
+{
+  m_queue->setCacheSize((qint64)mbytes * 1024 * 1024);
+}
+
+
+void CliRunner::beginGroup(const QString& name, bool checked, const QString& mode, int timeout)
+{
+  Q_UNUSED(name);
+
+  // the scripts of an unchecked group are not executed
+  if ((m_disabled > 0) || !checked)
+  {
+    m_disabled++;
+    return;
+  }
+
+  int limit = 0;
+  ScriptQueue::parseExecutionMode(mode, &limit);
+  m_queue->beginGroup(0, limit, timeout);
+}
+
+
+void CliRunner::endGroup()
+{
+  if (m_disabled > 0)
+    m_disabled--;
+  else
+    m_queue->endGroup();
+}
+
+
+void CliRunner::addScript(const QString& fileName, bool checked, const ScriptJob& job)
+{
+  Q_UNUSED(fileName);
+
+  QString key = RunState::key(job);
+  if ((m_disabled == 0) && checked && m_runState.selects(key, m_selection))
+  {
+    // a sweep queues the script once for each point
+    QList<ScriptProcess*> procs = m_queue->addSweep(job);
+    for (int i = 0; i < procs.size(); i++)
+      m_keys.insert(procs.at(i), key);
+    if (!procs.isEmpty())
+      m_runState.setStatus(key, RunState::Queued);
+    m_scripts += procs.size();
+  }
+}
+
+
+void CliRunner::start() // SLOT
+{
+  m_out << "executing " << m_scripts << " scripts, "
+        << m_queue->maxParallel() << " at the same time" << endl;
+  m_runState.save();
+  m_queue->run();
+}
+
+
+void CliRunner::scriptStarted(ScriptProcess *proc) // SLOT
+{
+  m_out << "started  " << scriptName(proc) << endl;
+  setRunStatus(proc, RunState::Running);
+}
+
+
+void CliRunner::scriptEnded(ScriptProcess *proc, bool ok) // SLOT
+{
+  if (proc->isBenchmark())
+  {
+    // a benchmark slower than its baseline has already failed
+    m_out << "         " << proc->benchmark().summary() << endl;
+    if (m_saveBaseline && !Benchmark::saveBaseline(proc->benchmarkFile(), proc->baselineFile()))
+      m_out << "         cannot save the baseline " << proc->baselineFile() << endl;
+  }
+
+  // a script that exits with an error code failed too
+  if (ok && (proc->returnCode() == 0))
+  {
+    m_succeeded++;
+    m_out << "ok       " << scriptName(proc) << " (" << proc->duration() << " ms"
+          << (proc->fromCache() ? ", cached" : "") << ")" << endl;
+    setRunStatus(proc, RunState::Passed);
+  }
+  else if (proc->timedOut())
+  {
+    m_failed++;
+    m_out << "TIMEOUT  " << scriptName(proc) << " (" << proc->duration() << " ms)" << endl;
+    setRunStatus(proc, RunState::TimedOut, proc->returnCode());
+  }
+  else
+  {
+    m_failed++;
+    m_out << "FAILED   " << scriptName(proc) << " (exit code " << proc->returnCode()
+          << ", " << proc->duration() << " ms)" << endl;
+    setRunStatus(proc, RunState::Failed, proc->returnCode());
+  }
+  sweepEnded(proc);
+}
+
+
+void CliRunner::scriptSkipped(ScriptProcess *proc) // SLOT
+{
+  m_failed++;
+  m_out << "skipped  " << scriptName(proc) << endl;
+  setRunStatus(proc, RunState::Skipped);
+  sweepEnded(proc);
+}
+
+
+QString CliRunner::scriptName(ScriptProcess *proc) const
+{
+  if (proc->taskId() < 0)
+    return proc->name();
+  return QString("%1 [%2: %3]").arg(proc->name()).arg(proc->taskId()).arg(proc->taskLabel());
+}
+
+
+void CliRunner::sweepEnded(ScriptProcess *proc)
+{
+  SweepReport *sweep = m_queue->sweepReport(proc);
+  if (!sweep)
+    return;
+
+  // the points share the outcome: the sweep is still running until the last one ended
+  if (!sweep->complete())
+  {
+    setRunStatus(proc, RunState::Running);
+    return;
+  }
+  m_out << "sweep    " << proc->name() << ": " << sweep->summary() << endl;
+  setRunStatus(proc, sweep->outcome());
+}
+
+
+void CliRunner::setRunStatus(ScriptProcess *proc, RunState::Status status, int code)
+{
+  m_runState.setStatus(m_keys.value(proc), status, code);
+  if (!m_stateTimer->isActive())
+    m_stateTimer->start();
+}
+
+
+void CliRunner::finished() // SLOT
+{
+  saveRunState();
+  m_out << m_succeeded << " succeeded, " << m_failed << " failed or skipped" << endl;
+  QCoreApplication::exit(m_failed > 0 ? ScriptFailed : Success);
+}
+
+
+void CliRunner::saveRunState() // SLOT
+{
+  m_stateTimer->stop();
+  if (!m_runState.save())
+    fprintf(stderr, "cannot save the outcome of the scripts into %s\n", qPrintable(m_runState.fileName()));
+}
@@ -0,0 +1,223 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef CLIRUNNER_H
+#define CLIRUNNER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QTextStream>
+#include <QtCore/QHash>
+
+#include "projectreader.h"
+#include "runstate.h"
+
+class QTimer;
+class ScriptQueue;
+class ScriptProcess;
+
+/**
+ * This class executes a QRunner project without the GUI: it reads the project
+ * file, queues the checked scripts and writes on the standard output what is
+ * happening. The process exit code tells if all the scripts ended correctly.
+ * The outcome of each script is saved in the state file of the project, shared
+ * with the GUI (see \ref RunState)
+ *
+ * @author Giovanni Venturi
+ */
+class CliRunner : public QObject, public ProjectReader
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * The exit codes of the command line runner
+     */
+    enum ExitCode { Success = 0, ScriptFailed = 1, LoadFailed = 2 };
+
+    /**
+     * Create the runner
+     *
+     * @param basedir is the base directory where to save the log files
+     * @param maxParallel is the maximum number of scripts running at the same time
+     *   (less than 1 means one for each CPU core)
+     * @param parent is the parent object
+     */
+    CliRunner(const QString& basedir, int maxParallel, QObject *parent = 0);
+
+    /**
+     * Save the run state changed since the last save
+     */
+    ~CliRunner();
+
+    /**
+     * Read the project and its state file and queue its checked scripts selected by
+     * their last outcome (see \ref setSelection())
+     *
+     * @param filename is the project file
+     *
+     * @returns true if the project was read correctly
+     */
+    bool load(const QString& filename);
+
+    /**
+     * Choose the scripts to execute according to their last outcome: it has to be
+     * called before \ref load()
+     *
+     * @param selection tells which scripts are executed, all of them by default
+     */
+    void setSelection(RunState::Selection selection);
+
+    /**
+     * Make the results of the benchmarks the baseline of the next ones
+     *
+     * @param save is true if the baselines have to be replaced
+     */
+    void setSaveBaseline(bool save);
+
+    /**
+     * Set the time a timed out script has to end before it's killed
+     *
+     * @param seconds is the grace period
+     */
+    void setGracePeriod(int seconds);
+
+    /**
+     * Set the size limit of the result cache under the log directory
+     *
+     * @param mbytes is the size limit in MB, 0 means that the results are not cached
+     */
+    void setCacheSize(int mbytes);
+
+  protected:
+    void beginGroup(const QString& name, bool checked, const QString& mode, int timeout);
+    void endGroup();
+    void addScript(const QString& fileName, bool checked, const ScriptJob& job);
+
+  public slots:
+    /**
+     * Execute the queued scripts: the application quits when all of them ended
+     */
+    void start();
+
+  private slots:
+    /**
+     * Write that a script started
+     */
+    void scriptStarted(ScriptProcess *proc);
+
+    /**
+     * Write how a script ended
+     */
+    void scriptEnded(ScriptProcess *proc, bool ok);
+
+    /**
+     * Write that a script has not been executed
+     */
+    void scriptSkipped(ScriptProcess *proc);
+
+    /**
+     * Write the summary and quit the application
+     */
+    void finished();
+
+    /**
+     * Write the run state into the state file of the project
+     */
+    void saveRunState();
+
+  private:
+    /**
+     * @returns the script name, followed by the point for a sweep point
+     */
+    QString scriptName(ScriptProcess *proc) const;
+
+    /**
+     * Write the outcome of a sweep after its last point ended, and keep its run state
+     *
+     * @param proc is the script that ended or has been skipped
+     */
+    void sweepEnded(ScriptProcess *proc);
+
+    /**
+     * Change the run state of a script: it's saved a while later
+     *
+     * @param proc is the script
+     * @param status is its new status
+     * @param code is its exit code
+     */
+    void setRunStatus(ScriptProcess *proc, RunState::Status status, int code = 0);
+
+  private:
+    /**
+     * The queue executing the scripts
+     */
+    ScriptQueue *m_queue;
+
+    /**
+     * The standard output
+     */
+    QTextStream m_out;
+
+    /**
+     * Greater than 0 while reading the scripts of an unchecked group
+     */
+    int m_disabled;
+
+    /**
+     * The number of queued scripts
+     */
+    int m_scripts;
+
+    /**
+     * The number of scripts that ended correctly
+     */
+    int m_succeeded;
+
+    /**
+     * The number of scripts that failed or have not been executed
+     */
+    int m_failed;
+
+    /**
+     * true if the benchmark results become the baseline of the next benchmarks
+     */
+    bool m_saveBaseline;
+
+    /**
+     * The last outcome of every script of the project
+     */
+    RunState m_runState;
+
+    /**
+     * Save the run state a while after it changed: not on each script event
+     */
+    QTimer *m_stateTimer;
+
+    /**
+     * The scripts to execute according to their last outcome
+     */
+    RunState::Selection m_selection;
+
+    /**
+     * The key in the run state of each queued script
+     */
+    QHash<ScriptProcess*, QString> m_keys;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDir>
+#include <QtCore/QTimer>
+
+#include <stdio.h>
+
+#include "version.h"
+#include "clirunner.h"
+#ifndef Q_OS_WIN
+  #include "spawnserver.h"
+#endif
+
+/**
+ * Hide the debug messages unless the user asked for them
+ */
+static void quietMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+  Q_UNUSED(context);
+  if (type != QtDebugMsg)
+    fprintf(stderr, "%s\n", qPrintable(msg));
+}
+
+
+int main(int argc, char *argv[])
+{
+#ifndef Q_OS_WIN
+  // fork the helper that starts the scripts before any thread is created
+  SpawnServer::start();
+#endif
+
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("qrunner-cli");
+  QCoreApplication::setApplicationVersion(qrunnerVersion);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Execute the scripts of a QRunner project without the GUI");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption jobsOption(QStringList() << "j" << "jobs",
+    "Run at most <n> scripts at the same time (default: one for each CPU core).", "n", "0");
+  parser.addOption(jobsOption);
+  QCommandLineOption logdirOption(QStringList() << "l" << "logdir",
+    "Save the log files into <dir> (default: ~/qrunner).", "dir", QDir::homePath() + "/qrunner");
+  parser.addOption(logdirOption);
+  QCommandLineOption baselineOption("save-baseline",
+    "Compare the benchmarks with their baseline, then make the results the new baseline.");
+  parser.addOption(baselineOption);
+  QCommandLineOption graceOption("grace",
+    "Kill a timed out script <s> seconds after SIGTERM (default: 5).", "s", "5");
+  parser.addOption(graceOption);
+  QCommandLineOption cacheOption("cache-size",
+    "Keep at most <mb> MB of cached script results in the log directory, 0 to disable the cache (default: 1024).",
+    "mb", "1024");
+  parser.addOption(cacheOption);
+  QCommandLineOption rerunOption("rerun",
+    "Execute just the scripts that <what> according to the last outcome saved beside the project: "
+    "\"failed\" (or timed out), \"notrun\" (never executed or skipped) or \"interrupted\" "
+    "(queued or running when the last execution stopped).", "what", "all");
+  parser.addOption(rerunOption);
+  QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "Show the debug messages.");
+  parser.addOption(verboseOption);
+  parser.addPositionalArgument("project", "The QRunner project file (.qrprj) to execute.");
+  parser.process(app);
+
+  if (parser.positionalArguments().size() != 1)
+    parser.showHelp(CliRunner::LoadFailed);
+
+  if (!parser.isSet(verboseOption))
+    qInstallMessageHandler(quietMessageHandler);
+
+  CliRunner runner(parser.value(logdirOption), parser.value(jobsOption).toInt());
+  runner.setSaveBaseline(parser.isSet(baselineOption));
+  runner.setGracePeriod(parser.value(graceOption).toInt());
+  runner.setCacheSize(parser.value(cacheOption).toInt());
+
+  RunState::Selection selection;
+  if (!RunState::parseSelection(parser.value(rerunOption), &selection))
+  {
+    fprintf(stderr, "unknown --rerun value: %s\n", qPrintable(parser.value(rerunOption)));
+    return CliRunner::LoadFailed;
+  }
+  runner.setSelection(selection);
+  if (!runner.load(parser.positionalArguments().at(0)))
+  {
+    fprintf(stderr, "%s\n", qPrintable(runner.errorString()));
+    return CliRunner::LoadFailed;
+  }
+
+  // start when the event loop is running: an empty project ends at once
+  QTimer::singleShot(0, &runner, SLOT(start()));
+  return app.exec();
+}
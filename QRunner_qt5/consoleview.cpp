@@ -0,0 +1,448 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtWidgets/QScrollBar>
+#include <QtWidgets/QLabel>
+#include <QtGui/QPainter>
+#include <QtGui/QPaintEvent>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QTextCodec>
+#include <QtCore/QSettings>
+
+#include <QtCore/QDebug>
+
+#include "consoleview.h"
+#include "settings.h"
+
+/**
+ * The number of bytes of a line that are shown
+ */
+static const int MaxLineLength = 4096;
+
+/**
+ * The spool file is compacted when the data dropped from the scrollback is bigger than this
+ */
+static const qint64 CompactSize = 32 * 1024 * 1024;
+
+/**
+ * The last bytes of an attached file indexed at once
+ */
+static const qint64 TailSize = 256 * 1024;
+
+/**
+ * The bytes of an attached file indexed each time the view scrolls near the top
+ */
+static const qint64 RegionSize = 1024 * 1024;
+
+/**
+ * The space between the text and the viewport border
+ */
+static const int Margin = 4;
+
+ConsoleView::ConsoleView(QWidget *parent)
+  : QAbstractScrollArea(parent)
+{
+  m_file = 0;
+  m_map = 0;
+  m_fileSize = m_scannedFrom = 0;
+  m_spoolBase = 0;
+  m_size = 0;
+  m_longestLine = 0;
+
+  // the scripts output is written as they send it
+#ifdef Q_OS_WIN
+  m_fileCodec = QTextCodec::codecForName("ISO-8859-1");
+#else
+  m_fileCodec = QTextCodec::codecForLocale();
+#endif
+
+  QSettings settings(ORGANIZATION_NAME, APPLICATION_NAME);
+  int scrollback = settings.value("scrollback", 100000).toInt();
+  m_scrollback = (scrollback > 0) ? qMin(scrollback, (int)MaxScrollback) : (int)MaxScrollback;
+
+  m_spool = new QTemporaryFile;
+  if (!m_spool->open())
+    qDebug() << "cannot open in writing the console spool file:" << m_spool->fileName();
+
+  setBackgroundRole(QPalette::Base);
+  viewport()->setBackgroundRole(QPalette::Base);
+
+  // the header is shown when there is some information
+  m_header = new QLabel(this);
+  m_header->setMargin(2);
+  m_header->setWordWrap(true);
+  m_header->setAutoFillBackground(true);
+  m_header->setBackgroundRole(QPalette::AlternateBase);
+  m_header->hide();
+}
+
+
+ConsoleView::~ConsoleView()
+{
+  detachFile();
+  delete m_spool;
+}
+
+
+void ConsoleView::setScrollback(int lines)
+{
+  // no limit means the hard limit: the line index is kept in memory
+  m_scrollback = (lines > 0) ? qMin(lines, (int)MaxScrollback) : (int)MaxScrollback;
+  trimScrollback();
+  updateScrollBars();
+  viewport()->update();
+}
+
+
+int ConsoleView::scrollback() const
+{
+  return m_scrollback;
+}
+
+
+int ConsoleView::lineCount() const
+{
+  return m_lines.size();
+}
+
+
+void ConsoleView::setHeader(const QString& text)
+{
+  if (text.isEmpty())
+  {
+    m_header->hide();
+    setViewportMargins(0, 0, 0, 0);
+    return;
+  }
+
+  m_header->setText(text);
+  m_header->show();
+  placeHeader();
+}
+
+
+void ConsoleView::placeHeader()
+{
+  // the header takes the top of the area: the text is shown below it
+  int height = m_header->heightForWidth(viewport()->width());
+  m_header->setGeometry(frameWidth(), frameWidth(), viewport()->width(), height);
+  setViewportMargins(0, height, 0, 0);
+}
+
+
+void ConsoleView::setText(const QString& text)
+{
+  clear();
+  if (!text.isEmpty())
+    append(text);
+}
+
+
+void ConsoleView::attachFile(const QString& fileName)
+{
+  clear();
+
+  m_file = new QFile(fileName);
+  if (!m_file->open(QIODevice::ReadOnly))
+  {
+    detachFile();
+    return;
+  }
+
+  // the text appended from now on goes after the current end of the file
+  m_fileSize = m_scannedFrom = m_file->size();
+  m_spoolBase = m_size = m_fileSize;
+  if (m_fileSize == 0)
+  {
+    detachFile();
+    return;
+  }
+
+  // don't copy the file: map it, if possible, and read it in place
+  m_map = m_file->map(0, m_fileSize);
+
+  // index just the tail: what the user sees first
+  qint64 tail = m_scannedFrom - qMin(m_scannedFrom, TailSize);
+  while ((m_scannedFrom > tail) || ((m_lines.size() <= visibleLines()) && (m_scannedFrom > 0)))
+    if ((loadEarlierLines() == 0) && (m_scannedFrom == 0))
+      break;
+
+  updateScrollBars();
+  verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+  viewport()->update();
+}
+
+
+void ConsoleView::append(const QString& text) // SLOT
+{
+  QScrollBar *bar = verticalScrollBar();
+  bool atBottom = (bar->value() == bar->maximum());
+
+  // the text starts on a new line
+  QByteArray data = text.toUtf8();
+  if (!m_lines.isEmpty())
+    data.prepend('\n');
+  appendData(data);
+
+  updateScrollBars();
+  if (atBottom)
+    bar->setValue(bar->maximum());
+  viewport()->update();
+}
+
+
+void ConsoleView::clear() // SLOT
+{
+  detachFile();
+  m_spool->resize(0);
+  m_lines.clear();
+  m_fileSize = m_scannedFrom = 0;
+  m_spoolBase = 0;
+  m_size = 0;
+  m_longestLine = 0;
+
+  updateScrollBars();
+  viewport()->update();
+}
+
+
+void ConsoleView::paintEvent(QPaintEvent *event)
+{
+  QPainter painter(viewport());
+  painter.fillRect(event->rect(), palette().base());
+  painter.setPen(palette().text().color());
+  painter.setFont(font());
+
+  // read just the visible lines
+  int lineHeight = fontMetrics().lineSpacing();
+  int first = verticalScrollBar()->value();
+  QStringList lines = readLines(first, qMin(visibleLines() + 1, m_lines.size() - first));
+
+  int x = Margin - horizontalScrollBar()->value();
+  int y = Margin + fontMetrics().ascent();
+  for (int i = 0; i < lines.size(); i++, y += lineHeight)
+    painter.drawText(x, y, lines.at(i));
+}
+
+
+void ConsoleView::resizeEvent(QResizeEvent *event)
+{
+  QAbstractScrollArea::resizeEvent(event);
+  if (m_header->isVisible())
+    placeHeader();
+  updateScrollBars();
+}
+
+
+void ConsoleView::scrollContentsBy(int dx, int dy)
+{
+  QAbstractScrollArea::scrollContentsBy(dx, dy);
+
+  // near the top of the indexed lines: index the previous region of the attached file
+  QScrollBar *bar = verticalScrollBar();
+  if ((dy > 0) && (bar->value() < visibleLines()) && (m_scannedFrom > 0))
+  {
+    int added = loadEarlierLines();
+    if (added > 0)
+    {
+      // keep showing the same lines
+      updateScrollBars();
+      bar->setValue(bar->value() + added);
+    }
+  }
+}
+
+
+void ConsoleView::appendData(const QByteArray& data)
+{
+  if (m_lines.isEmpty())
+    m_lines.append(m_size);
+  if (data.isEmpty())
+    return;
+
+  if (!m_spool->seek(m_size - m_spoolBase) || (m_spool->write(data) != data.size()))
+    qDebug() << "cannot write the console spool file:" << m_spool->errorString();
+
+  // index the lines: just where they start
+  for (int i = data.indexOf('\n'); i >= 0; i = data.indexOf('\n', i + 1))
+  {
+    m_longestLine = qMax(m_longestLine, (int)qMin(m_size + i - m_lines.last(), (qint64)MaxLineLength));
+    m_lines.append(m_size + i + 1);
+  }
+  m_size += data.size();
+  m_longestLine = qMax(m_longestLine, (int)qMin(m_size - m_lines.last(), (qint64)MaxLineLength));
+
+  trimScrollback();
+}
+
+
+void ConsoleView::trimScrollback()
+{
+  // drop the oldest lines, some at a time so not to move the index at each new line
+  if (m_lines.size() > m_scrollback + m_scrollback / 8 + 1)
+  {
+    int excess = m_lines.size() - m_scrollback;
+    m_lines.remove(0, excess);
+    verticalScrollBar()->setValue(verticalScrollBar()->value() - excess);
+
+    // the earlier lines of the attached file are beyond the scrollback too
+    m_scannedFrom = 0;
+  }
+
+  if (m_lines.isEmpty())
+    return;
+
+  // nobody reads the attached file anymore
+  if (m_file && (m_lines.first() >= m_fileSize))
+    detachFile();
+
+  // the spooled data before the first line cannot be seen anymore
+  qint64 dropped = m_lines.first() - m_spoolBase;
+  if ((dropped < CompactSize) || (dropped < (m_size - m_spoolBase) / 2))
+    return;
+
+  QTemporaryFile *spool = new QTemporaryFile;
+  if (!spool->open())
+  {
+    delete spool;
+    return;
+  }
+  m_spool->seek(dropped);
+  while (!m_spool->atEnd())
+    spool->write(m_spool->read(1024 * 1024));
+  delete m_spool;
+  m_spool = spool;
+  m_spoolBase = m_lines.first();
+}
+
+
+int ConsoleView::loadEarlierLines()
+{
+  if (!m_file || (m_scannedFrom == 0))
+    return 0;
+
+  // the lines in memory are limited by the scrollback
+  if (m_lines.size() >= m_scrollback)
+  {
+    m_scannedFrom = 0;
+    return 0;
+  }
+
+  qint64 from = m_scannedFrom - qMin(m_scannedFrom, RegionSize);
+  QByteArray region = fileBytes(from, m_scannedFrom - from);
+
+  // a new line starts after each newline before the first indexed line
+  qint64 limit = m_lines.isEmpty() ? m_scannedFrom : m_lines.first() - 1;
+  QVector<qint64> lines;
+  if (from == 0)
+    lines.append(0);
+  for (int i = region.indexOf('\n'); (i >= 0) && (from + i < limit); i = region.indexOf('\n', i + 1))
+    lines.append(from + i + 1);
+  m_scannedFrom = from;
+
+  // the bytes before the first newline belong to a line that starts in an earlier region
+  if (lines.isEmpty())
+    return 0;
+
+  qint64 next = m_lines.isEmpty() ? m_size : m_lines.first();
+  for (int i = lines.size() - 1; i >= 0; next = lines.at(i), i--)
+    m_longestLine = qMax(m_longestLine, (int)qMin(next - lines.at(i), (qint64)MaxLineLength));
+
+  m_lines = lines + m_lines;
+  return lines.size();
+}
+
+
+void ConsoleView::detachFile()
+{
+  if (!m_file)
+    return;
+
+  if (m_map)
+    m_file->unmap(m_map);
+  m_map = 0;
+  delete m_file;
+  m_file = 0;
+  m_scannedFrom = 0;
+}
+
+
+QByteArray ConsoleView::fileBytes(qint64 offset, qint64 length)
+{
+  // the bytes are decoded or scanned right away: no need to copy them
+  if (m_map)
+    return QByteArray::fromRawData((const char *)m_map + offset, length);
+
+  // the file cannot be mapped: read it
+  m_file->seek(offset);
+  return m_file->read(length);
+}
+
+
+QStringList ConsoleView::readLines(int first, int count)
+{
+  QStringList lines;
+  for (int i = first; i < first + count; i++)
+  {
+    qint64 start = m_lines.at(i);
+    qint64 end = (i + 1 < m_lines.size()) ? m_lines.at(i + 1) : m_size;
+    end = qMin(end, start + MaxLineLength);
+
+    // the line can start in the attached file and end in the spool file
+    QString line;
+    if (start < m_spoolBase)
+    {
+      line = m_fileCodec->toUnicode(fileBytes(start, qMin(end, m_spoolBase) - start));
+      start = m_spoolBase;
+    }
+    if (end > start)
+    {
+      m_spool->seek(start - m_spoolBase);
+      line += QString::fromUtf8(m_spool->read(end - start));
+    }
+    while (line.endsWith('\n') || line.endsWith('\r'))
+      line.chop(1);
+
+    // expand the tabs: the font has fixed width
+    int tab;
+    while ((tab = line.indexOf('\t')) >= 0)
+      line.replace(tab, 1, QString(8 - tab % 8, ' '));
+
+    lines.append(line);
+  }
+  return lines;
+}
+
+
+void ConsoleView::updateScrollBars()
+{
+  verticalScrollBar()->setPageStep(visibleLines());
+  verticalScrollBar()->setRange(0, qMax(0, m_lines.size() - visibleLines()));
+
+  int width = m_longestLine * fontMetrics().averageCharWidth() + 2 * Margin;
+  horizontalScrollBar()->setPageStep(viewport()->width());
+  horizontalScrollBar()->setRange(0, qMax(0, width - viewport()->width()));
+}
+
+
+int ConsoleView::visibleLines() const
+{
+  return qMax(1, (viewport()->height() - Margin) / fontMetrics().lineSpacing());
+}
@@ -0,0 +1,259 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef CONSOLEVIEW_H
+#define CONSOLEVIEW_H
+
+#include <QtWidgets/QAbstractScrollArea>
+#include <QtCore/QVector>
+#include <QtCore/QStringList>
+
+class QFile;
+class QLabel;
+class QTemporaryFile;
+class QTextCodec;
+
+/**
+ * This class shows the output of a script. The text is not kept in memory:
+ * it's spooled to a temporary file and only the offsets of its lines are
+ * indexed, so the view reads from the file just the lines it has to paint.
+ * The number of lines kept (the scrollback) is always limited, even when the
+ * user asks for all of them, so the memory used doesn't depend on how much
+ * the script prints.
+ *
+ * The view can also be attached to an existing file: the file is mapped in
+ * memory, only its last lines are indexed at once and the earlier ones are
+ * indexed while scrolling up. The text appended later is spooled after it.
+ *
+ * @author Giovanni Venturi
+ */
+class ConsoleView : public QAbstractScrollArea
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * The most lines kept: the index of a line takes 8 bytes, so a console
+     * never indexes more than 80 MB. It's the scrollback when the user
+     * doesn't set any limit
+     */
+    static const int MaxScrollback = 10 * 1000 * 1000;
+
+    /**
+     * Create an empty console
+     *
+     * @param parent is the parent widget
+     */
+    ConsoleView(QWidget *parent = 0);
+
+    /**
+     * Remove the spool file
+     */
+    ~ConsoleView();
+
+    /**
+     * Set the maximum number of lines kept: the oldest ones are dropped
+     *
+     * @param lines is the number of lines, 0 means \ref MaxScrollback
+     */
+    void setScrollback(int lines);
+
+    /**
+     * @returns the maximum number of lines kept
+     */
+    int scrollback() const;
+
+    /**
+     * @returns the number of lines in the console
+     */
+    int lineCount() const;
+
+    /**
+     * Replace the console content with a text
+     *
+     * @param text is the new text
+     */
+    void setText(const QString& text);
+
+    /**
+     * Replace the console content with the content of a file. The file is
+     * not copied: it's read when its lines have to be shown
+     *
+     * @param fileName is the file to show, it has the text as the script wrote it
+     */
+    void attachFile(const QString& fileName);
+
+    /**
+     * Show a line of information above the text
+     *
+     * @param text is the information to show, empty to hide the header
+     */
+    void setHeader(const QString& text);
+
+  public slots:
+    /**
+     * Append a text on a new line, as QTextEdit::append() does
+     *
+     * @param text is the text to append
+     */
+    void append(const QString& text);
+
+    /**
+     * Remove all the lines
+     */
+    void clear();
+
+  protected:
+    /**
+     * Paint the visible lines
+     */
+    void paintEvent(QPaintEvent *event);
+
+    /**
+     * Update the scroll bars to the new size
+     */
+    void resizeEvent(QResizeEvent *event);
+
+    /**
+     * Index the earlier lines of the attached file when scrolling near its top
+     */
+    void scrollContentsBy(int dx, int dy);
+
+  private:
+    /**
+     * Put the header above the text, as wide as the area
+     */
+    void placeHeader();
+
+    /**
+     * Spool the data and index its lines
+     *
+     * @param data is the UTF-8 text to add at the end of the console
+     */
+    void appendData(const QByteArray& data);
+
+    /**
+     * Drop the oldest lines beyond the scrollback and the spooled data nobody can see anymore
+     */
+    void trimScrollback();
+
+    /**
+     * Index the lines of the attached file that precede the indexed ones,
+     * a region at a time
+     *
+     * @returns the number of new lines
+     */
+    int loadEarlierLines();
+
+    /**
+     * Release the attached file
+     */
+    void detachFile();
+
+    /**
+     * @returns the bytes of the attached file
+     *
+     * @param offset is where to start reading
+     * @param length is the number of bytes to read
+     */
+    QByteArray fileBytes(qint64 offset, qint64 length);
+
+    /**
+     * @returns the visible lines, read from the attached file and from the spool file
+     *
+     * @param first is the first line to read
+     * @param count is the number of lines to read
+     */
+    QStringList readLines(int first, int count);
+
+    /**
+     * Update the scroll bars ranges
+     */
+    void updateScrollBars();
+
+    /**
+     * @returns the number of lines the viewport can show
+     */
+    int visibleLines() const;
+
+  private:
+    /**
+     * The attached file, 0 if there is none
+     */
+    QFile *m_file;
+
+    /**
+     * The attached file mapped in memory, 0 if it cannot be mapped
+     */
+    uchar *m_map;
+
+    /**
+     * The size of the attached file when it was attached: the text from this
+     * offset on is in the spool file
+     */
+    qint64 m_fileSize;
+
+    /**
+     * The attached file has been indexed from this offset to its end
+     */
+    qint64 m_scannedFrom;
+
+    /**
+     * The encoding of the attached file
+     */
+    QTextCodec *m_fileCodec;
+
+    /**
+     * The spool file with the console text appended after the attached file (UTF-8)
+     */
+    QTemporaryFile *m_spool;
+
+    /**
+     * The console offset of the first byte of the spool file
+     */
+    qint64 m_spoolBase;
+
+    /**
+     * The console offset where each line starts: the attached file comes first,
+     * then the spool file
+     */
+    QVector<qint64> m_lines;
+
+    /**
+     * The size of the console text
+     */
+    qint64 m_size;
+
+    /**
+     * The maximum number of lines kept, never more than \ref MaxScrollback
+     */
+    int m_scrollback;
+
+    /**
+     * The length in bytes of the longest line, for the horizontal scroll bar
+     */
+    int m_longestLine;
+
+    /**
+     * The information shown above the text
+     */
+    QLabel *m_header;
+};
+
+#endif
@@ -0,0 +1,290 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QFile>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QMutexLocker>
+
+#include <QtCore/QDebug>
+
+#include "logwriter.h"
+
+LogWriter *LogWriter::instance()
+{
+  // destroyed after main() returned: the scripts have been deleted already
+  static LogWriter writer;
+  return &writer;
+}
+
+
+LogWriter::LogWriter()
+  : QThread()
+{
+  m_nextHandle = 0;
+  m_quit = false;
+  m_bytesWritten = m_flushes = 0;
+  m_totalLatency = m_maxLatency = 0;
+}
+
+
+LogWriter::~LogWriter()
+{
+  m_mutex.lock();
+  m_quit = true;
+  m_wakeup.wakeAll();
+  m_mutex.unlock();
+  wait();
+
+  // the thread wrote everything: close what is still open
+  QHashIterator<int, Stream*> iterator(m_streams);
+  while (iterator.hasNext())
+  {
+    iterator.next();
+    delete iterator.value()->file;
+    delete iterator.value();
+  }
+
+  if (m_flushes > 0)
+    qDebug() << "log writer:" << m_bytesWritten << "bytes in" << m_flushes << "writes, latency"
+             << averageFlushLatency() << "us average," << m_maxLatency << "us max";
+}
+
+
+int LogWriter::open(const QString& fileName)
+{
+  QFile *file = new QFile(fileName);
+  if (!file->open(QIODevice::Append))
+  {
+    delete file;
+    return -1;
+  }
+
+  Stream *stream = new Stream;
+  stream->file = file;
+
+  // the two buffers are swapped at each write: they keep their memory
+  stream->pending.reserve(FlushSize);
+  stream->writing.reserve(FlushSize);
+  stream->appended = stream->written = 0;
+  stream->flushNow = stream->closing = stream->full = false;
+
+  QMutexLocker locker(&m_mutex);
+  if (!isRunning() && !m_quit)
+    start(QThread::LowPriority);
+  int handle = m_nextHandle++;
+  m_streams.insert(handle, stream);
+  return handle;
+}
+
+
+void LogWriter::write(int handle, const QByteArray& data)
+{
+  QMutexLocker locker(&m_mutex);
+  Stream *stream = m_streams.value(handle);
+  if (!stream || data.isEmpty())
+    return;
+
+  if (stream->pending.isEmpty())
+    stream->age.start();
+  stream->pending += data;
+  stream->appended += data.size();
+
+  // the writer stops reading when the buffer is full: tell it when it can go on
+  if (stream->pending.size() >= MaxPending)
+    stream->full = true;
+
+  // don't let the buffer grow: wake up the thread to write it
+  if (stream->pending.size() >= FlushSize)
+    m_wakeup.wakeAll();
+}
+
+
+bool LogWriter::isFull(int handle) const
+{
+  QMutexLocker locker(&m_mutex);
+  Stream *stream = m_streams.value(handle);
+  return stream && (stream->pending.size() >= MaxPending);
+}
+
+
+void LogWriter::flush(int handle)
+{
+  QMutexLocker locker(&m_mutex);
+  Stream *stream = m_streams.value(handle);
+  if (!stream)
+    return;
+
+  stream->flushNow = true;
+  m_wakeup.wakeAll();
+}
+
+
+void LogWriter::sync(int handle)
+{
+  QMutexLocker locker(&m_mutex);
+  Stream *stream = m_streams.value(handle);
+  if (!stream)
+    return;
+
+  stream->flushNow = true;
+  m_wakeup.wakeAll();
+
+  // the stream is deleted only by close(): it's still valid while it's in the hash
+  qint64 target = stream->appended;
+  while (m_streams.contains(handle) && (stream->written < target) && isRunning())
+    m_written.wait(&m_mutex);
+}
+
+
+void LogWriter::close(int handle, bool wait)
+{
+  QMutexLocker locker(&m_mutex);
+  Stream *stream = m_streams.value(handle);
+  if (!stream)
+    return;
+
+  stream->closing = true;
+  m_wakeup.wakeAll();
+
+  while (wait && m_streams.contains(handle) && isRunning())
+    m_written.wait(&m_mutex);
+}
+
+
+qint64 LogWriter::bytesWritten() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_bytesWritten;
+}
+
+
+qint64 LogWriter::flushes() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_flushes;
+}
+
+
+qint64 LogWriter::averageFlushLatency() const
+{
+  QMutexLocker locker(&m_mutex);
+  return (m_flushes > 0) ? m_totalLatency / m_flushes : 0;
+}
+
+
+qint64 LogWriter::maxFlushLatency() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_maxLatency;
+}
+
+
+void LogWriter::run()
+{
+  QMutexLocker locker(&m_mutex);
+  for (;;)
+  {
+    // take the buffers that are ready and the files to close
+    QList<Stream*> ready;
+    QList<QElapsedTimer> ages;
+    QList<int> closing;
+    QHashIterator<int, Stream*> iterator(m_streams);
+    while (iterator.hasNext())
+    {
+      iterator.next();
+      Stream *stream = iterator.value();
+      if (!stream->pending.isEmpty() &&
+          (stream->flushNow || stream->closing || m_quit ||
+           (stream->pending.size() >= FlushSize) || stream->age.hasExpired(FlushInterval)))
+      {
+        // only this thread uses the writing buffer: it's written without the lock
+        stream->pending.swap(stream->writing);
+        ready.append(stream);
+        ages.append(stream->age);
+      }
+      stream->flushNow = false;
+      if (stream->closing)
+        closing.append(iterator.key());
+    }
+
+    if (ready.isEmpty() && closing.isEmpty())
+    {
+      if (m_quit)
+        break;
+
+      // sleep until new data is big enough or a buffer gets old
+      m_wakeup.wait(&m_mutex, FlushInterval);
+      continue;
+    }
+
+    // write without holding the lock: the scripts keep appending meanwhile
+    locker.unlock();
+    QList<qint64> latencies;
+    for (int i = 0; i < ready.size(); i++)
+    {
+      QFile *file = ready.at(i)->file;
+      if (file->write(ready.at(i)->writing) != ready.at(i)->writing.size())
+        qDebug() << "cannot write to" << file->fileName() << ":" << file->errorString();
+      file->flush();
+      latencies.append(ages.at(i).nsecsElapsed() / 1000);
+    }
+    locker.relock();
+
+    bool drainedFull = false;
+    for (int i = 0; i < ready.size(); i++)
+    {
+      Stream *stream = ready.at(i);
+      if (stream->full && (stream->pending.size() < MaxPending))
+      {
+        stream->full = false;
+        drainedFull = true;
+      }
+      stream->written += stream->writing.size();
+      m_bytesWritten += stream->writing.size();
+
+      // empty, but with its memory: it's the next pending buffer
+      stream->writing.resize(0);
+      m_flushes++;
+      m_totalLatency += latencies.at(i);
+      m_maxLatency = qMax(m_maxLatency, latencies.at(i));
+    }
+
+    // close the files: their last data has just been written
+    for (int i = 0; i < closing.size(); i++)
+    {
+      Stream *stream = m_streams.take(closing.at(i));
+      if (!stream->pending.isEmpty())
+      {
+        // data appended while writing: keep it for the next loop
+        m_streams.insert(closing.at(i), stream);
+        continue;
+      }
+      stream->file->close();
+      delete stream->file;
+      delete stream;
+    }
+
+    m_written.wakeAll();
+
+    // queued to the readers: they read again from the GUI thread
+    if (drainedFull)
+      emit drained();
+  }
+}
@@ -0,0 +1,227 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QHash>
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+
+class QFile;
+
+/**
+ * This class writes the script logs from its own thread. The output of each
+ * script is stored in a buffer and written to disk in batches: when the
+ * buffer is big enough, when its oldest data waited long enough or when
+ * the script ended. Who produces the output only appends to the buffer,
+ * so the GUI thread never waits for the disk.
+ *
+ * @author Giovanni Venturi
+ */
+class LogWriter : public QThread
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * @returns the log writer shared by all the scripts
+     */
+    static LogWriter *instance();
+
+    /**
+     * Write what is still buffered and stop the thread
+     */
+    ~LogWriter();
+
+    /**
+     * Open a file in append mode
+     *
+     * @param fileName is the name of the file to open
+     *
+     * @returns the handle to use to write the file, -1 if it cannot be opened
+     */
+    int open(const QString& fileName);
+
+    /**
+     * Append data to the file buffer: it never waits for the disk. When the
+     * buffer is full (see \ref isFull()) who writes has to stop reading its
+     * source until \ref drained() is emitted
+     *
+     * @param handle is the handle returned by \ref open()
+     * @param data is the data to write
+     */
+    void write(int handle, const QByteArray& data);
+
+    /**
+     * @returns true if the buffer of a file holds \ref MaxPending bytes or more
+     *
+     * @param handle is the handle returned by \ref open()
+     */
+    bool isFull(int handle) const;
+
+    /**
+     * Ask to write the buffered data now, without waiting for it
+     *
+     * @param handle is the handle returned by \ref open()
+     */
+    void flush(int handle);
+
+    /**
+     * Wait until the data appended so far has been written
+     *
+     * @param handle is the handle returned by \ref open()
+     */
+    void sync(int handle);
+
+    /**
+     * Write the buffered data and close the file. The handle cannot be used anymore
+     *
+     * @param handle is the handle returned by \ref open()
+     * @param wait is true to wait until the file has been closed
+     */
+    void close(int handle, bool wait = false);
+
+    /**
+     * @returns the number of bytes written to disk
+     */
+    qint64 bytesWritten() const;
+
+    /**
+     * @returns the number of times a buffer has been written to disk
+     */
+    qint64 flushes() const;
+
+    /**
+     * @returns the average time in microseconds data waited in a buffer before being on disk
+     */
+    qint64 averageFlushLatency() const;
+
+    /**
+     * @returns the maximum time in microseconds data waited in a buffer before being on disk
+     */
+    qint64 maxFlushLatency() const;
+
+  signals:
+    /**
+     * Emitted when the thread wrote a buffer that was full: who stopped reading can go on
+     */
+    void drained();
+
+  protected:
+    /**
+     * The thread loop: write the buffers that are ready
+     */
+    void run();
+
+  private:
+    /**
+     * Create the log writer: the thread starts with the first opened file
+     */
+    LogWriter();
+
+    /**
+     * A file and the data waiting to be written into it
+     */
+    struct Stream
+    {
+      QFile *file;
+      QByteArray pending;
+      QByteArray writing;     // the data being written: then reused as pending
+      QElapsedTimer age;      // started when the first byte of pending arrived
+      qint64 appended;        // bytes appended since the file was opened
+      qint64 written;         // bytes written since the file was opened
+      bool flushNow;
+      bool closing;
+      bool full;              // pending reached MaxPending: drained() is emitted when it's written
+    };
+
+  private:
+    /**
+     * Write a buffer when it holds this number of bytes
+     */
+    static const int FlushSize = 64 * 1024;
+
+    /**
+     * The bytes that make a buffer full: the output of a script that writes faster
+     * than the disk is not read until the buffer has been written, so the pipe
+     * slows down the script, not the GUI. A buffer goes over it by one read at most
+     */
+    static const int MaxPending = 4 * 1024 * 1024;
+
+    /**
+     * Write a buffer when its oldest data waited this number of milliseconds
+     */
+    static const int FlushInterval = 250;
+
+    /**
+     * The open files by handle
+     */
+    QHash<int, Stream*> m_streams;
+
+    /**
+     * The handle of the next opened file
+     */
+    int m_nextHandle;
+
+    /**
+     * Protect the streams, the counters and the stop request
+     */
+    mutable QMutex m_mutex;
+
+    /**
+     * Wake up the thread when there is something to write
+     */
+    QWaitCondition m_wakeup;
+
+    /**
+     * Wake up who waits for data to be written or a file to be closed
+     */
+    QWaitCondition m_written;
+
+    /**
+     * true when the thread has to stop
+     */
+    bool m_quit;
+
+    /**
+     * The number of bytes written to disk
+     */
+    qint64 m_bytesWritten;
+
+    /**
+     * The number of buffers written to disk
+     */
+    qint64 m_flushes;
+
+    /**
+     * The sum of the time in microseconds the written buffers waited
+     */
+    qint64 m_totalLatency;
+
+    /**
+     * The maximum time in microseconds a written buffer waited
+     */
+    qint64 m_maxLatency;
+};
+
+#endif
@@ -25,11 +25,24 @@
 #include <QtCore/QDebug>
 
 #include "mainwindow.h"
+#include "settings.h"
+#ifndef Q_OS_WIN
+  #include "spawnserver.h"
+#endif
 
 int main(int argc, char *argv[])
 {
+#ifndef Q_OS_WIN
+  // fork the helper that starts the scripts while QRunner is still small
+  SpawnServer::start();
+#endif
+
   QApplication app(argc, argv);
 
+  // the general options are read before the Settings dialog is ever opened
+  QCoreApplication::setOrganizationName(ORGANIZATION_NAME);
+  QCoreApplication::setApplicationName(APPLICATION_NAME);
+
   QString locale = QLocale::system().name();
   QTranslator translator;
   bool translated = translator.load(QString("qrunner_") + locale);
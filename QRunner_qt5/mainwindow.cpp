@@ -172,6 +172,11 @@ void MainWindow::activeRunning() // SLOT
 {
   // no script is running
   m_runProjectAct->setDisabled(false);
+  m_runFailedAct->setDisabled(false);
+  m_runNotRunAct->setDisabled(false);
+  m_runInterruptedAct->setDisabled(false);
+  m_pauseAct->setChecked(false);
+  m_pauseAct->setDisabled(true);
   m_newAct->setDisabled(false);
   m_openAct->setDisabled(false);
   m_saveAct->setDisabled(false);
@@ -187,6 +192,10 @@ void MainWindow::activeRunning() // SLOT
 void MainWindow::deactiveRunning() // SLOT
 {
   m_runProjectAct->setDisabled(true);
+  m_runFailedAct->setDisabled(true);
+  m_runNotRunAct->setDisabled(true);
+  m_runInterruptedAct->setDisabled(true);
+  m_pauseAct->setDisabled(false);
   m_newAct->setDisabled(true);
   m_openAct->setDisabled(true);
   m_saveAct->setDisabled(true);
@@ -205,6 +214,9 @@ void MainWindow::modify(const bool& cond)
   m_saveAsAct->setDisabled(!cond);
   m_saveAct->setDisabled(!cond);
   m_runProjectAct->setDisabled(!cond);
+  m_runFailedAct->setDisabled(!cond);
+  m_runNotRunAct->setDisabled(!cond);
+  m_runInterruptedAct->setDisabled(!cond);
 }
 
 
@@ -295,6 +307,9 @@ bool MainWindow::loadFile(const QString &filename)
 
   // now you can run a project
   m_runProjectAct->setDisabled(false);
+  m_runFailedAct->setDisabled(false);
+  m_runNotRunAct->setDisabled(false);
+  m_runInterruptedAct->setDisabled(false);
 
   return true;
 }
@@ -347,6 +362,33 @@ void MainWindow::createActions()
   connect(m_projectView, SIGNAL(runningScript()), SLOT(deactiveRunning()));
   connect(m_projectView, SIGNAL(endedExecution()), SLOT(activeRunning()));
 
+  // just the scripts that need it, according to their last outcome
+  m_runFailedAct = new QAction(tr("Run the &failed scripts again"), this);
+  m_runFailedAct->setShortcut(tr("Ctrl+Shift+R"));
+  m_runFailedAct->setStatusTip(tr("Run the scripts that failed or timed out the last time"));
+  m_runFailedAct->setDisabled(true);
+  connect(m_runFailedAct, SIGNAL(triggered()), m_projectView, SLOT(runFailedScripts()));
+
+  m_runNotRunAct = new QAction(tr("Run the scripts &not run yet"), this);
+  m_runNotRunAct->setStatusTip(tr("Run the scripts that have never been executed or have been skipped"));
+  m_runNotRunAct->setDisabled(true);
+  connect(m_runNotRunAct, SIGNAL(triggered()), m_projectView, SLOT(runNotRunScripts()));
+
+  m_runInterruptedAct = new QAction(tr("Resume the &interrupted run"), this);
+  m_runInterruptedAct->setStatusTip(tr("Run the scripts that were queued or running when the last execution stopped"));
+  m_runInterruptedAct->setDisabled(true);
+  connect(m_runInterruptedAct, SIGNAL(triggered()), m_projectView, SLOT(runInterruptedScripts()));
+
+  m_pauseAct = new QAction(tr("&Pause"), this);
+  m_pauseAct->setShortcut(tr("Ctrl+Shift+P"));
+  m_pauseAct->setStatusTip(tr("Suspend the running scripts and don't start the waiting ones"));
+  m_pauseAct->setCheckable(true);
+
+  // there is nothing to pause until the project runs
+  m_pauseAct->setDisabled(true);
+
+  connect(m_pauseAct, SIGNAL(toggled(bool)), m_projectView, SLOT(setPaused(bool)));
+
   m_exitAct = new QAction(tr("E&xit"), this);
   m_exitAct->setShortcut(tr("Ctrl+Q"));
   m_exitAct->setStatusTip(tr("Exit the application"));
@@ -390,6 +432,10 @@ void MainWindow::createMenus()
 
   m_projectMenu->addSeparator();
   m_projectMenu->addAction(m_runProjectAct);
+  m_projectMenu->addAction(m_runFailedAct);
+  m_projectMenu->addAction(m_runNotRunAct);
+  m_projectMenu->addAction(m_runInterruptedAct);
+  m_projectMenu->addAction(m_pauseAct);
   m_projectMenu->addSeparator();
   m_projectMenu->addAction(m_exitAct);
 
@@ -409,6 +455,7 @@ void MainWindow::createToolBars()
   m_projectToolBar->addAction(m_newAct);
   m_projectToolBar->addAction(m_openAct);
   m_projectToolBar->addAction(m_saveAct);
+  m_projectToolBar->addAction(m_pauseAct);
 }
 
 
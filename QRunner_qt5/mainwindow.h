@@ -237,6 +237,26 @@ class MainWindow : public QMainWindow
      */
     QAction *m_runProjectAct;
 
+    /**
+     * The 'Run the failed scripts again' action
+     */
+    QAction *m_runFailedAct;
+
+    /**
+     * The 'Run the scripts not run yet' action
+     */
+    QAction *m_runNotRunAct;
+
+    /**
+     * The 'Resume the interrupted run' action
+     */
+    QAction *m_runInterruptedAct;
+
+    /**
+     * The 'Pause' action: checked while the execution is paused
+     */
+    QAction *m_pauseAct;
+
     /**
      * The 'Exit' action
      */
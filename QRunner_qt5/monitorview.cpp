@@ -35,7 +35,7 @@ MonitorView::MonitorView(QWidget* parent)
     QPair<ScriptProcess*, TextEditMonitor*> elem = qMakePair((ScriptProcess*) NULL, item);
     m_box.append(elem);
     layout->addWidget( m_box.at(i).second, i/2, i%2 );
-    connect(item, SIGNAL(droppedTreeWidgetItem(TreeWidgetItem*,TextEditMonitor*)), this, SIGNAL(droppedTreeWidgetItem(TreeWidgetItem*,TextEditMonitor*)));
+    connect(item, SIGNAL(droppedScript(int,TextEditMonitor*)), this, SIGNAL(droppedScript(int,TextEditMonitor*)));
   }
   setLayout( layout );
 }
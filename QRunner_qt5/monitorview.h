@@ -51,5 +51,5 @@ class MonitorView : public QDialog
     QList< QPair< ScriptProcess*, TextEditMonitor* > > m_box;
 
   signals:
-    void droppedTreeWidgetItem(TreeWidgetItem *, TextEditMonitor *);
+    void droppedScript(int, TextEditMonitor *);
 };
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QEvent>
+
+#include "outputcoalescer.h"
+#include "consoleview.h"
+
+OutputCoalescer::OutputCoalescer(ConsoleView *view, bool dropHidden)
+  : QObject(view), m_view(view), m_dropHidden(dropHidden)
+{
+  m_hasPending = false;
+  m_droppedFrames = 0;
+
+  // about one display frame
+  m_frame.setInterval(16);
+  m_frame.setSingleShot(true);
+  connect(&m_frame, SIGNAL(timeout()), SLOT(flush()));
+
+  m_view->installEventFilter(this);
+}
+
+
+void OutputCoalescer::clear()
+{
+  m_pending.clear();
+  m_hasPending = false;
+  m_frame.stop();
+}
+
+
+int OutputCoalescer::droppedFrames() const
+{
+  return m_droppedFrames;
+}
+
+
+void OutputCoalescer::append(const QString& text) // SLOT
+{
+  // each chunk goes on its own line, as ConsoleView::append() does
+  if (m_hasPending)
+    m_pending += '\n';
+  m_pending += text;
+  m_hasPending = true;
+
+  if (!m_frame.isActive())
+    m_frame.start();
+}
+
+
+void OutputCoalescer::flush() // SLOT
+{
+  if (!m_hasPending)
+    return;
+
+  if (!m_view->isVisible())
+  {
+    // nobody can see the view: drop the frame or wait for the view to be shown
+    if (m_dropHidden)
+    {
+      clear();
+      m_droppedFrames++;
+    }
+    return;
+  }
+
+  // insert all the collected text at once
+  m_view->append(m_pending);
+  clear();
+}
+
+
+bool OutputCoalescer::eventFilter(QObject *watched, QEvent *event)
+{
+  if ((watched == m_view) && (event->type() == QEvent::Show) && m_hasPending)
+    m_frame.start();
+  return QObject::eventFilter(watched, event);
+}
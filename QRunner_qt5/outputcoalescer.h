@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef OUTPUTCOALESCER_H
+#define OUTPUTCOALESCER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+
+class ConsoleView;
+
+/**
+ * This class collects the output a view has to show and inserts it at most
+ * once per display frame, so a script writing many short lines doesn't make
+ * the view relayout for each of them. The text is shown as if each received
+ * chunk had been appended with ConsoleView::append()
+ *
+ * @author Giovanni Venturi
+ */
+class OutputCoalescer : public QObject
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * Create the coalescer of a view
+     *
+     * @param view is the view where to insert the text
+     * @param dropHidden is true if the text received while the view is hidden
+     *   can be dropped (the view reloads it when shown), false to insert it
+     *   when the view is shown again
+     */
+    OutputCoalescer(ConsoleView *view, bool dropHidden);
+
+    /**
+     * Forget the text not inserted yet
+     */
+    void clear();
+
+    /**
+     * @returns the number of frames dropped because the view was hidden
+     */
+    int droppedFrames() const;
+
+  public slots:
+    /**
+     * Collect a chunk of text: it's inserted with the next frame
+     *
+     * @param text is the text to append to the view
+     */
+    void append(const QString& text);
+
+    /**
+     * Insert now the collected text
+     */
+    void flush();
+
+  protected:
+    /**
+     * Insert the collected text when the view is shown again
+     */
+    bool eventFilter(QObject *watched, QEvent *event);
+
+  private:
+    /**
+     * The view where to insert the text
+     */
+    ConsoleView *m_view;
+
+    /**
+     * The collected text, one line for each chunk
+     */
+    QString m_pending;
+
+    /**
+     * true if there is collected text, even if empty
+     */
+    bool m_hasPending;
+
+    /**
+     * true if the text collected while the view is hidden can be dropped
+     */
+    bool m_dropHidden;
+
+    /**
+     * The number of frames dropped because the view was hidden
+     */
+    int m_droppedFrames;
+
+    /**
+     * Insert the collected text at the next frame
+     */
+    QTimer m_frame;
+};
+
+#endif
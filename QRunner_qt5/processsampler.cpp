@@ -0,0 +1,296 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QMutexLocker>
+
+#include <QtCore/QDebug>
+
+#ifdef Q_OS_LINUX
+  #include <dirent.h>
+  #include <fcntl.h>
+  #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <unistd.h>
+#endif
+
+#include "processsampler.h"
+
+ProcessSampler *ProcessSampler::instance()
+{
+  // destroyed after main() returned: the scripts have been deleted already
+  static ProcessSampler sampler;
+  return &sampler;
+}
+
+
+ProcessSampler::ProcessSampler()
+  : QThread()
+{
+  m_interval = 0;
+  m_quit = false;
+}
+
+
+ProcessSampler::~ProcessSampler()
+{
+  m_mutex.lock();
+  m_quit = true;
+  m_wakeup.wakeAll();
+  m_mutex.unlock();
+  wait();
+}
+
+
+void ProcessSampler::setInterval(int msecs)
+{
+  QMutexLocker locker(&m_mutex);
+  m_interval = qMax(msecs, 0);
+  if ((m_interval > 0) && !m_watched.isEmpty() && !isRunning() && !m_quit)
+    start(QThread::LowPriority);
+  m_wakeup.wakeAll();
+}
+
+
+void ProcessSampler::watch(qint64 pid)
+{
+  if (pid <= 0)
+    return;
+
+  QMutexLocker locker(&m_mutex);
+  m_watched.insert(pid, -1);
+  if ((m_interval > 0) && !isRunning() && !m_quit)
+    start(QThread::LowPriority);
+  m_wakeup.wakeAll();
+}
+
+
+void ProcessSampler::unwatch(qint64 pid)
+{
+  QMutexLocker locker(&m_mutex);
+  m_watched.remove(pid);
+  m_samples.remove(pid);
+  m_orphans.remove(pid);
+}
+
+
+void ProcessSampler::addOrphan(qint64 pid, qint64 orphan)
+{
+  QMutexLocker locker(&m_mutex);
+  if (m_watched.contains(pid))
+    m_orphans.insert(pid, orphan);
+}
+
+
+bool ProcessSampler::sample(qint64 pid, Sample *sample) const
+{
+  QMutexLocker locker(&m_mutex);
+  if (!m_samples.contains(pid))
+    return false;
+
+  *sample = m_samples.value(pid);
+  return true;
+}
+
+
+QList<qint64> ProcessSampler::descendants(qint64 pid)
+{
+  QHash<qint64, Process> processes;
+  readProcesses(&processes);
+  QMultiHash<qint64, qint64> children;
+  QHashIterator<qint64, Process> iterator(processes);
+  while (iterator.hasNext())
+  {
+    iterator.next();
+    children.insert(iterator.value().parent, iterator.key());
+  }
+
+  // breadth first: the parents come before their children
+  QList<qint64> result = children.values(pid);
+  for (int i = 0; i < result.size(); i++)
+    result += children.values(result.at(i));
+  return result;
+}
+
+
+void ProcessSampler::run()
+{
+#ifdef Q_OS_LINUX
+  const double ticksPerSecond = sysconf(_SC_CLK_TCK);
+  const qint64 pageSize = sysconf(_SC_PAGESIZE);
+#endif
+
+  QMutexLocker locker(&m_mutex);
+  while (!m_quit)
+  {
+    if (m_watched.isEmpty() || (m_interval == 0))
+    {
+      // nothing to measure: sleep until a script is watched
+      m_wakeup.wait(&m_mutex);
+      continue;
+    }
+
+#ifdef Q_OS_LINUX
+    // read /proc without holding the lock: one pass for all the scripts
+    QList<qint64> roots = m_watched.keys();
+    QMultiHash<qint64, qint64> adopted = m_orphans;
+    locker.unlock();
+
+    QHash<qint64, Process> processes;
+    readProcesses(&processes);
+    QMultiHash<qint64, qint64> children;
+    QMultiHash<qint64, qint64> members;
+    QHashIterator<qint64, Process> iterator(processes);
+    while (iterator.hasNext())
+    {
+      iterator.next();
+      children.insert(iterator.value().parent, iterator.key());
+      members.insert(iterator.value().group, iterator.key());
+    }
+
+    QList<Sample> totals;
+    QList<qint64> ticks;
+    for (int i = 0; i < roots.size(); i++)
+    {
+      Sample total = { 0.0, 0, 0, 0 };
+      qint64 tick = 0;
+      QSet<qint64> visited;
+      sumTree(roots.at(i), processes, children, &total, &tick, &visited);
+
+      // the script leads its process group: its orphans are still in the group
+      QList<qint64> orphans = members.values(roots.at(i));
+      for (int j = 0; j < orphans.size(); j++)
+        sumTree(orphans.at(j), processes, children, &total, &tick, &visited);
+
+      // ... or they left it with setsid() and the spawn helper adopted them:
+      // they lead their own process group, with its orphans
+      orphans = adopted.values(roots.at(i));
+      for (int j = 0; j < orphans.size(); j++)
+      {
+        if (visited.contains(orphans.at(j)))
+          continue;
+        sumTree(orphans.at(j), processes, children, &total, &tick, &visited);
+        orphans += members.values(orphans.at(j));
+      }
+      total.rss *= pageSize;
+      totals.append(total);
+      ticks.append(tick);
+    }
+    double elapsed = m_clock.isValid() ? m_clock.restart() / 1000.0 : 0.0;
+    if (!m_clock.isValid())
+      m_clock.start();
+
+    locker.relock();
+    for (int i = 0; i < roots.size(); i++)
+    {
+      if (!m_watched.contains(roots.at(i)) || (totals.at(i).processes == 0))
+        // ended meanwhile
+        continue;
+
+      // the CPU usage since the previous sample: the descendants that ended are not counted anymore
+      qint64 previous = m_watched.value(roots.at(i));
+      Sample total = totals.at(i);
+      if ((previous >= 0) && (elapsed > 0))
+        total.cpu = qMax(ticks.at(i) - previous, (qint64)0) / ticksPerSecond / elapsed * 100.0;
+      m_watched.insert(roots.at(i), ticks.at(i));
+      m_samples.insert(roots.at(i), total);
+    }
+    emit sampled();
+#endif
+
+    m_wakeup.wait(&m_mutex, m_interval);
+  }
+}
+
+
+void ProcessSampler::readProcesses(QHash<qint64, Process> *processes)
+{
+#ifdef Q_OS_LINUX
+  DIR *proc = opendir("/proc");
+  if (!proc)
+    return;
+
+  struct dirent *entry;
+  char path[64];
+  char buffer[1024];
+  while ((entry = readdir(proc)) != 0)
+  {
+    if ((entry->d_name[0] < '0') || (entry->d_name[0] > '9'))
+      // not a process
+      continue;
+
+    snprintf(path, sizeof(path), "/proc/%s/stat", entry->d_name);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      continue;
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (n <= 0)
+      continue;
+    buffer[n] = '\0';
+
+    // the command name can contain spaces and parentheses: the fields start after the last ')'
+    char *fields = strrchr(buffer, ')');
+    if (!fields)
+      continue;
+
+    // state ppid pgrp session tty tpgid flags minflt cminflt majflt cmajflt utime stime
+    //  cutime cstime priority nice num_threads itrealvalue starttime vsize rss
+    char state;
+    long long parent, group, utime, stime, threads, rss;
+    if (sscanf(fields + 1, " %c %lld %lld %*d %*d %*d %*u %*lu %*lu %*lu %*lu %lld %lld %*ld %*ld %*ld %*ld %lld %*ld %*llu %*lu %lld",
+               &state, &parent, &group, &utime, &stime, &threads, &rss) != 7)
+      continue;
+
+    Process process;
+    process.parent = parent;
+    process.group = group;
+    process.ticks = utime + stime;
+    process.rss = rss;
+    process.threads = threads;
+    processes->insert(strtoll(entry->d_name, 0, 10), process);
+  }
+  closedir(proc);
+#else
+  Q_UNUSED(processes);
+#endif
+}
+
+
+void ProcessSampler::sumTree(qint64 pid, const QHash<qint64, Process>& processes,
+  const QMultiHash<qint64, qint64>& children, Sample *total, qint64 *ticks,
+  QSet<qint64> *visited)
+{
+  if (!processes.contains(pid) || visited->contains(pid))
+    return;
+  visited->insert(pid);
+
+  Process process = processes.value(pid);
+  *ticks += process.ticks;
+  total->rss += process.rss;
+  total->threads += process.threads;
+  total->processes++;
+
+  QMultiHash<qint64, qint64>::const_iterator child = children.constFind(pid);
+  while ((child != children.constEnd()) && (child.key() == pid))
+  {
+    sumTree(child.value(), processes, children, total, ticks, visited);
+    ++child;
+  }
+}
@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef PROCESSSAMPLER_H
+#define PROCESSSAMPLER_H
+
+#include <QtCore/QThread>
+#include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QList>
+#include <QtCore/QElapsedTimer>
+
+/**
+ * This class measures the running scripts from its own thread. At each
+ * interval it reads /proc once for all the watched scripts and sums, for
+ * each of them, the CPU time, the resident memory and the threads of the
+ * script and of all its descendants, orphans left in the process group of the
+ * script and orphans that left it (see \ref addOrphan()) included. Who shows
+ * the values is told with \ref sampled() and reads them with \ref sample().
+ * Only Linux has the /proc file system the sampler needs: elsewhere nothing is
+ * measured.
+ *
+ * @author Giovanni Venturi
+ */
+class ProcessSampler : public QThread
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * What a script and its descendants are using
+     */
+    struct Sample
+    {
+      double cpu;             // percentage of a CPU since the previous sample
+      qint64 rss;             // resident memory in bytes
+      int threads;
+      int processes;          // the script, its descendants and its orphans
+    };
+
+    /**
+     * @returns the sampler shared by all the scripts
+     */
+    static ProcessSampler *instance();
+
+    /**
+     * Stop the thread
+     */
+    ~ProcessSampler();
+
+    /**
+     * Assign the time between two samples
+     *
+     * @param msecs is the interval in milliseconds, 0 to stop sampling
+     */
+    void setInterval(int msecs);
+
+    /**
+     * Start measuring a script: the thread starts with the first watched script
+     * if the interval is not 0
+     *
+     * @param pid is the PID of the script
+     */
+    void watch(qint64 pid);
+
+    /**
+     * Stop measuring a script
+     *
+     * @param pid is the PID of the script
+     */
+    void unwatch(qint64 pid);
+
+    /**
+     * Measure an orphan that left the process group of a script with the script:
+     * the spawn helper adopted it, so it's not a descendant of the script anymore
+     *
+     * @param pid is the PID of the script
+     * @param orphan is the PID of the orphan
+     */
+    void addOrphan(qint64 pid, qint64 orphan);
+
+    /**
+     * Get the last values measured for a script
+     *
+     * @param pid is the PID of the script
+     * @param sample is set to the measured values
+     *
+     * @returns false if the script has not been measured yet
+     */
+    bool sample(qint64 pid, Sample *sample) const;
+
+    /**
+     * Read the descendants of a process from /proc (Linux only)
+     *
+     * @param pid is the PID of the process
+     *
+     * @returns the PIDs of its children, of their children and so on
+     */
+    static QList<qint64> descendants(qint64 pid);
+
+  signals:
+    /**
+     * Emitted, from the sampler thread, when the watched scripts have been measured
+     */
+    void sampled();
+
+  protected:
+    /**
+     * The thread loop: measure the watched scripts at each interval
+     */
+    void run();
+
+  private:
+    /**
+     * Create the sampler: the thread starts with the first watched script
+     */
+    ProcessSampler();
+
+    /**
+     * A process read from /proc
+     */
+    struct Process
+    {
+      qint64 parent;
+      qint64 group;           // the process group
+      qint64 ticks;           // user and system CPU time in clock ticks
+      qint64 rss;             // resident pages
+      int threads;
+    };
+
+    /**
+     * Read all the processes from /proc
+     *
+     * @param processes is filled with the processes by PID
+     */
+    static void readProcesses(QHash<qint64, Process> *processes);
+
+    /**
+     * Sum the values of a process and of its descendants not summed yet
+     *
+     * @param pid is the process where to start
+     * @param processes are all the processes by PID
+     * @param children are the children PIDs of each process
+     * @param total is where to add the values
+     * @param ticks is where to add the CPU time
+     * @param visited are the processes already summed: the new ones are added
+     */
+    static void sumTree(qint64 pid, const QHash<qint64, Process>& processes,
+      const QMultiHash<qint64, qint64>& children, Sample *total, qint64 *ticks,
+      QSet<qint64> *visited);
+
+  private:
+    /**
+     * The time between two samples in milliseconds, 0 if the sampler is stopped
+     */
+    int m_interval;
+
+    /**
+     * The watched scripts: PID and the CPU ticks of the previous sample (-1 if none yet)
+     */
+    QHash<qint64, qint64> m_watched;
+
+    /**
+     * The last values measured for each watched script
+     */
+    QHash<qint64, Sample> m_samples;
+
+    /**
+     * The orphans of the watched scripts outside their process group, by script PID
+     */
+    QMultiHash<qint64, qint64> m_orphans;
+
+    /**
+     * Measure the time between two samples
+     */
+    QElapsedTimer m_clock;
+
+    /**
+     * Protect the watched scripts, the samples and the stop request
+     */
+    mutable QMutex m_mutex;
+
+    /**
+     * Wake up the thread when a script is watched, the interval changes or it has to stop
+     */
+    QWaitCondition m_wakeup;
+
+    /**
+     * true when the thread has to stop
+     */
+    bool m_quit;
+};
+
+#endif
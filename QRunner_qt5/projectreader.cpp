@@ -0,0 +1,296 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QCoreApplication>
+
+#include <QtCore/QDebug>
+
+#include "projectreader.h"
+#include "scriptqueue.h"
+
+ProjectReader::ProjectReader()
+{
+}
+
+
+ProjectReader::~ProjectReader()
+{
+}
+
+
+bool ProjectReader::read(const QString& filename)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    m_error = QCoreApplication::translate("ProjectReader", "Cannot open '%1'").arg(filename);
+    return false;
+  }
+
+  m_groups.clear();
+  m_directories.clear();
+
+  // the document element is "project": it has just "group" elements
+  QXmlStreamReader xml(&file);
+  if (xml.readNextStartElement())
+  {
+    while (xml.readNextStartElement())
+    {
+      if (xml.name() == QLatin1String("group"))
+        readGroup(xml);
+      else
+        xml.raiseError(QCoreApplication::translate("ProjectReader", "unexpected element <%1>")
+          .arg(xml.name().toString()));
+    }
+  }
+  else if (!xml.hasError())
+    xml.raiseError(QCoreApplication::translate("ProjectReader", "the project element is missing"));
+
+  if (xml.hasError())
+  {
+    if (xml.error() == QXmlStreamReader::CustomError)
+      m_error = QCoreApplication::translate("ProjectReader",
+        "The file doesn't fit the QRunner Project format: %1 (line %2, column %3)");
+    else
+      m_error = QCoreApplication::translate("ProjectReader",
+        "'%4' is not an XML file: %1 (line %2, column %3)").arg(filename);
+    m_error = m_error.arg(xml.errorString()).arg(xml.lineNumber()).arg(xml.columnNumber());
+    return false;
+  }
+
+  qDebug() << "project" << filename << "read in" << timer.elapsed() << "ms";
+  m_error.clear();
+  return true;
+}
+
+
+QString ProjectReader::errorString() const
+{
+  return m_error;
+}
+
+
+void ProjectReader::readGroup(QXmlStreamReader& xml)
+{
+  QXmlStreamAttributes attributes = xml.attributes();
+  if (!attributes.hasAttribute("checked") || !attributes.hasAttribute("name"))
+  {
+    xml.raiseError(QCoreApplication::translate("ProjectReader", "<%1> needs the \"name\" and \"checked\" attributes")
+      .arg(xml.name().toString()));
+    return;
+  }
+  if (!checkCheckedAttribute(xml, attributes.value("checked")))
+    return;
+  QString mode = attributes.value("mode").toString();
+  if (!ScriptQueue::parseExecutionMode(mode))
+  {
+    xml.raiseError(QCoreApplication::translate("ProjectReader", "unknown execution mode \"%1\"").arg(mode));
+    return;
+  }
+
+  QString name = attributes.value("name").toString();
+  beginGroup(name, (attributes.value("checked") == QLatin1String("true")), mode, attributes.value("timeout").toInt());
+  m_groups.append(name);
+
+  // in the "group" element we can have "subgroup" and "file" ones
+  while (xml.readNextStartElement())
+  {
+    if (xml.name() == QLatin1String("subgroup"))
+      readGroup(xml);
+    else if (xml.name() == QLatin1String("file"))
+      readScript(xml);
+    else
+      xml.raiseError(QCoreApplication::translate("ProjectReader", "unexpected element <%1>")
+        .arg(xml.name().toString()));
+  }
+
+  m_groups.removeLast();
+  endGroup();
+}
+
+
+void ProjectReader::readScript(QXmlStreamReader& xml)
+{
+  QXmlStreamAttributes attributes = xml.attributes();
+  if (!attributes.hasAttribute("path") || !attributes.hasAttribute("checked") || !attributes.hasAttribute("name"))
+  {
+    xml.raiseError(QCoreApplication::translate("ProjectReader",
+      "<file> needs the \"path\", \"name\" and \"checked\" attributes"));
+    return;
+  }
+
+  // don't report files that don't exist anymore
+  QString path = attributes.value("path").toString();
+  if (!directoryExists(path))
+  {
+    xml.skipCurrentElement();
+    return;
+  }
+  if (!checkCheckedAttribute(xml, attributes.value("checked")))
+    return;
+
+  ScriptJob job;
+  job.setName(QDir(path).absoluteFilePath(attributes.value("name").toString()));
+  job.setParameters(attributes.value("parameters").toString());
+  if (!attributes.value("times").isEmpty())
+    job.setTimes(attributes.value("times").toInt());
+  if (!attributes.value("delay").isEmpty())
+    job.setDelay(attributes.value("delay").toInt());
+  job.setBenchmark(attributes.value("benchmark") == QLatin1String("true"));
+  job.setWarmup(attributes.value("warmup").toInt());
+  job.setTimeout(attributes.value("timeout").toInt());
+  job.setIdleTimeout(attributes.value("idletimeout").toInt());
+  job.setCached(attributes.value("cache") == QLatin1String("true"));
+
+  // the dependencies between the scripts
+  job.setId(attributes.value("id").toString());
+  QStringList ids;
+  QStringList after = attributes.value("after").toString().split(',', QString::SkipEmptyParts);
+  for (int i = 0; i < after.size(); i++)
+  {
+    // "a, b" waits for "a" and "b"
+    if (!after.at(i).trimmed().isEmpty())
+      ids << after.at(i).trimmed();
+  }
+  job.setDependencies(ids);
+  job.setEstimate(attributes.value("estimate").toLongLong());
+  job.setLogPath(m_groups);
+
+  // the "environment" element has all the variables + values, the "sweep"
+  //  element the points the script runs for, the "inputs" element the files it reads
+  QStringList inputs;
+  while (xml.readNextStartElement())
+  {
+    if (xml.name() == QLatin1String("environment"))
+    {
+      while (xml.readNextStartElement())
+      {
+        if (xml.name() == QLatin1String("env"))
+          job.addEnvironment(xml.attributes().value("name").toString(), xml.attributes().value("value").toString());
+        xml.skipCurrentElement();
+      }
+    }
+    else if (xml.name() == QLatin1String("sweep"))
+    {
+      Sweep sweep;
+      readSweep(xml, sweep);
+      job.setSweep(sweep);
+    }
+    else if (xml.name() == QLatin1String("inputs"))
+    {
+      while (xml.readNextStartElement())
+      {
+        if (xml.name() == QLatin1String("input"))
+          inputs.append(xml.attributes().value("path").toString());
+        xml.skipCurrentElement();
+      }
+    }
+    else
+      xml.skipCurrentElement();
+  }
+  if (xml.hasError())
+    return;
+  job.setInputs(inputs);
+
+  addScript(attributes.value("name").toString(), (attributes.value("checked") == QLatin1String("true")), job);
+}
+
+
+void ProjectReader::readSweep(QXmlStreamReader& xml, Sweep& sweep)
+{
+  Sweep::Mode mode;
+  if (!Sweep::parseMode(xml.attributes().value("mode").toString(), &mode))
+  {
+    xml.raiseError(QCoreApplication::translate("ProjectReader",
+      "the sweep \"mode\" must be \"product\" or \"list\", not \"%1\"").arg(xml.attributes().value("mode").toString()));
+    return;
+  }
+  sweep.setMode(mode);
+
+  while (xml.readNextStartElement())
+  {
+    if ((xml.name() != QLatin1String("parameters")) && (xml.name() != QLatin1String("env")))
+    {
+      xml.skipCurrentElement();
+      continue;
+    }
+
+    QString name;
+    if (xml.name() == QLatin1String("env"))
+    {
+      name = xml.attributes().value("name").toString();
+      if (name.isEmpty())
+      {
+        xml.raiseError(QCoreApplication::translate("ProjectReader", "the sweep <env> needs the \"name\" attribute"));
+        return;
+      }
+    }
+
+    QStringList values;
+    while (xml.readNextStartElement())
+    {
+      if (xml.name() == QLatin1String("value"))
+        values << xml.readElementText();
+      else
+        xml.skipCurrentElement();
+    }
+
+    if (values.isEmpty())
+    {
+      // the sweep would have no point: the script would never run
+      xml.raiseError(QCoreApplication::translate("ProjectReader", "a sweep axis needs at least one <value>"));
+      return;
+    }
+
+    if (name.isEmpty())
+      sweep.addParameters(values);
+    else
+      sweep.addEnvironment(name, values);
+  }
+}
+
+
+bool ProjectReader::checkCheckedAttribute(QXmlStreamReader& xml, const QStringRef& value) const
+{
+  if ((value == QLatin1String("true")) || (value == QLatin1String("false")))
+    return true;
+
+  xml.raiseError(QCoreApplication::translate("ProjectReader", "\"checked\" must be \"true\" or \"false\", not \"%1\"")
+    .arg(value.toString()));
+  return false;
+}
+
+
+bool ProjectReader::directoryExists(const QString& path)
+{
+  QHash<QString, bool>::const_iterator it = m_directories.constFind(path);
+  if (it != m_directories.constEnd())
+    return it.value();
+
+  bool exists = QDir(path).exists();
+  m_directories.insert(path, exists);
+  return exists;
+}
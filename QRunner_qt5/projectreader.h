@@ -0,0 +1,161 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef PROJECTREADER_H
+#define PROJECTREADER_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QHash>
+
+#include "scriptjob.h"
+
+class QXmlStreamReader;
+class Sweep;
+
+/**
+ * This class reads a QRunner project file (.qrprj), checks that it's compliant
+ * to the specifics and reports its groups and scripts to the derived class,
+ * that decides what to build with them: the project tree in the GUI or the
+ * scripts queue in the command line runner.
+ *
+ * The file is read in a single pass, without building the XML document: the
+ * groups and scripts are reported while they are checked, so when the file is
+ * not correct what was reported before the error has to be discarded
+ *
+ * @author Giovanni Venturi
+ */
+class ProjectReader
+{
+  public:
+    /**
+     * Create the project reader
+     */
+    ProjectReader();
+
+    /**
+     * Destroy the project reader
+     */
+    virtual ~ProjectReader();
+
+    /**
+     * Read the project file
+     *
+     * @param filename is the name of the file to read
+     *
+     * @returns true if the project was read correctly, otherwise \ref errorString()
+     * tells where the file is not correct
+     */
+    bool read(const QString& filename);
+
+    /**
+     * @returns the description of the last error
+     */
+    QString errorString() const;
+
+  protected:
+    /**
+     * Called when a group (or a sub group) begins: the next groups and scripts
+     * belong to it until \ref endGroup() is called
+     *
+     * @param name is the group name
+     * @param checked is true if the group can be executed
+     * @param mode is the group execution mode (see \ref ScriptQueue::parseExecutionMode())
+     * @param timeout is the longest time in seconds the group can take, 0 for no limit
+     */
+    virtual void beginGroup(const QString& name, bool checked, const QString& mode, int timeout) = 0;
+
+    /**
+     * Called when the current group ends
+     */
+    virtual void endGroup() = 0;
+
+    /**
+     * Called for each script of the current group. Scripts that don't exist
+     * anymore are not reported
+     *
+     * @param fileName is the script file name as written in the project
+     * @param checked is true if the script can be executed
+     * @param job is the description of the script
+     */
+    virtual void addScript(const QString& fileName, bool checked, const ScriptJob& job) = 0;
+
+  private:
+    /**
+     * Check and report a group (or a sub group) with its content, recursively.
+     * The reader is on the group start element and it's left on its end element
+     *
+     * @param xml is the reader of the project file
+     */
+    void readGroup(QXmlStreamReader& xml);
+
+    /**
+     * Check and report a script with its environment.
+     * The reader is on the file start element and it's left on its end element
+     *
+     * @param xml is the reader of the project file
+     */
+    void readScript(QXmlStreamReader& xml);
+
+    /**
+     * Check and read the parameter sweep of a script: its axes are the "parameters"
+     * and "env" elements, each one with its "value" elements.
+     * The reader is on the sweep start element and it's left on its end element
+     *
+     * @param xml is the reader of the project file
+     * @param sweep is filled with the axes
+     */
+    void readSweep(QXmlStreamReader& xml, Sweep& sweep);
+
+    /**
+     * Check an attribute that tells if a group or script is checked
+     *
+     * @returns true if it is "true" or "false", otherwise an error is raised on the reader
+     *
+     * @param xml is the reader of the project file
+     * @param value is the value of the attribute
+     */
+    bool checkCheckedAttribute(QXmlStreamReader& xml, const QStringRef& value) const;
+
+    /**
+     * @returns true if the directory exists. Many scripts are in the same
+     * directory: it's checked just once for each project
+     *
+     * @param path is the directory to check
+     */
+    bool directoryExists(const QString& path);
+
+  private:
+    /**
+     * The description of the last error
+     */
+    QString m_error;
+
+    /**
+     * The names of the groups containing the current one, from the top level group
+     */
+    QStringList m_groups;
+
+    /**
+     * The directories of the scripts already checked, with their existence
+     */
+    QHash<QString, bool> m_directories;
+};
+
+#endif
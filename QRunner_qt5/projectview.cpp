@@ -81,6 +81,7 @@ ProjectView::ProjectView(QWidget *parent)
   // start setting the external Drag & Drop
   connect(m_treeDir, SIGNAL(startDraging()), m_scriptTree, SLOT(setExternalDND()));
   m_scriptConf = new ScriptConf;
+  m_scriptConf->setModel(m_scriptTree->scriptModel());
 
   hlayout2->addWidget(m_scriptTree);
 
@@ -101,7 +102,7 @@ ProjectView::ProjectView(QWidget *parent)
   addWidget(m_outputBox);
   m_outputBox->hide();
 
-  connect(m_scriptTree, SIGNAL(fileSelected(TreeWidgetItem*)), SLOT(showItemConfig(TreeWidgetItem*)));
+  connect(m_scriptTree, SIGNAL(fileSelected(int)), SLOT(showItemConfig(int)));
   connect(m_scriptTree, SIGNAL(groupSelected()), SLOT(showFileSystem()));
   connect(m_scriptTree, SIGNAL(nothingSelected()), SLOT(showFileSystem()));
   connect(m_scriptTree, SIGNAL(readyToRun()), SLOT(executedScript()));
@@ -110,11 +111,10 @@ ProjectView::ProjectView(QWidget *parent)
   connect(this, SIGNAL(modifyDirectory()), SLOT(modifyingDirectory()));
   connect(m_scriptTree, SIGNAL(runningScript()), SLOT(execScript()));
   connect(m_scriptTree, SIGNAL(showStatusMessage(QString)), SIGNAL(showStatusMessage(QString)));
-  connect(m_scriptTree, SIGNAL(newEnvironmentItemAdded(TreeWidgetItem*)), m_scriptConf, SLOT(StoreEnvironment(TreeWidgetItem*)));
 
   m_mv = new MonitorView();
   m_mv->show();
-  connect(m_mv, SIGNAL(droppedTreeWidgetItem(TreeWidgetItem*,TextEditMonitor*)), SLOT(assignMonitorView(TreeWidgetItem*,TextEditMonitor*)));
+  connect(m_mv, SIGNAL(droppedScript(int,TextEditMonitor*)), SLOT(assignMonitorView(int,TextEditMonitor*)));
 }
 
 
@@ -189,6 +189,24 @@ void ProjectView::runScripts() // SLOT
 }
 
 
+void ProjectView::runFailedScripts() // SLOT
+{
+  m_scriptTree->runFailedScripts();
+}
+
+
+void ProjectView::runNotRunScripts() // SLOT
+{
+  m_scriptTree->runNotRunScripts();
+}
+
+
+void ProjectView::runInterruptedScripts() // SLOT
+{
+  m_scriptTree->runInterruptedScripts();
+}
+
+
 void ProjectView::execScript() // SLOT
 {
   // disable the DND for the trees
@@ -209,22 +227,28 @@ void ProjectView::executedScript() // SLOT
 }
 
 
-void ProjectView::showItemConfig(TreeWidgetItem *item) // SLOT
+void ProjectView::showItemConfig(int node) // SLOT
 {
   // it shows the configuration and hides the file system tree
-  m_scriptConf->setItem(item);
+  m_scriptConf->setItem(node);
   m_stack->setCurrentIndex(1);
   //statusBar()->showMessage(tr("Now you can configure the script options."));
 }
 
 
-void ProjectView::assignMonitorView(TreeWidgetItem *item, TextEditMonitor *box) // SLOT
+void ProjectView::assignMonitorView(int node, TextEditMonitor *box) // SLOT
 {
-  m_scriptConf->setMonitorView(item, box);
+  m_scriptConf->setMonitorView(node, box);
   //m_mv->assignScriptProcess(item, box);
 }
 
 
+void ProjectView::setPaused(bool paused) // SLOT
+{
+  m_scriptTree->setPaused(paused);
+}
+
+
 void ProjectView::modifyingDirectory() // SLOT
 {
   QFileDialog *dialog = new QFileDialog;
@@ -27,7 +27,6 @@ class LineEdit;
 class QPushButton;
 class FileSystemTreeView;
 class ScriptTree;
-class TreeWidgetItem;
 class ScriptConf;
 class QStackedWidget;
 class TextEdit;
@@ -167,6 +166,21 @@ class ProjectView : public QVBoxLayout
      */
     void runScripts();
 
+    /**
+     * Execute the scripts of the Project that failed the last time
+     */
+    void runFailedScripts();
+
+    /**
+     * Execute the scripts of the Project that have not been executed yet
+     */
+    void runNotRunScripts();
+
+    /**
+     * Execute the scripts of the Project that an interrupted execution didn't end
+     */
+    void runInterruptedScripts();
+
     /**
      * Execute the current script (under the mouse pointer) of the Project
      */
@@ -180,18 +194,18 @@ class ProjectView : public QVBoxLayout
     /**
      * Called to show the item configuration
      *
-     * @param item is the widget to which the options parameters has to be shown
+     * @param node is the Script Model node of the script whose options has to be shown
      */
-    void showItemConfig(TreeWidgetItem *item);
+    void showItemConfig(int node);
 
     /**
-     * Called to assign a monitor view with the related tree widget item script
+     * Called to assign a monitor view with the related script
      *
-     * @param item is the widget related to the script
+     * @param node is the Script Model node of the script
      * @param box is the monitor view text edit widget
      *
      */
-    void assignMonitorView(TreeWidgetItem *item, TextEditMonitor *box);
+    void assignMonitorView(int node, TextEditMonitor *box);
 
   public slots:
     /**
@@ -204,6 +218,13 @@ class ProjectView : public QVBoxLayout
      */
     void modifyingDirectory();
 
+    /**
+     * Called to pause or resume the execution of the project
+     *
+     * @param paused is true to pause, false to go on
+     */
+    void setPaused(bool paused);
+
   signals:
     /**
      * Emitted when the Project has been changed
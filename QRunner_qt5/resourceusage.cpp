@@ -0,0 +1,152 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include "resourceusage.h"
+
+ResourceUsage::ResourceUsage()
+{
+  m_valid = false;
+  m_wallTime = 0;
+  m_userTime = m_systemTime = 0;
+  m_maxRss = 0;
+  m_minorFaults = m_majorFaults = 0;
+  m_readBytes = m_writtenBytes = 0;
+}
+
+
+bool ResourceUsage::isValid() const
+{
+  return m_valid;
+}
+
+
+void ResourceUsage::setWallTime(qint64 msecs)
+{
+  m_wallTime = msecs;
+}
+
+
+qint64 ResourceUsage::wallTime() const
+{
+  return m_wallTime;
+}
+
+
+void ResourceUsage::setCpuTime(qint64 user, qint64 system)
+{
+  m_valid = true;
+  m_userTime = user;
+  m_systemTime = system;
+}
+
+
+qint64 ResourceUsage::userTime() const
+{
+  return m_userTime;
+}
+
+
+qint64 ResourceUsage::systemTime() const
+{
+  return m_systemTime;
+}
+
+
+void ResourceUsage::setMaxRss(qint64 kbytes)
+{
+  m_maxRss = kbytes;
+}
+
+
+qint64 ResourceUsage::maxRss() const
+{
+  return m_maxRss;
+}
+
+
+void ResourceUsage::setPageFaults(qint64 minor, qint64 major)
+{
+  m_minorFaults = minor;
+  m_majorFaults = major;
+}
+
+
+qint64 ResourceUsage::minorFaults() const
+{
+  return m_minorFaults;
+}
+
+
+qint64 ResourceUsage::majorFaults() const
+{
+  return m_majorFaults;
+}
+
+
+void ResourceUsage::setIo(qint64 readBytes, qint64 writtenBytes)
+{
+  m_readBytes = readBytes;
+  m_writtenBytes = writtenBytes;
+}
+
+
+qint64 ResourceUsage::readBytes() const
+{
+  return m_readBytes;
+}
+
+
+qint64 ResourceUsage::writtenBytes() const
+{
+  return m_writtenBytes;
+}
+
+
+void ResourceUsage::add(const ResourceUsage& other)
+{
+  if (!other.m_valid)
+    return;
+
+  m_valid = true;
+  m_userTime += other.m_userTime;
+  m_systemTime += other.m_systemTime;
+  m_maxRss = qMax(m_maxRss, other.m_maxRss);
+  m_minorFaults += other.m_minorFaults;
+  m_majorFaults += other.m_majorFaults;
+  m_readBytes += other.m_readBytes;
+  m_writtenBytes += other.m_writtenBytes;
+}
+
+
+QJsonObject ResourceUsage::toJson() const
+{
+  QJsonObject json;
+  json.insert("wall_ms", m_wallTime);
+  if (!m_valid)
+    return json;
+
+  json.insert("user_us", m_userTime);
+  json.insert("sys_us", m_systemTime);
+  json.insert("max_rss_kb", m_maxRss);
+  json.insert("minor_faults", m_minorFaults);
+  json.insert("major_faults", m_majorFaults);
+  json.insert("read_bytes", m_readBytes);
+  json.insert("write_bytes", m_writtenBytes);
+  return json;
+}
@@ -0,0 +1,179 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef RESOURCEUSAGE_H
+#define RESOURCEUSAGE_H
+
+#include <QtCore/QtGlobal>
+#include <QtCore/QJsonObject>
+
+/**
+ * This class describes the resources a script used during one execution:
+ * the elapsed time, the CPU time, the memory, the page faults and the disk
+ * I/O. The elapsed time is always known, the other values only when the
+ * script has been reaped by the spawn helper (see \ref SpawnServer)
+ *
+ * @author Giovanni Venturi
+ */
+class ResourceUsage
+{
+  public:
+    /**
+     * Create an empty usage: nothing has been measured
+     */
+    ResourceUsage();
+
+    /**
+     * @returns true if the CPU time, the memory, the page faults and the I/O have been measured
+     */
+    bool isValid() const;
+
+    /**
+     * Assign the elapsed time of the execution in milliseconds
+     */
+    void setWallTime(qint64 msecs);
+
+    /**
+     * @returns the elapsed time of the execution in milliseconds
+     */
+    qint64 wallTime() const;
+
+    /**
+     * Assign the CPU time of the execution: the usage becomes valid
+     *
+     * @param user is the time spent in user mode in microseconds
+     * @param system is the time spent in kernel mode in microseconds
+     */
+    void setCpuTime(qint64 user, qint64 system);
+
+    /**
+     * @returns the time spent in user mode in microseconds
+     */
+    qint64 userTime() const;
+
+    /**
+     * @returns the time spent in kernel mode in microseconds
+     */
+    qint64 systemTime() const;
+
+    /**
+     * Assign the peak resident set size in KiB
+     */
+    void setMaxRss(qint64 kbytes);
+
+    /**
+     * @returns the peak resident set size in KiB
+     */
+    qint64 maxRss() const;
+
+    /**
+     * Assign the number of page faults
+     *
+     * @param minor is the number of faults served without I/O
+     * @param major is the number of faults that needed I/O
+     */
+    void setPageFaults(qint64 minor, qint64 major);
+
+    /**
+     * @returns the number of page faults served without I/O
+     */
+    qint64 minorFaults() const;
+
+    /**
+     * @returns the number of page faults that needed I/O
+     */
+    qint64 majorFaults() const;
+
+    /**
+     * Assign the number of bytes read from and written to the disk
+     */
+    void setIo(qint64 readBytes, qint64 writtenBytes);
+
+    /**
+     * @returns the number of bytes read from the disk
+     */
+    qint64 readBytes() const;
+
+    /**
+     * @returns the number of bytes written to the disk
+     */
+    qint64 writtenBytes() const;
+
+    /**
+     * Add what another process used, i.e. a descendant of the script that has been
+     * reaped by the spawn helper and not by the script itself: the times, the faults
+     * and the I/O are summed, the peak resident set size is the largest one
+     *
+     * @param other is the usage of the other process
+     */
+    void add(const ResourceUsage& other);
+
+    /**
+     * @returns the usage as JSON object: the values that have not been measured are missing
+     */
+    QJsonObject toJson() const;
+
+  private:
+    /**
+     * true if more than the elapsed time has been measured
+     */
+    bool m_valid;
+
+    /**
+     * The elapsed time in milliseconds
+     */
+    qint64 m_wallTime;
+
+    /**
+     * The time spent in user mode in microseconds
+     */
+    qint64 m_userTime;
+
+    /**
+     * The time spent in kernel mode in microseconds
+     */
+    qint64 m_systemTime;
+
+    /**
+     * The peak resident set size in KiB
+     */
+    qint64 m_maxRss;
+
+    /**
+     * The number of page faults served without I/O
+     */
+    qint64 m_minorFaults;
+
+    /**
+     * The number of page faults that needed I/O
+     */
+    qint64 m_majorFaults;
+
+    /**
+     * The number of bytes read from the disk
+     */
+    qint64 m_readBytes;
+
+    /**
+     * The number of bytes written to the disk
+     */
+    qint64 m_writtenBytes;
+};
+
+#endif
@@ -0,0 +1,317 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QDateTime>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QtAlgorithms>
+#include <QtCore/QDebug>
+
+#include "resultcache.h"
+
+namespace
+{
+  /**
+   * The version of the hashed inputs and of the entries: a new version doesn't use the old entries
+   */
+  const int CacheVersion = 1;
+
+  /**
+   * Add a field to the hash with its length first, so the fields cannot be confused
+   */
+  void addField(QCryptographicHash& hash, const QByteArray& data)
+  {
+    hash.addData(QByteArray::number(data.size()) + ':');
+    hash.addData(data);
+  }
+
+  /**
+   * Write a whole file, or leave the previous one
+   */
+  bool writeFile(const QString& fileName, const QByteArray& data)
+  {
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+      qDebug() << "cannot create file in writing: " << fileName;
+      return false;
+    }
+    file.write(data);
+    return file.commit();
+  }
+
+  /**
+   * Copy a file a chunk at a time, or leave the previous copy
+   */
+  bool copyFile(const QString& source, const QString& fileName)
+  {
+    QFile in(source);
+    if (!in.open(QIODevice::ReadOnly))
+    {
+      qDebug() << "cannot read the file:" << source;
+      return false;
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+      qDebug() << "cannot create file in writing: " << fileName;
+      return false;
+    }
+    while (!in.atEnd())
+    {
+      QByteArray chunk = in.read(1024 * 1024);
+      if (chunk.isEmpty() || (file.write(chunk) != chunk.size()))
+      {
+        file.cancelWriting();
+        break;
+      }
+    }
+    return file.commit();
+  }
+}
+
+ResultCache::ResultCache(const QString& dir, qint64 maxSize)
+{
+  m_dir = dir;
+  m_maxSize = maxSize;
+}
+
+
+QString ResultCache::dirFor(const QString& basedir)
+{
+  return basedir + "/.cache";
+}
+
+
+QString ResultCache::key(const QString& script, const QString& params,
+                         const QList<QPair<QString, QString> >& env, const QStringList& inputs, int times)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  addField(hash, QByteArray::number(CacheVersion));
+
+  // the script is an input like the files it reads
+  if (!addFile(hash, script))
+    return QString();
+  addField(hash, params.toUtf8());
+  addField(hash, QByteArray::number(times));
+
+  // the order of the variables doesn't change the environment
+  QStringList variables;
+  for (int i = 0; i < env.size(); i++)
+    variables << env.at(i).first + "=" + env.at(i).second;
+  variables.sort();
+  addField(hash, QByteArray::number(variables.size()));
+  for (int i = 0; i < variables.size(); i++)
+    addField(hash, variables.at(i).toUtf8());
+
+  QDir dir = QFileInfo(script).absoluteDir();
+  addField(hash, QByteArray::number(inputs.size()));
+  for (int i = 0; i < inputs.size(); i++)
+  {
+    if (!addFile(hash, QDir::cleanPath(dir.absoluteFilePath(inputs.at(i)))))
+      return QString();
+  }
+
+  return QString::fromLatin1(hash.result().toHex());
+}
+
+
+bool ResultCache::addFile(QCryptographicHash& hash, const QString& path)
+{
+  addField(hash, path.toUtf8());
+
+  QFileInfo info(path);
+  if (!info.exists())
+  {
+    // the script may create it: its absence is an input too
+    addField(hash, "missing");
+    return true;
+  }
+
+  QStringList files;
+  if (info.isDir())
+  {
+    // the files of a directory in a stable order
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext())
+      files << it.next();
+    files.sort();
+    addField(hash, "directory " + QByteArray::number(files.size()));
+  }
+  else
+    files << path;
+
+  for (int i = 0; i < files.size(); i++)
+  {
+    QFile file(files.at(i));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+      qDebug() << "cannot read the input file:" << files.at(i);
+      return false;
+    }
+    addField(hash, files.at(i).toUtf8());
+    addField(hash, QByteArray::number(file.size()));
+    if (!hash.addData(&file))
+    {
+      qDebug() << "cannot read the input file:" << files.at(i);
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool ResultCache::lookup(const QString& key, Result *result)
+{
+  if (key.isEmpty())
+    return false;
+
+  QString entry = m_dir + "/" + key;
+  QFile resultFile(entry + "/result.json");
+  if (!resultFile.open(QIODevice::ReadOnly))
+    return false;
+  QJsonObject json = QJsonDocument::fromJson(resultFile.readAll()).object();
+  resultFile.close();
+  if (json.value("version").toInt() != CacheVersion)
+    return false;
+
+  QString logFile = entry + "/output.log";
+  if (!QFile::exists(logFile))
+    return false;
+  result->logFile = logFile;
+  result->code = json.value("exit_code").toInt();
+  result->duration = (qint64)json.value("duration_ms").toDouble();
+
+  // the entries are removed by the time of their last use
+  json.insert("used", QDateTime::currentDateTime().toString(Qt::ISODate));
+  writeFile(resultFile.fileName(), QJsonDocument(json).toJson());
+  return true;
+}
+
+
+bool ResultCache::store(const QString& key, const QString& logFile, int code, qint64 duration)
+{
+  if (key.isEmpty() || (QFileInfo(logFile).size() >= m_maxSize))
+    // the cache is disabled or the entry would not fit
+    return false;
+
+  QString entry = m_dir + "/" + key;
+  if (!QDir().mkpath(entry))
+  {
+    qDebug() << "cannot create" << entry;
+    return false;
+  }
+
+  QJsonObject json;
+  json.insert("version", CacheVersion);
+  json.insert("exit_code", code);
+  json.insert("duration_ms", duration);
+  json.insert("stored", QDateTime::currentDateTime().toString(Qt::ISODate));
+  json.insert("used", QDateTime::currentDateTime().toString(Qt::ISODate));
+
+  // the result is written last: an entry without it is not used
+  if (!copyFile(logFile, entry + "/output.log") ||
+      !writeFile(entry + "/result.json", QJsonDocument(json).toJson()))
+  {
+    QDir(entry).removeRecursively();
+    return false;
+  }
+
+  evict();
+  return true;
+}
+
+
+void ResultCache::evict()
+{
+  QFileInfoList entries = QDir(m_dir).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+  QList<QPair<QDateTime, QString> > used;
+  qint64 size = 0;
+  for (int i = 0; i < entries.size(); i++)
+  {
+    QString entry = entries.at(i).absoluteFilePath();
+    QFileInfoList files = QDir(entry).entryInfoList(QDir::Files | QDir::Hidden);
+    for (int j = 0; j < files.size(); j++)
+      size += files.at(j).size();
+
+    // an entry being written has no result yet: it's just been used
+    QFileInfo result(entry + "/result.json");
+    used << qMakePair(result.exists() ? result.lastModified() : QDateTime::currentDateTime(), entry);
+  }
+
+  // the least recently used entries first
+  qSort(used);
+  for (int i = 0; (i < used.size()) && (size > m_maxSize); i++)
+  {
+    QFileInfoList files = QDir(used.at(i).second).entryInfoList(QDir::Files | QDir::Hidden);
+    qint64 entrySize = 0;
+    for (int j = 0; j < files.size(); j++)
+      entrySize += files.at(j).size();
+
+    if (QDir(used.at(i).second).removeRecursively())
+      size -= entrySize;
+  }
+}
+
+
+ResultLookup::ResultLookup(const QString& dir, qint64 maxSize, const QString& script, const QString& params,
+                           const QList<QPair<QString, QString> >& env, const QStringList& inputs, int times,
+                           QObject *parent)
+  : QThread(parent), m_cache(dir, maxSize)
+{
+  m_script = script;
+  m_params = params;
+  m_environment = env;
+  m_inputs = inputs;
+  m_times = times;
+  m_found = false;
+  m_result.code = 0;
+  m_result.duration = 0;
+}
+
+
+QString ResultLookup::key() const
+{
+  return m_key;
+}
+
+
+bool ResultLookup::found() const
+{
+  return m_found;
+}
+
+
+const ResultCache::Result& ResultLookup::result() const
+{
+  return m_result;
+}
+
+
+void ResultLookup::run()
+{
+  m_key = ResultCache::key(m_script, m_params, m_environment, m_inputs, m_times);
+  m_found = m_cache.lookup(m_key, &m_result);
+}
@@ -0,0 +1,233 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QThread>
+
+class QCryptographicHash;
+
+/**
+ * This class keeps the results of the scripts whose output depends only on
+ * their inputs: the script file, its parameters, its environment variables
+ * and the files it reads. The inputs are hashed before the script starts
+ * (see \ref key()): if an entry with the same hash exists the saved log and
+ * exit code are used instead of running the script again.
+ *
+ * Each entry is a directory named after the hash, with the log of the
+ * execution and a JSON file with its exit code. Using an entry touches its
+ * JSON file, so the entries used less recently are removed first when the
+ * cache grows over its size limit (see \ref evict())
+ *
+ * @author Giovanni Venturi
+ */
+class ResultCache
+{
+  public:
+    /**
+     * The result of an execution
+     */
+    struct Result
+    {
+      QString logFile;        // what the script wrote, the "executing #" lines included
+      int code;               // the exit code of the script
+      qint64 duration;        // the milliseconds the execution took
+    };
+
+    /**
+     * Create the cache object
+     *
+     * @param dir is the directory of the entries, created when the first entry is stored
+     * @param maxSize is the size limit of the cache in bytes, 0 means nothing is stored
+     */
+    ResultCache(const QString& dir, qint64 maxSize);
+
+    /**
+     * @returns the directory of the cache of a log base directory
+     *
+     * @param basedir is the log base directory
+     */
+    static QString dirFor(const QString& basedir);
+
+    /**
+     * Hash the inputs of a script. A relative input path starts from the script
+     * directory, a directory is hashed with all its files and a missing file is
+     * hashed as missing
+     *
+     * @param script is the absolute file path of the script
+     * @param params is the input parameters line
+     * @param env is the environment variables of the script: name and value
+     * @param inputs is the files the script reads
+     * @param times is the number of times the script is executed
+     *
+     * @returns the hex hash of the inputs, empty if a file cannot be read
+     */
+    static QString key(const QString& script, const QString& params,
+                       const QList<QPair<QString, QString> >& env, const QStringList& inputs, int times);
+
+    /**
+     * Look for the result of an execution with the same inputs, and mark it as used.
+     * The log is not read: the result tells its file
+     *
+     * @param key is the hash of the inputs (see \ref key())
+     * @param result is set to the saved result if it's found
+     *
+     * @returns true if the result is found
+     */
+    bool lookup(const QString& key, Result *result);
+
+    /**
+     * Save the result of an execution, then remove the old entries if the cache is too big.
+     * The log is copied a chunk at a time, it's not read in memory
+     *
+     * @param key is the hash of the inputs (see \ref key())
+     * @param logFile is the file with the log of the execution
+     * @param code is the exit code of the script
+     * @param duration is the milliseconds the execution took
+     *
+     * @returns false if the result cannot be saved
+     */
+    bool store(const QString& key, const QString& logFile, int code, qint64 duration);
+
+    /**
+     * Remove the entries used less recently until the cache fits its size limit
+     */
+    void evict();
+
+  private:
+    /**
+     * Add a file, or all the files of a directory, to the hash
+     *
+     * @returns false if a file cannot be read
+     */
+    static bool addFile(QCryptographicHash& hash, const QString& path);
+
+    /**
+     * The directory of the entries
+     */
+    QString m_dir;
+
+    /**
+     * The size limit in bytes
+     */
+    qint64 m_maxSize;
+};
+
+/**
+ * This class hashes the inputs of a script and looks for the result of an
+ * execution with the same inputs from its own thread: the files a script reads
+ * can be big and the application doesn't wait for them. The key and the result
+ * can be read when the thread finished
+ *
+ * @author Giovanni Venturi
+ */
+class ResultLookup : public QThread
+{
+  public:
+    /**
+     * Create the lookup: it starts with start()
+     *
+     * @param dir is the directory of the cache entries
+     * @param maxSize is the size limit of the cache in bytes
+     * @param script is the absolute file path of the script
+     * @param params is the input parameters line
+     * @param env is the environment variables of the script: name and value
+     * @param inputs is the files the script reads
+     * @param times is the number of times the script is executed
+     * @param parent is the parent object
+     */
+    ResultLookup(const QString& dir, qint64 maxSize, const QString& script, const QString& params,
+                 const QList<QPair<QString, QString> >& env, const QStringList& inputs, int times,
+                 QObject *parent = 0);
+
+    /**
+     * @returns the hash of the inputs, empty if a file cannot be read (see \ref ResultCache::key())
+     */
+    QString key() const;
+
+    /**
+     * @returns true if the result of an execution with the same inputs is found
+     */
+    bool found() const;
+
+    /**
+     * @returns the result found
+     */
+    const ResultCache::Result& result() const;
+
+  protected:
+    /**
+     * Hash the inputs and look for the result
+     */
+    void run();
+
+  private:
+    /**
+     * The cache where the result is looked for
+     */
+    ResultCache m_cache;
+
+    /**
+     * The absolute file path of the script
+     */
+    QString m_script;
+
+    /**
+     * The input parameters line
+     */
+    QString m_params;
+
+    /**
+     * The environment variables of the script
+     */
+    QList<QPair<QString, QString> > m_environment;
+
+    /**
+     * The files the script reads
+     */
+    QStringList m_inputs;
+
+    /**
+     * The number of times the script is executed
+     */
+    int m_times;
+
+    /**
+     * The hash of the inputs
+     */
+    QString m_key;
+
+    /**
+     * true if the result is found
+     */
+    bool m_found;
+
+    /**
+     * The result found
+     */
+    ResultCache::Result m_result;
+};
+
+#endif
@@ -0,0 +1,210 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QDebug>
+
+#include "runstate.h"
+#include "scriptjob.h"
+
+namespace
+{
+  /**
+   * The names of the outcomes in the state file, in the order of \ref RunState::Status
+   */
+  const char *StatusNames[] = { "notrun", "queued", "running", "passed", "failed", "timedout", "skipped" };
+  const int StatusCount = sizeof(StatusNames) / sizeof(StatusNames[0]);
+}
+
+RunState::RunState()
+{
+  m_modified = false;
+}
+
+
+QString RunState::fileFor(const QString& project)
+{
+  QFileInfo info(project);
+  return info.absolutePath() + "/" + info.completeBaseName() + ".state";
+}
+
+
+QString RunState::key(const ScriptJob& job)
+{
+  return (job.logPath() << job.name()).join("/");
+}
+
+
+bool RunState::parseSelection(const QString& name, Selection *selection)
+{
+  if (name == "all")
+    *selection = AllScripts;
+  else if (name == "failed")
+    *selection = FailedScripts;
+  else if (name == "notrun")
+    *selection = NotRunScripts;
+  else if (name == "interrupted")
+    *selection = InterruptedScripts;
+  else
+    return false;
+  return true;
+}
+
+
+QString RunState::statusName(Status status)
+{
+  return QString(StatusNames[status]);
+}
+
+
+void RunState::reset(const QString& fileName)
+{
+  m_entries.clear();
+  m_fileName = fileName;
+  m_modified = false;
+}
+
+
+bool RunState::load(const QString& fileName)
+{
+  reset(fileName);
+
+  QFile file(fileName);
+  if (!file.exists())
+    // the project has never been executed
+    return true;
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+  if (!json.value("scripts").isObject())
+  {
+    qDebug() << fileName << "is not a state file";
+    return false;
+  }
+
+  QJsonObject scripts = json.value("scripts").toObject();
+  for (QJsonObject::const_iterator it = scripts.constBegin(); it != scripts.constEnd(); ++it)
+  {
+    QJsonObject script = it.value().toObject();
+    QString name = script.value("status").toString();
+    for (int i = 0; i < StatusCount; i++)
+    {
+      if (name != StatusNames[i])
+        continue;
+
+      Entry entry;
+      entry.status = (Status)i;
+      entry.code = script.value("exit_code").toInt();
+      entry.updated = QDateTime::fromString(script.value("updated").toString(), Qt::ISODate);
+      m_entries.insert(it.key(), entry);
+      break;
+    }
+  }
+  return true;
+}
+
+
+bool RunState::save()
+{
+  if (m_fileName.isEmpty() || !m_modified)
+    return true;
+
+  QJsonObject scripts;
+  QHashIterator<QString, Entry> iterator(m_entries);
+  while (iterator.hasNext())
+  {
+    iterator.next();
+    QJsonObject script;
+    script.insert("status", statusName(iterator.value().status));
+    if ((iterator.value().status >= Passed) && (iterator.value().status <= TimedOut))
+      script.insert("exit_code", iterator.value().code);
+    script.insert("updated", iterator.value().updated.toString(Qt::ISODate));
+    scripts.insert(iterator.key(), script);
+  }
+  QJsonObject json;
+  json.insert("version", 1);
+  json.insert("scripts", scripts);
+
+  // an interrupted write doesn't lose the previous state
+  QSaveFile file(m_fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << "cannot create file in writing: " << m_fileName;
+    return false;
+  }
+  file.write(QJsonDocument(json).toJson());
+  if (!file.commit())
+    return false;
+
+  m_modified = false;
+  return true;
+}
+
+
+bool RunState::saveAs(const QString& fileName)
+{
+  m_fileName = fileName;
+  m_modified = true;
+  return save();
+}
+
+
+QString RunState::fileName() const
+{
+  return m_fileName;
+}
+
+
+void RunState::setStatus(const QString& key, Status status, int code)
+{
+  Entry entry;
+  entry.status = status;
+  entry.code = code;
+  entry.updated = QDateTime::currentDateTime();
+  m_entries.insert(key, entry);
+  m_modified = true;
+}
+
+
+RunState::Status RunState::status(const QString& key) const
+{
+  return m_entries.contains(key) ? m_entries.value(key).status : NotRun;
+}
+
+
+bool RunState::selects(const QString& key, Selection selection) const
+{
+  Status last = status(key);
+  switch (selection)
+  {
+    case FailedScripts:
+      return (last == Failed) || (last == TimedOut);
+    case NotRunScripts:
+      return (last == NotRun) || (last == Skipped);
+    case InterruptedScripts:
+      return (last == Queued) || (last == Running);
+    default:
+      return true;
+  }
+}
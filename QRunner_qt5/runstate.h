@@ -0,0 +1,193 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef RUNSTATE_H
+#define RUNSTATE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QDateTime>
+
+class ScriptJob;
+
+/**
+ * This class keeps the last outcome of every script of a project: passed,
+ * failed, timed out, skipped or still queued/running when the execution has
+ * been interrupted. It's saved beside the project file (see \ref fileFor())
+ * so that a later execution can queue just the scripts that need it: the
+ * failed ones, the ones that didn't run or the ones of an interrupted run
+ * (see \ref Selection). The scripts that are not executed keep the outcome
+ * they had
+ *
+ * @author Giovanni Venturi
+ */
+class RunState
+{
+  public:
+    /**
+     * The last outcome of a script
+     */
+    enum Status
+    {
+      NotRun,
+      Queued,
+      Running,
+      Passed,
+      Failed,
+      TimedOut,
+      Skipped
+    };
+
+    /**
+     * The scripts to execute
+     */
+    enum Selection
+    {
+      AllScripts,
+      FailedScripts,          // failed or timed out
+      NotRunScripts,          // never executed or skipped
+      InterruptedScripts      // still queued or running when the last execution stopped
+    };
+
+    /**
+     * Create an empty state: all the scripts are not run
+     */
+    RunState();
+
+    /**
+     * @returns the state file of a project: the project file name with the ".state" extension
+     *
+     * @param project is the project file
+     */
+    static QString fileFor(const QString& project);
+
+    /**
+     * @returns the key of a script in the state: its groups and its file name
+     *
+     * @param job is the description of the script
+     */
+    static QString key(const ScriptJob& job);
+
+    /**
+     * Convert the name of a selection: "all", "failed", "notrun" or "interrupted"
+     *
+     * @param name is the name of the selection
+     * @param selection is set to the selection if the name is valid
+     *
+     * @returns false if the name is not valid
+     */
+    static bool parseSelection(const QString& name, Selection *selection);
+
+    /**
+     * @returns the name of an outcome in the state file, i.e. "passed"
+     *
+     * @param status is the outcome
+     */
+    static QString statusName(Status status);
+
+    /**
+     * Forget all the outcomes and assign the file where the state is saved
+     *
+     * @param fileName is the state file, empty to keep the state just in memory
+     */
+    void reset(const QString& fileName = QString());
+
+    /**
+     * Read the outcomes saved by a previous execution: a missing file is an empty state
+     *
+     * @param fileName is the state file, it's where the state is saved later
+     *
+     * @returns false if the file exists but it's not a state file
+     */
+    bool load(const QString& fileName);
+
+    /**
+     * Write the state into its file if it changed since it was saved or loaded
+     *
+     * @returns false if the file cannot be written
+     */
+    bool save();
+
+    /**
+     * Save the state into another file from now on, i.e. the project has been saved with another name
+     *
+     * @param fileName is the new state file
+     *
+     * @returns false if the file cannot be written
+     */
+    bool saveAs(const QString& fileName);
+
+    /**
+     * @returns the file where the state is saved, empty if it's kept just in memory
+     */
+    QString fileName() const;
+
+    /**
+     * Assign the outcome of a script
+     *
+     * @param key is the script key (see \ref key())
+     * @param status is the outcome
+     * @param code is the exit code of the script if it ended
+     */
+    void setStatus(const QString& key, Status status, int code = 0);
+
+    /**
+     * @returns the last outcome of a script, \ref NotRun if it's unknown
+     *
+     * @param key is the script key (see \ref key())
+     */
+    Status status(const QString& key) const;
+
+    /**
+     * @returns true if the script has to be executed with the selection
+     *
+     * @param key is the script key (see \ref key())
+     * @param selection is what has to be executed
+     */
+    bool selects(const QString& key, Selection selection) const;
+
+  private:
+    /**
+     * The outcome of a script
+     */
+    struct Entry
+    {
+      Status status;
+      int code;               // the exit code if it ended
+      QDateTime updated;      // when the outcome changed
+    };
+
+    /**
+     * The outcomes by script key
+     */
+    QHash<QString, Entry> m_entries;
+
+    /**
+     * The state file, empty if the state is kept just in memory
+     */
+    QString m_fileName;
+
+    /**
+     * true if the state changed since it was loaded or saved
+     */
+    bool m_modified;
+};
+
+#endif
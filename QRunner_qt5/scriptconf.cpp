@@ -19,6 +19,7 @@
 
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QSpinBox>
+#include <QtWidgets/QCheckBox>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QTreeWidget>
 #include <QtWidgets/QPushButton>
@@ -26,7 +27,7 @@
 
 #include <QtCore/QDebug>
 
-#include "treewidgetitem.h"
+#include "scriptmodel.h"
 #include "scriptconf.h"
 
 ScriptConf::ScriptConf(QWidget *parent)
@@ -66,6 +67,77 @@ ScriptConf::ScriptConf(QWidget *parent)
 
   confOptionLayout->addLayout(confDelayOptionHLayout);
 
+  QHBoxLayout* confBenchmarkHLayout = new QHBoxLayout;
+  m_benchmark = new QCheckBox(tr("benchmark mode"));
+  m_benchmark->setToolTip( tr("<p>Collect the elapsed and the CPU time of the repeated runs in statistics "
+                              "saved next to the log file and compared with the saved baseline.</p>") );
+  connect(m_benchmark, SIGNAL(toggled(bool)), SLOT(assignBenchmark(bool)));
+  QLabel *confWarmupLabel = new QLabel(tr("warmup runs:"));
+  m_warmup = new QSpinBox;
+
+  // the warmup runs are executed before the repeated ones and not measured
+  m_warmup->setMinimum( 0 );
+  m_warmup->setEnabled( false );
+  connect(m_warmup, SIGNAL(valueChanged(int)), SLOT(assignWarmup(int)));
+
+  confBenchmarkHLayout->addWidget(m_benchmark);
+  confBenchmarkHLayout->addWidget(confWarmupLabel);
+  confBenchmarkHLayout->addWidget(m_warmup);
+
+  confOptionLayout->addLayout(confBenchmarkHLayout);
+
+  QHBoxLayout* confTimeoutHLayout = new QHBoxLayout;
+  QLabel *confTimeoutLabel = new QLabel(tr("terminate after:"));
+  m_timeout = new QSpinBox;
+
+  // 0 seconds means that the script can run forever
+  m_timeout->setRange( 0, 7 * 24 * 3600 );
+  m_timeout->setSuffix( tr(" s") );
+  m_timeout->setSpecialValueText( tr("no limit") );
+  m_timeout->setToolTip( tr("The script is terminated if an execution takes longer.") );
+  connect(m_timeout, SIGNAL(valueChanged(int)), SLOT(assignTimeout(int)));
+  QLabel *confIdleLabel = new QLabel(tr("or without output for:"));
+  m_idleTimeout = new QSpinBox;
+  m_idleTimeout->setRange( 0, 7 * 24 * 3600 );
+  m_idleTimeout->setSuffix( tr(" s") );
+  m_idleTimeout->setSpecialValueText( tr("no limit") );
+  m_idleTimeout->setToolTip( tr("The script is terminated if it writes nothing for so long.") );
+  connect(m_idleTimeout, SIGNAL(valueChanged(int)), SLOT(assignIdleTimeout(int)));
+
+  confTimeoutHLayout->addWidget(confTimeoutLabel);
+  confTimeoutHLayout->addWidget(m_timeout);
+  confTimeoutHLayout->addWidget(confIdleLabel);
+  confTimeoutHLayout->addWidget(m_idleTimeout);
+
+  confOptionLayout->addLayout(confTimeoutHLayout);
+
+  QHBoxLayout* confCacheHLayout = new QHBoxLayout;
+  m_cached = new QCheckBox(tr("cache the results"));
+  m_cached->setToolTip( tr("<p>Do not run the script again when the script file, its parameters, its "
+                           "environment and its input files did not change: the saved log and exit "
+                           "code are restored.</p>") );
+  connect(m_cached, SIGNAL(toggled(bool)), SLOT(assignCached(bool)));
+  QLabel *confInputsLabel = new QLabel(tr("input files:"));
+  m_inputsLine = new QLineEdit;
+
+  // the input files count only for a cached script
+  m_inputsLine->setEnabled( false );
+  m_inputsLine->setToolTip( tr("<p>Specify here the files the script reads, separated by commas. "
+                               "A relative path starts from the script directory.</p>") );
+  connect(m_inputsLine, SIGNAL(editingFinished()), SLOT(assignInputs()));
+
+  confCacheHLayout->addWidget(m_cached);
+  confCacheHLayout->addWidget(confInputsLabel);
+  confCacheHLayout->addWidget(m_inputsLine);
+
+  confOptionLayout->addLayout(confCacheHLayout);
+
+  // the sweep is written in the project file: here it's just shown
+  m_sweepLabel = new QLabel;
+  m_sweepLabel->setWordWrap( true );
+  m_sweepLabel->hide();
+  confOptionLayout->addWidget(m_sweepLabel);
+
   QLabel *confLabel3 = new QLabel(tr("Here you can define the script environment variables:"));
   confOptionLayout->addWidget(confLabel3);
 
@@ -101,37 +173,85 @@ ScriptConf::ScriptConf(QWidget *parent)
   confHoriz3->addWidget(m_paramsLine);
   confOptionLayout->addLayout(confHoriz3);
 
+  QHBoxLayout* confHoriz4 = new QHBoxLayout;
+  m_idLine = new QLineEdit;
+  connect(m_idLine, SIGNAL(editingFinished()), SLOT(assignScriptId()));
+  m_idLine->setToolTip( tr("Specify here the name other scripts use to run after this one.") );
+  QLabel* idLabel = new QLabel( tr("Script id:") );
+  m_afterLine = new QLineEdit;
+  connect(m_afterLine, SIGNAL(editingFinished()), SLOT(assignDependencies()));
+  m_afterLine->setToolTip( tr("<p>Specify here the ids of the scripts, separated by commas, "
+                              "that have to end correctly before this one can start.</p>") );
+  QLabel* afterLabel = new QLabel( tr("Run after:") );
+  confHoriz4->addWidget(idLabel);
+  confHoriz4->addWidget(m_idLine);
+  confHoriz4->addWidget(afterLabel);
+  confHoriz4->addWidget(m_afterLine);
+  confOptionLayout->addLayout(confHoriz4);
+
   confOptionLayout->addStretch();
 
   setLayout(confOptionLayout);
 
-  m_item = 0;
+  m_model = 0;
+  m_node = 0;
 }
 
 
 ScriptConf::~ScriptConf()
 {
   delete m_runTimes;
+  delete m_benchmark;
+  delete m_warmup;
+  delete m_timeout;
+  delete m_idleTimeout;
+  delete m_cached;
+  delete m_inputsLine;
+  delete m_sweepLabel;
   delete m_paramsLine;
+  delete m_idLine;
+  delete m_afterLine;
+}
+
+
+void ScriptConf::setModel(ScriptModel *model)
+{
+  m_model = model;
 }
 
 
-void ScriptConf::setItem(TreeWidgetItem *item)
+void ScriptConf::setItem(int node)
 {
-  if (item)
+  if (m_model && node)
   {
     // I'm changing the item, so no sense to let enable the "modification project"
     // property. The real changes that has to be stored is when a script File
     // properties is going to change (you modify the delay value or the repeat times one, ...)
     m_recordModify = false;
 
-    m_item = item;
-    m_runTimes->setValue(m_item->times());
-    m_delay->setValue(m_item->delay());
-
-    setEnvironment(m_confEnv, m_item);
-
-    m_paramsLine->setText(m_item->parameters());
+    m_node = node;
+    m_runTimes->setValue(m_model->times(m_node));
+    m_delay->setValue(m_model->delay(m_node));
+    m_benchmark->setChecked(m_model->benchmark(m_node));
+    m_warmup->setValue(m_model->warmup(m_node));
+    m_timeout->setValue(m_model->timeout(m_node));
+    m_idleTimeout->setValue(m_model->idleTimeout(m_node));
+    m_cached->setChecked(m_model->cached(m_node));
+    m_inputsLine->setText(m_model->inputs(m_node).join(", "));
+
+    Sweep sweep = m_model->sweep(m_node);
+    QStringList axes;
+    for (int i = 0; i < sweep.axisCount(); i++)
+      axes << (sweep.axisName(i).isEmpty() ? tr("parameters") : sweep.axisName(i));
+    m_sweepLabel->setText(tr("Parameter sweep (%1): %2 jobs over %3")
+      .arg(Sweep::modeName(sweep.mode())).arg(sweep.count()).arg(axes.join(", ")));
+    m_sweepLabel->setVisible(!sweep.isEmpty());
+
+    setEnvironment();
+
+    m_paramsLine->setText(m_model->parameters(m_node));
+    m_idLine->setText(m_model->scriptId(m_node));
+    m_afterLine->setText(m_model->dependencies(m_node).join(", "));
 
     // are we sure that the 2 changes are done before the assignment?
     m_recordModify = true;
@@ -139,29 +259,39 @@ void ScriptConf::setItem(TreeWidgetItem *item)
 }
 
 
-void ScriptConf::setMonitorView(TreeWidgetItem *item, TextEditMonitor *box)
+void ScriptConf::setMonitorView(int node, TextEditMonitor *box)
 {
-  if (item)
+  if (m_model && node)
   {
-    item->setTextEditMonitor( box );
+    m_model->setTextEditMonitor( node, box );
   }
 }
 
 
-void ScriptConf::setEnvironment(QTreeWidget *confEnv, TreeWidgetItem *item)
+void ScriptConf::setEnvironment()
 {
-  for (int i = 0; i < confEnv->topLevelItemCount(); i++)
-    // hide all unwanted item: we changed the item
-    confEnv->topLevelItem(i)->setHidden(true);
+  // the lines are filled without reporting any change
+  m_confEnv->blockSignals(true);
+  m_confEnv->clear();
 
-  QMapIterator<QTreeWidgetItem*, QPair<QString, QString> > iterator(item->environment());
-  while (iterator.hasNext())
+  QList< QPair<QString, QString> > environment = m_model->environment(m_node);
+  for (int i = 0; i < environment.size(); i++)
   {
-    iterator.next();
-
-    // show the related item for the environment
-    iterator.key()->setHidden(false);
+    QTreeWidgetItem* item = new QTreeWidgetItem(QStringList() << environment.at(i).first << environment.at(i).second);
+    item->setFlags( Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    m_confEnv->addTopLevelItem(item);
   }
+  m_confEnv->blockSignals(false);
+}
+
+
+void ScriptConf::storeEnvironment()
+{
+  QList< QPair<QString, QString> > environment;
+  for (int i = 0; i < m_confEnv->topLevelItemCount(); i++)
+    environment << qMakePair(m_confEnv->topLevelItem(i)->text(0), m_confEnv->topLevelItem(i)->text(1));
+
+  m_model->setEnvironment(m_node, environment);
 }
 
 
@@ -169,10 +299,10 @@ void ScriptConf::setEnvironment(QTreeWidget *confEnv, TreeWidgetItem *item)
 
 void ScriptConf::assignRunTimes(int value) // SLOT
 {
-  if (m_item)
+  if (m_node)
   {
     qDebug() << "assignRunTimes(" << value << ")";
-    m_item->setTimes( value );
+    m_model->setTimes( m_node, value );
     if (m_recordModify)
       emit modifiedProject();
   }
@@ -181,10 +311,10 @@ void ScriptConf::assignRunTimes(int value) // SLOT
 
 void ScriptConf::assignDelayTime(int value) // SLOT
 {
-  if (m_item)
+  if (m_node)
   {
     qDebug() << "assignDelayTime(" << value << ")";
-    m_item->setDelay( value );
+    m_model->setDelay( m_node, value );
     if (m_recordModify)
       emit modifiedProject();
 
@@ -198,29 +328,169 @@ void ScriptConf::assignDelayTime(int value) // SLOT
 }
 
 
+void ScriptConf::assignBenchmark(bool checked) // SLOT
+{
+  m_warmup->setEnabled(checked);
+  if (m_node)
+  {
+    m_model->setBenchmark( m_node, checked );
+    if (m_recordModify)
+      emit modifiedProject();
+  }
+}
+
+
+void ScriptConf::assignWarmup(int value) // SLOT
+{
+  if (m_node)
+  {
+    m_model->setWarmup( m_node, value );
+    if (m_recordModify)
+      emit modifiedProject();
+  }
+}
+
+
+void ScriptConf::assignTimeout(int value) // SLOT
+{
+  if (m_node)
+  {
+    m_model->setTimeout( m_node, value );
+    if (m_recordModify)
+      emit modifiedProject();
+  }
+}
+
+
+void ScriptConf::assignIdleTimeout(int value) // SLOT
+{
+  if (m_node)
+  {
+    m_model->setIdleTimeout( m_node, value );
+    if (m_recordModify)
+      emit modifiedProject();
+  }
+}
+
+
+void ScriptConf::assignCached(bool checked) // SLOT
+{
+  m_inputsLine->setEnabled(checked);
+  if (m_node)
+  {
+    m_model->setCached( m_node, checked );
+    if (m_recordModify)
+      emit modifiedProject();
+  }
+}
+
+
+void ScriptConf::assignInputs() // SLOT
+{
+  if (!m_node)
+    return;
+
+  QStringList files;
+  QStringList list = m_inputsLine->text().split(',', QString::SkipEmptyParts);
+  for (int i = 0; i < list.size(); i++)
+  {
+    if (!list.at(i).trimmed().isEmpty())
+      files << list.at(i).trimmed();
+  }
+
+  if (m_model->inputs(m_node) == files)
+    return;
+
+  m_model->setInputs(m_node, files);
+  emit modifiedProject();
+}
+
+
 void ScriptConf::assignEnvironment( QTreeWidgetItem* item, int column ) // SLOT
 {
-  m_item->changeEnvironmentItem(item, column, item->text(column));
+  if (!m_node)
+    return;
+
+  if (column == 0)
+  {
+    // the same variable cannot be defined twice: the line gets back its previous name,
+    //  the item is not deleted while the tree is still reporting its change
+    for (int i = 0; i < m_confEnv->topLevelItemCount(); i++)
+    {
+      if ((m_confEnv->topLevelItem(i) != item) && (m_confEnv->topLevelItem(i)->text(0) == item->text(0)))
+      {
+        // the model has the lines in the same order
+        int row = m_confEnv->indexOfTopLevelItem(item);
+        QList< QPair<QString, QString> > environment = m_model->environment(m_node);
+        m_confEnv->blockSignals(true);
+        item->setText(0, (row < environment.size()) ? environment.at(row).first : QString());
+        m_confEnv->blockSignals(false);
+        return;
+      }
+    }
+  }
+
+  storeEnvironment();
 }
 
 
 void ScriptConf::assignParams() // SLOT
 {
-  m_item->setParameters(m_paramsLine->text().trimmed());
+  if (!m_node)
+    return;
+
+  m_model->setParameters(m_node, m_paramsLine->text().trimmed());
+  emit modifiedProject();
+}
+
+
+void ScriptConf::assignScriptId() // SLOT
+{
+  QString id = m_idLine->text().trimmed();
+  if (!m_node || (m_model->scriptId(m_node) == id))
+    return;
+
+  m_model->setScriptId(m_node, id);
+  emit modifiedProject();
+}
+
+
+void ScriptConf::assignDependencies() // SLOT
+{
+  if (!m_node)
+    return;
+
+  QStringList ids;
+  QStringList list = m_afterLine->text().split(',', QString::SkipEmptyParts);
+  for (int i = 0; i < list.size(); i++)
+  {
+    if (!list.at(i).trimmed().isEmpty())
+      ids << list.at(i).trimmed();
+  }
+
+  if (m_model->dependencies(m_node) == ids)
+    return;
+
+  m_model->setDependencies(m_node, ids);
   emit modifiedProject();
 }
 
 
 void ScriptConf::addEnvironmentVariable() // SLOT
 {
+  if (!m_node)
+    return;
+
   QStringList list;
   list << tr("name") << tr("value");
   QTreeWidgetItem* item = new QTreeWidgetItem(list);
   item->setFlags( Qt::ItemIsEditable | Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+  m_confEnv->blockSignals(true);
   m_confEnv->addTopLevelItem(item);
+  m_confEnv->blockSignals(false);
   m_confEnv->editItem(item);
 
-  m_item->addEnvironmentItem(item, item->text(0), item->text(1));
+  storeEnvironment();
 
   // the project need to be saved again after this modify
   emit modifiedProject();
@@ -229,25 +499,13 @@ void ScriptConf::addEnvironmentVariable() // SLOT
 
 void ScriptConf::removeEnvironmentVariable() // SLOT
 {
-  // delete the selected environmente variable
-  m_item->deleteEnvironmentItem( m_confEnv->selectedItems().at(0) );
+  if (!m_node || m_confEnv->selectedItems().isEmpty())
+    return;
 
-  // delete item from the QTreeWidget
+  // delete item from the QTreeWidget and then the selected environmente variable
   delete m_confEnv->selectedItems().at(0);
+  storeEnvironment();
 
   // the project need to be saved again after this modify
   emit modifiedProject();
 }
-
-
-void ScriptConf::StoreEnvironment(TreeWidgetItem* item) // SLOT
-{
-  QMapIterator<QTreeWidgetItem*, QPair<QString, QString> > iterator(item->environment());
-  while (iterator.hasNext())
-  {
-    iterator.next();
-
-    // prepare the environment
-    m_confEnv->addTopLevelItem(iterator.key());
-  }
-}
@@ -23,17 +23,24 @@
 #include <QtWidgets/QGroupBox>
 
 class QSpinBox;
+class QCheckBox;
 class QLineEdit;
+class QLabel;
 class QTreeWidget;
 class QTreeWidgetItem;
-class TreeWidgetItem;
+class ScriptModel;
 class TextEditMonitor;
 
 /**
  * This class is the QGroupBox that contains the widgets that is needed to configure the single items:
  *   - the number of times a script has to be executed
+ *   - the benchmark mode and its warmup runs
+ *   - the time an execution can take and the time it can be without output
+ *   - the result cache and the files the script reads
+ *   - the parameter sweep defined in the project file, just shown
  *   - the environment (variable name + its value) inside the script has to be executed
  *   - the input parameters line the script will use
+ *   - the scripts that have to end correctly before this one
  *
  * This widget is shown when you click on a file in the Script Tree
  *
@@ -57,37 +64,49 @@ class ScriptConf : public QGroupBox
     ~ScriptConf();
 
     /**
-     * Set the related item to configure
+     * Set the Script Model that keeps the scripts to configure
      *
-     * @param item is the TreeWidgetItem reference
+     * @param model is the Script Model reference
      */
-    void setItem(TreeWidgetItem *item);
+    void setModel(ScriptModel *model);
 
     /**
-     * Set the related tree widget item to the monitor view into configuration
+     * Set the related script to configure
      *
-     * @param item is the TreeWidgetItem reference
+     * @param node is the Script Model node of the script
+     */
+    void setItem(int node);
+
+    /**
+     * Set the related script to the monitor view into configuration
+     *
+     * @param node is the Script Model node of the script
      * @param box is the TextEditMonitor reference
      */
-    void setMonitorView(TreeWidgetItem *item, TextEditMonitor *box);
+    void setMonitorView(int node, TextEditMonitor *box);
 
   private:
     /**
-     * Set the Environment for the script. The QtreeWidgetItem lines of the "Environment" has to exixts.
-     * This member just hide all the lines and show the ones related to @p item
-     *
-     * @param confEnv is the QTreeWidget containing:
-     *   - the variable name
-     *   - the variable value
-     * @param item is the related TreeWidgetItem reference
+     * Set the Environment for the script: the lines of the "Environment" are
+     * created again from the variables of the script
      */
-    void setEnvironment(QTreeWidget *confEnv, TreeWidgetItem *item);
+    void setEnvironment();
+
+    /**
+     * Store into the Script Model the environment shown by the lines of the "Environment"
+     */
+    void storeEnvironment();
 
   private:
     /**
-     * The TreeWidgetItem on which you can operate the configuration
+     * The Script Model that keeps the scripts
+     */
+    ScriptModel *m_model;
+
+    /**
+     * The Script Model node on which you can operate the configuration
      */
-    TreeWidgetItem *m_item;
+    int m_node;
 
     /**
      * Contains the number of time a script has to be executed
@@ -99,6 +118,41 @@ class ScriptConf : public QGroupBox
      */
     QSpinBox *m_delay;
 
+    /**
+     * Checked if the script is executed in benchmark mode
+     */
+    QCheckBox *m_benchmark;
+
+    /**
+     * Contains the number of runs executed, in benchmark mode, before the measured ones
+     */
+    QSpinBox *m_warmup;
+
+    /**
+     * Contains the number of seconds an execution can take
+     */
+    QSpinBox *m_timeout;
+
+    /**
+     * Contains the number of seconds the script can run without output
+     */
+    QSpinBox *m_idleTimeout;
+
+    /**
+     * Checked if the results of the script are taken from the cache when possible
+     */
+    QCheckBox *m_cached;
+
+    /**
+     * Contains the files the script reads, separated by commas
+     */
+    QLineEdit* m_inputsLine;
+
+    /**
+     * Shows the points of the parameter sweep, hidden if there is none
+     */
+    QLabel *m_sweepLabel;
+
     /**
      * Contains the environment (name + value)
      */
@@ -109,6 +163,16 @@ class ScriptConf : public QGroupBox
      */
     QLineEdit* m_paramsLine;
 
+    /**
+     * Contains the script identifier
+     */
+    QLineEdit* m_idLine;
+
+    /**
+     * Contains the identifiers of the scripts that have to end correctly before this one
+     */
+    QLineEdit* m_afterLine;
+
     /**
      * Record each modification to the script properties/environment
      */
@@ -138,6 +202,46 @@ class ScriptConf : public QGroupBox
      */
     void assignDelayTime(int value);
 
+    /**
+     * Assign the benchmark mode
+     *
+     * @param checked is true if the script has to be executed in benchmark mode
+     */
+    void assignBenchmark(bool checked);
+
+    /**
+     * Assign the number of runs executed, in benchmark mode, before the measured ones
+     *
+     * @param value is the number of warmup runs
+     */
+    void assignWarmup(int value);
+
+    /**
+     * Assign the number of seconds an execution of the script can take
+     *
+     * @param value is the timeout, 0 for no limit
+     */
+    void assignTimeout(int value);
+
+    /**
+     * Assign the number of seconds the script can run without output
+     *
+     * @param value is the timeout, 0 for no limit
+     */
+    void assignIdleTimeout(int value);
+
+    /**
+     * Assign the result cache use
+     *
+     * @param checked is true if the results are taken from the cache when the inputs did not change
+     */
+    void assignCached(bool checked);
+
+    /**
+     * Assign the files the script reads
+     */
+    void assignInputs();
+
     /**
      * Assign the environment:
      *  - name if @p column is 0
@@ -153,6 +257,16 @@ class ScriptConf : public QGroupBox
      */
     void assignParams();
 
+    /**
+     * Assign the script identifier
+     */
+    void assignScriptId();
+
+    /**
+     * Assign the scripts that have to end correctly before this one
+     */
+    void assignDependencies();
+
     /**
      * Add the Environment line that user has to modify
      */
@@ -162,13 +276,6 @@ class ScriptConf : public QGroupBox
      * Remove the selected Environment line
      */
     void removeEnvironmentVariable();
-
-    /**
-     * Create the environment got from the @p item environment
-     *
-     * @param item the TreeWidgetItem reference containing the enviroment to add to the ScriptConf widget
-     */
-    void StoreEnvironment(TreeWidgetItem* item);
 };
 
 #endif
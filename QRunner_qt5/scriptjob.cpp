@@ -0,0 +1,282 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include "scriptjob.h"
+
+ScriptJob::ScriptJob()
+{
+  m_times = 1;
+  m_delay = 0;
+  m_benchmark = false;
+  m_warmup = 0;
+  m_timeout = 0;
+  m_idleTimeout = 0;
+  m_cached = false;
+  m_taskId = -1;
+  m_taskCount = 0;
+  m_estimate = 0;
+}
+
+
+void ScriptJob::setName(const QString& name)
+{
+  m_name = name;
+}
+
+
+QString ScriptJob::name() const
+{
+  return m_name;
+}
+
+
+void ScriptJob::setParameters(const QString& params)
+{
+  m_parameters = params;
+}
+
+
+QString ScriptJob::parameters() const
+{
+  return m_parameters;
+}
+
+
+void ScriptJob::setTimes(int times)
+{
+  m_times = times;
+}
+
+
+int ScriptJob::times() const
+{
+  return m_times;
+}
+
+
+void ScriptJob::setDelay(int delay)
+{
+  m_delay = delay;
+}
+
+
+int ScriptJob::delay() const
+{
+  return m_delay;
+}
+
+
+void ScriptJob::setBenchmark(bool benchmark)
+{
+  m_benchmark = benchmark;
+}
+
+
+bool ScriptJob::benchmark() const
+{
+  return m_benchmark;
+}
+
+
+void ScriptJob::setWarmup(int warmup)
+{
+  m_warmup = warmup;
+}
+
+
+int ScriptJob::warmup() const
+{
+  return m_warmup;
+}
+
+
+void ScriptJob::setTimeout(int seconds)
+{
+  m_timeout = seconds;
+}
+
+
+int ScriptJob::timeout() const
+{
+  return m_timeout;
+}
+
+
+void ScriptJob::setIdleTimeout(int seconds)
+{
+  m_idleTimeout = seconds;
+}
+
+
+int ScriptJob::idleTimeout() const
+{
+  return m_idleTimeout;
+}
+
+
+void ScriptJob::setCached(bool cached)
+{
+  m_cached = cached;
+}
+
+
+bool ScriptJob::cached() const
+{
+  return m_cached;
+}
+
+
+void ScriptJob::setInputs(const QStringList& files)
+{
+  m_inputs = files;
+}
+
+
+QStringList ScriptJob::inputs() const
+{
+  return m_inputs;
+}
+
+
+void ScriptJob::addEnvironment(const QString& name, const QString& value)
+{
+  m_environment.append(qMakePair(name, value));
+}
+
+
+QList<QPair<QString, QString> > ScriptJob::environment() const
+{
+  return m_environment;
+}
+
+
+void ScriptJob::setId(const QString& id)
+{
+  m_id = id;
+}
+
+
+QString ScriptJob::id() const
+{
+  return m_id;
+}
+
+
+void ScriptJob::setDependencies(const QStringList& ids)
+{
+  m_dependencies = ids;
+}
+
+
+QStringList ScriptJob::dependencies() const
+{
+  return m_dependencies;
+}
+
+
+void ScriptJob::setEstimate(qint64 msecs)
+{
+  m_estimate = msecs;
+}
+
+
+qint64 ScriptJob::estimate() const
+{
+  return m_estimate;
+}
+
+
+void ScriptJob::setLogPath(const QStringList& groups)
+{
+  m_logPath = groups;
+}
+
+
+QStringList ScriptJob::logPath() const
+{
+  return m_logPath;
+}
+
+
+void ScriptJob::setSweep(const Sweep& sweep)
+{
+  m_sweep = sweep;
+}
+
+
+Sweep ScriptJob::sweep() const
+{
+  return m_sweep;
+}
+
+
+QList<ScriptJob> ScriptJob::expandSweep() const
+{
+  QList<ScriptJob> jobs;
+  int count = m_sweep.count();
+  for (int i = 0; i < count; i++)
+  {
+    ScriptJob job(*this);
+    job.m_sweep = Sweep();
+    job.m_taskId = i;
+    job.m_taskCount = count;
+    job.m_taskLabel = m_sweep.label(i);
+
+    QStringList values = m_sweep.point(i);
+    for (int axis = 0; axis < values.size(); axis++)
+    {
+      QString name = m_sweep.axisName(axis);
+      if (name.isEmpty())
+      {
+        job.m_parameters = (job.m_parameters + " " + values.at(axis)).trimmed();
+        continue;
+      }
+
+      // the value of the point replaces the one of the script
+      for (int j = job.m_environment.size() - 1; j >= 0; j--)
+      {
+        if (job.m_environment.at(j).first == name)
+          job.m_environment.removeAt(j);
+      }
+      job.addEnvironment(name, values.at(axis));
+    }
+    job.addEnvironment("QRUNNER_TASK_ID", QString::number(i));
+    job.addEnvironment("QRUNNER_TASK_COUNT", QString::number(count));
+    jobs.append(job);
+  }
+  return jobs;
+}
+
+
+int ScriptJob::taskId() const
+{
+  return m_taskId;
+}
+
+
+int ScriptJob::taskCount() const
+{
+  return m_taskCount;
+}
+
+
+QString ScriptJob::taskLabel() const
+{
+  return m_taskLabel;
+}
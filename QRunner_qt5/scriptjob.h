@@ -0,0 +1,343 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef SCRIPTJOB_H
+#define SCRIPTJOB_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+
+#include "sweep.h"
+
+/**
+ * This class describes a script to execute: what to run and how. It doesn't
+ * depend on the GUI so the same description is used by the project tree and
+ * by the command line runner
+ *
+ * @author Giovanni Venturi
+ */
+class ScriptJob
+{
+  public:
+    /**
+     * Create an empty job: the script is executed one time without delay
+     */
+    ScriptJob();
+
+    /**
+     * Assign the absolute file path of the script
+     */
+    void setName(const QString& name);
+
+    /**
+     * @returns the absolute file path of the script
+     */
+    QString name() const;
+
+    /**
+     * Assign the input parameters line
+     */
+    void setParameters(const QString& params);
+
+    /**
+     * @returns the input parameters line
+     */
+    QString parameters() const;
+
+    /**
+     * Assign the number of times the script has to be executed
+     */
+    void setTimes(int times);
+
+    /**
+     * @returns the number of times the script has to be executed
+     */
+    int times() const;
+
+    /**
+     * Assign the number of seconds to wait before to run the script again
+     */
+    void setDelay(int delay);
+
+    /**
+     * @returns the number of seconds to wait before to run the script again
+     */
+    int delay() const;
+
+    /**
+     * Assign the benchmark mode: the times of the runs are collected in statistics
+     * (see \ref Benchmark) and the first runs are not measured (see \ref setWarmup())
+     */
+    void setBenchmark(bool benchmark);
+
+    /**
+     * @returns true if the script is executed in benchmark mode
+     */
+    bool benchmark() const;
+
+    /**
+     * Assign the number of runs executed, in benchmark mode, before the measured ones
+     */
+    void setWarmup(int warmup);
+
+    /**
+     * @returns the number of runs executed, in benchmark mode, before the measured ones
+     */
+    int warmup() const;
+
+    /**
+     * Assign the longest time an execution of the script can take
+     *
+     * @param seconds is the timeout, 0 means no limit
+     */
+    void setTimeout(int seconds);
+
+    /**
+     * @returns the longest time in seconds an execution can take, 0 if there is no limit
+     */
+    int timeout() const;
+
+    /**
+     * Assign the longest time the script can run without writing on its standard
+     * output or error channel
+     *
+     * @param seconds is the timeout, 0 means no limit
+     */
+    void setIdleTimeout(int seconds);
+
+    /**
+     * @returns the longest time in seconds the script can run without output, 0 if there is no limit
+     */
+    int idleTimeout() const;
+
+    /**
+     * Assign the result cache use: an execution whose inputs did not change is not
+     * repeated, its log and exit code are restored (see \ref ResultCache)
+     */
+    void setCached(bool cached);
+
+    /**
+     * @returns true if the results of the script are taken from the cache when possible
+     */
+    bool cached() const;
+
+    /**
+     * Assign the files the script reads: they are part of the inputs of a cached script
+     *
+     * @param files are the file paths, relative to the script directory or absolute
+     */
+    void setInputs(const QStringList& files);
+
+    /**
+     * @returns the files the script reads, as they were assigned
+     */
+    QStringList inputs() const;
+
+    /**
+     * Add an environment variable for the script
+     *
+     * @param name is the environment variable name
+     * @param value is the environment variable value
+     */
+    void addEnvironment(const QString& name, const QString& value);
+
+    /**
+     * @returns the environment variables of the script: name and value
+     */
+    QList<QPair<QString, QString> > environment() const;
+
+    /**
+     * Assign the identifier other scripts use to run after this one
+     */
+    void setId(const QString& id);
+
+    /**
+     * @returns the identifier of the script
+     */
+    QString id() const;
+
+    /**
+     * Assign the identifiers of the scripts that have to end correctly before this one
+     */
+    void setDependencies(const QStringList& ids);
+
+    /**
+     * @returns the identifiers of the scripts that have to end correctly before this one
+     */
+    QStringList dependencies() const;
+
+    /**
+     * Assign the expected execution time in milliseconds
+     */
+    void setEstimate(qint64 msecs);
+
+    /**
+     * @returns the expected execution time in milliseconds, 0 if unknown
+     */
+    qint64 estimate() const;
+
+    /**
+     * Assign the groups the script belongs to: the log file is written in the
+     * same directories tree under the log base directory
+     *
+     * @param groups is the list of the group names from the top level one
+     */
+    void setLogPath(const QStringList& groups);
+
+    /**
+     * @returns the groups the script belongs to, from the top level one
+     */
+    QStringList logPath() const;
+
+    /**
+     * Assign the parameter sweep: the script is executed once for each point
+     * (see \ref expandSweep())
+     */
+    void setSweep(const Sweep& sweep);
+
+    /**
+     * @returns the parameter sweep, empty if the script is executed just once
+     */
+    Sweep sweep() const;
+
+    /**
+     * Create a job for each point of the sweep. The values of the point are
+     * appended to the parameters line or set in the environment, and the
+     * QRUNNER_TASK_ID (from 0) and QRUNNER_TASK_COUNT variables tell the script
+     * which point it is
+     *
+     * @returns the jobs of the points, empty if the sweep has no point
+     */
+    QList<ScriptJob> expandSweep() const;
+
+    /**
+     * @returns the point number in the sweep of the script, -1 if it's not a sweep point
+     */
+    int taskId() const;
+
+    /**
+     * @returns the number of points of the sweep the script belongs to
+     */
+    int taskCount() const;
+
+    /**
+     * @returns the values of the sweep point in a readable form, empty if it's not a sweep point
+     */
+    QString taskLabel() const;
+
+  private:
+    /**
+     * The absolute file path of the script
+     */
+    QString m_name;
+
+    /**
+     * The input parameters line
+     */
+    QString m_parameters;
+
+    /**
+     * The number of times the script has to be executed
+     */
+    int m_times;
+
+    /**
+     * The number of seconds to wait before to run the script again
+     */
+    int m_delay;
+
+    /**
+     * true if the script is executed in benchmark mode
+     */
+    bool m_benchmark;
+
+    /**
+     * The number of runs, in benchmark mode, before the measured ones
+     */
+    int m_warmup;
+
+    /**
+     * The longest time in seconds an execution can take, 0 for no limit
+     */
+    int m_timeout;
+
+    /**
+     * The longest time in seconds the script can run without output, 0 for no limit
+     */
+    int m_idleTimeout;
+
+    /**
+     * true if the results are taken from the cache when the inputs did not change
+     */
+    bool m_cached;
+
+    /**
+     * The files the script reads
+     */
+    QStringList m_inputs;
+
+    /**
+     * The environment variables: name and value
+     */
+    QList<QPair<QString, QString> > m_environment;
+
+    /**
+     * The script identifier
+     */
+    QString m_id;
+
+    /**
+     * The identifiers of the scripts that have to end correctly before this one
+     */
+    QStringList m_dependencies;
+
+    /**
+     * The expected execution time in milliseconds
+     */
+    qint64 m_estimate;
+
+    /**
+     * The groups the script belongs to
+     */
+    QStringList m_logPath;
+
+    /**
+     * The parameter sweep
+     */
+    Sweep m_sweep;
+
+    /**
+     * The point number in the sweep, -1 if it's not a sweep point
+     */
+    int m_taskId;
+
+    /**
+     * The number of points of the sweep
+     */
+    int m_taskCount;
+
+    /**
+     * The values of the sweep point
+     */
+    QString m_taskLabel;
+};
+
+#endif
@@ -0,0 +1,637 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtWidgets/QFileIconProvider>
+#include <QtGui/QBrush>
+#include <QtCore/QFileInfo>
+
+#include "scriptmodel.h"
+
+/**
+ * The color of the script name for each execution state
+ */
+static const char *StateColors[] = { "#000000", "#DC8600", "#008000", "#FF0000", "#808080", "#8000C0", "#0070C0" };
+
+ScriptModel::ScriptModel(QObject *parent)
+  : QAbstractItemModel(parent)
+{
+  m_loading = false;
+
+  QFileIconProvider pix;
+  m_groupIcon = pix.icon(QFileIconProvider::Folder);
+  m_fileIcon = QIcon(":/images/new.png");
+
+  // the root contains the top level groups
+  m_nodes.append(Node());
+}
+
+
+void ScriptModel::clear()
+{
+  beginResetModel();
+  m_nodes.clear();
+  m_nodes.append(Node());
+  endResetModel();
+}
+
+
+void ScriptModel::beginLoad()
+{
+  beginResetModel();
+  m_loading = true;
+}
+
+
+void ScriptModel::endLoad()
+{
+  m_loading = false;
+  endResetModel();
+}
+
+
+int ScriptModel::addGroup(int parent, const QString& name, bool checked)
+{
+  Node group;
+  group.type = Group;
+  group.name = name;
+  group.checked = checked;
+
+  // the items of a group run at the same time
+  group.executionMode = "parallel";
+
+  return appendNode(parent, group);
+}
+
+
+int ScriptModel::addFile(int parent, const QString& absoluteFilePath, bool checked)
+{
+  Node file;
+  file.type = File;
+  file.name = QFileInfo(absoluteFilePath).fileName();
+  file.absoluteFilePath = absoluteFilePath;
+  file.checked = checked;
+
+  // the default values used when the file is dropped from the file system tree view
+  file.times = 1;
+  file.delay = 0;
+
+  return appendNode(parent, file);
+}
+
+
+void ScriptModel::removeNode(int node)
+{
+  if ((node == Root) || (m_nodes.at(node).parent < 0))
+    // the root cannot be removed
+    return;
+
+  int parent = m_nodes.at(node).parent;
+  int row = m_nodes.at(node).row;
+  beginRemoveRows(indexOf(parent), row, row);
+
+  // the next nodes of the group move up
+  QVector<int>& children = m_nodes[parent].children;
+  children.remove(row);
+  for (int i = row; i < children.size(); i++)
+    m_nodes[children.at(i)].row = i;
+
+  releaseNode(node);
+  endRemoveRows();
+}
+
+
+bool ScriptModel::moveNode(int node, int parent)
+{
+  if ((node == Root) || (m_nodes.at(node).parent < 0) || !isGroup(parent))
+    return false;
+
+  // a group cannot be moved inside itself
+  for (int group = parent; group >= 0; group = m_nodes.at(group).parent)
+  {
+    if (group == node)
+      return false;
+  }
+
+  int from = m_nodes.at(node).parent;
+  int row = m_nodes.at(node).row;
+  if (from == parent)
+    // already there
+    return true;
+
+  int to = m_nodes.at(parent).children.size();
+  if (!beginMoveRows(indexOf(from), row, row, indexOf(parent), to))
+    return false;
+
+  QVector<int>& children = m_nodes[from].children;
+  children.remove(row);
+  for (int i = row; i < children.size(); i++)
+    m_nodes[children.at(i)].row = i;
+
+  m_nodes[parent].children.append(node);
+  m_nodes[node].parent = parent;
+  m_nodes[node].row = to;
+
+  endMoveRows();
+  return true;
+}
+
+
+int ScriptModel::node(const QModelIndex& index) const
+{
+  return index.isValid() ? (int)index.internalId() : (int)Root;
+}
+
+
+QModelIndex ScriptModel::indexOf(int node) const
+{
+  if ((node <= Root) || (node >= m_nodes.size()) || (m_nodes.at(node).parent < 0))
+    // the root and the removed nodes are not shown
+    return QModelIndex();
+
+  return createIndex(m_nodes.at(node).row, 0, quintptr(node));
+}
+
+
+int ScriptModel::parentNode(int node) const
+{
+  return m_nodes.at(node).parent;
+}
+
+
+int ScriptModel::childCount(int node) const
+{
+  return m_nodes.at(node).children.size();
+}
+
+
+int ScriptModel::child(int node, int row) const
+{
+  return m_nodes.at(node).children.at(row);
+}
+
+
+bool ScriptModel::isGroup(int node) const
+{
+  return (m_nodes.at(node).type == Group);
+}
+
+
+bool ScriptModel::isFile(int node) const
+{
+  return (m_nodes.at(node).type == File);
+}
+
+
+QString ScriptModel::name(int node) const
+{
+  return m_nodes.at(node).name;
+}
+
+
+void ScriptModel::setName(int node, const QString& name)
+{
+  m_nodes[node].name = name;
+  nodeChanged(node);
+}
+
+
+QString ScriptModel::assignedName(int node) const
+{
+  return isFile(node) ? m_nodes.at(node).absoluteFilePath : m_nodes.at(node).name;
+}
+
+
+void ScriptModel::setFileName(int node, const QString& name)
+{
+  m_nodes[node].name = name;
+  nodeChanged(node);
+}
+
+
+QString ScriptModel::fileName(int node) const
+{
+  return m_nodes.at(node).name;
+}
+
+
+QString ScriptModel::filePath(int node) const
+{
+  return QFileInfo(m_nodes.at(node).absoluteFilePath).path();
+}
+
+
+void ScriptModel::setChecked(int node, bool checked)
+{
+  m_nodes[node].checked = checked;
+  nodeChanged(node);
+}
+
+
+bool ScriptModel::checked(int node) const
+{
+  return m_nodes.at(node).checked;
+}
+
+
+void ScriptModel::setTimes(int node, int times)
+{
+  m_nodes[node].times = times;
+}
+
+
+int ScriptModel::times(int node) const
+{
+  return m_nodes.at(node).times;
+}
+
+
+void ScriptModel::setDelay(int node, int delay)
+{
+  m_nodes[node].delay = delay;
+}
+
+
+int ScriptModel::delay(int node) const
+{
+  return m_nodes.at(node).delay;
+}
+
+
+void ScriptModel::setBenchmark(int node, bool benchmark)
+{
+  m_nodes[node].benchmark = benchmark;
+}
+
+
+bool ScriptModel::benchmark(int node) const
+{
+  return m_nodes.at(node).benchmark;
+}
+
+
+void ScriptModel::setWarmup(int node, int warmup)
+{
+  m_nodes[node].warmup = warmup;
+}
+
+
+int ScriptModel::warmup(int node) const
+{
+  return m_nodes.at(node).warmup;
+}
+
+
+void ScriptModel::setCached(int node, bool cached)
+{
+  m_nodes[node].cached = cached;
+}
+
+
+bool ScriptModel::cached(int node) const
+{
+  return m_nodes.at(node).cached;
+}
+
+
+void ScriptModel::setInputs(int node, const QStringList& files)
+{
+  m_nodes[node].inputs = files;
+}
+
+
+QStringList ScriptModel::inputs(int node) const
+{
+  return m_nodes.at(node).inputs;
+}
+
+
+void ScriptModel::setSweep(int node, const Sweep& sweep)
+{
+  m_nodes[node].sweep = sweep;
+}
+
+
+Sweep ScriptModel::sweep(int node) const
+{
+  return m_nodes.at(node).sweep;
+}
+
+
+void ScriptModel::setTimeout(int node, int seconds)
+{
+  m_nodes[node].timeout = seconds;
+}
+
+
+int ScriptModel::timeout(int node) const
+{
+  return m_nodes.at(node).timeout;
+}
+
+
+void ScriptModel::setIdleTimeout(int node, int seconds)
+{
+  m_nodes[node].idleTimeout = seconds;
+}
+
+
+int ScriptModel::idleTimeout(int node) const
+{
+  return m_nodes.at(node).idleTimeout;
+}
+
+
+void ScriptModel::setParameters(int node, const QString& params)
+{
+  m_nodes[node].parameters = params;
+}
+
+
+QString ScriptModel::parameters(int node) const
+{
+  return m_nodes.at(node).parameters;
+}
+
+
+void ScriptModel::setScriptId(int node, const QString& id)
+{
+  m_nodes[node].scriptId = id;
+}
+
+
+QString ScriptModel::scriptId(int node) const
+{
+  return m_nodes.at(node).scriptId;
+}
+
+
+void ScriptModel::setDependencies(int node, const QStringList& ids)
+{
+  m_nodes[node].dependencies = ids;
+}
+
+
+QStringList ScriptModel::dependencies(int node) const
+{
+  return m_nodes.at(node).dependencies;
+}
+
+
+void ScriptModel::setEstimate(int node, qint64 msecs)
+{
+  m_nodes[node].estimate = msecs;
+}
+
+
+qint64 ScriptModel::estimate(int node) const
+{
+  return m_nodes.at(node).estimate;
+}
+
+
+void ScriptModel::setExecutionMode(int node, const QString& mode)
+{
+  m_nodes[node].executionMode = mode;
+}
+
+
+QString ScriptModel::executionMode(int node) const
+{
+  return m_nodes.at(node).executionMode;
+}
+
+
+void ScriptModel::setEnvironment(int node, const QList< QPair<QString, QString> >& environment)
+{
+  m_nodes[node].environment = environment;
+}
+
+
+QList< QPair<QString, QString> > ScriptModel::environment(int node) const
+{
+  return m_nodes.at(node).environment;
+}
+
+
+void ScriptModel::setTextEditMonitor(int node, TextEditMonitor *box)
+{
+  m_nodes[node].monitor = box;
+}
+
+
+TextEditMonitor *ScriptModel::textEditMonitor(int node) const
+{
+  return m_nodes.at(node).monitor;
+}
+
+
+void ScriptModel::setState(int node, State state)
+{
+  m_nodes[node].state = state;
+  if ((state == Succeeded) || (state == Failed) || (state == TimedOut))
+    // now the log file can be opened
+    m_nodes[node].executed = true;
+  nodeChanged(node);
+}
+
+
+ScriptModel::State ScriptModel::state(int node) const
+{
+  return (State)m_nodes.at(node).state;
+}
+
+
+bool ScriptModel::running(int node) const
+{
+  // a paused script is still running: it can be resumed or stopped
+  return (m_nodes.at(node).state == Running) || (m_nodes.at(node).state == Paused);
+}
+
+
+bool ScriptModel::executed(int node) const
+{
+  return m_nodes.at(node).executed;
+}
+
+
+void ScriptModel::resetStates()
+{
+  for (int i = 0; i < m_nodes.size(); i++)
+    m_nodes[i].state = Idle;
+
+  if (m_loading)
+    return;
+
+  // one notification for each group
+  for (int i = 0; i < m_nodes.size(); i++)
+  {
+    const QVector<int>& children = m_nodes.at(i).children;
+    if (!children.isEmpty())
+      emit dataChanged(indexOf(children.first()), indexOf(children.last()));
+  }
+}
+
+
+QModelIndex ScriptModel::index(int row, int column, const QModelIndex& parent) const
+{
+  const QVector<int>& children = m_nodes.at(node(parent)).children;
+  if ((column != 0) || (row < 0) || (row >= children.size()))
+    return QModelIndex();
+
+  return createIndex(row, 0, quintptr(children.at(row)));
+}
+
+
+QModelIndex ScriptModel::parent(const QModelIndex& index) const
+{
+  if (!index.isValid())
+    return QModelIndex();
+
+  return indexOf(m_nodes.at(node(index)).parent);
+}
+
+
+int ScriptModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.column() > 0)
+    return 0;
+
+  return m_nodes.at(node(parent)).children.size();
+}
+
+
+int ScriptModel::columnCount(const QModelIndex& parent) const
+{
+  Q_UNUSED(parent);
+  return 1;
+}
+
+
+QVariant ScriptModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid())
+    return QVariant();
+
+  const Node& item = m_nodes.at(node(index));
+  switch (role)
+  {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+      return item.name;
+
+    case Qt::ToolTipRole:
+      if (item.type == File)
+        return item.absoluteFilePath;
+      break;
+
+    case Qt::DecorationRole:
+      return (item.type == Group) ? m_groupIcon : m_fileIcon;
+
+    case Qt::CheckStateRole:
+      return int(item.checked ? Qt::Checked : Qt::Unchecked);
+
+    case Qt::ForegroundRole:
+      return QBrush(QColor(StateColors[item.state]));
+  }
+
+  return QVariant();
+}
+
+
+bool ScriptModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+  if (!index.isValid())
+    return false;
+
+  int item = node(index);
+  if (role == Qt::CheckStateRole)
+  {
+    bool checked = (value.toInt() == Qt::Checked);
+    if (checked != m_nodes.at(item).checked)
+    {
+      setChecked(item, checked);
+      emit modified();
+    }
+    return true;
+  }
+
+  if ((role == Qt::EditRole) && isGroup(item))
+  {
+    // the scripts keep their file name
+    if (value.toString() != m_nodes.at(item).name)
+    {
+      setName(item, value.toString());
+      emit modified();
+    }
+    return true;
+  }
+
+  return false;
+}
+
+
+Qt::ItemFlags ScriptModel::flags(const QModelIndex& index) const
+{
+  if (!index.isValid())
+    return Qt::NoItemFlags;
+
+  // the groups can be renamed
+  if (isGroup(node(index)))
+    return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsUserCheckable | Qt::ItemIsEnabled;
+  return Qt::ItemIsSelectable | Qt::ItemIsUserCheckable | Qt::ItemIsEnabled;
+}
+
+
+int ScriptModel::appendNode(int parent, Node& node)
+{
+  int index = m_nodes.size();
+  node.parent = parent;
+  node.row = m_nodes.at(parent).children.size();
+
+  if (!m_loading)
+    beginInsertRows(indexOf(parent), node.row, node.row);
+  m_nodes.append(node);
+  m_nodes[parent].children.append(index);
+  if (!m_loading)
+    endInsertRows();
+
+  return index;
+}
+
+
+void ScriptModel::releaseNode(int node)
+{
+  QVector<int> children = m_nodes.at(node).children;
+  for (int i = 0; i < children.size(); i++)
+    releaseNode(children.at(i));
+
+  // the index is not reused: just free the node data
+  m_nodes[node] = Node();
+}
+
+
+void ScriptModel::nodeChanged(int node)
+{
+  if (m_loading || (node == Root))
+    return;
+
+  QModelIndex index = indexOf(node);
+  if (index.isValid())
+    emit dataChanged(index, index);
+}
@@ -0,0 +1,616 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef SCRIPTMODEL_H
+#define SCRIPTMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QVector>
+#include <QtCore/QStringList>
+#include <QtCore/QPair>
+
+#include <QtGui/QIcon>
+
+#include "sweep.h"
+
+class TextEditMonitor;
+
+/**
+ * This class keeps the groups and the scripts of a project. They are nodes
+ * stored one after the other in a single array and they refer to each other
+ * by their index: the parent of each node and its children. The Script Tree
+ * is just a view on this model, so the project data doesn't depend on the
+ * widgets that show it.
+ *
+ * A node index doesn't change while the node is in the model and it's not
+ * reused when the node is removed, until the model is cleared. The index
+ * \ref Root is the invisible node that contains the top level groups.
+ *
+ * @author Giovanni Venturi
+ */
+class ScriptModel : public QAbstractItemModel
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * The kind of node
+     */
+    enum Type
+    {
+      Group,
+      File
+    };
+
+    /**
+     * The execution state of a script, shown with the color of its name
+     */
+    enum State
+    {
+      Idle,
+      Running,
+      Succeeded,
+      Failed,
+      Skipped,
+      TimedOut,
+      Paused
+    };
+
+    /**
+     * The index of the invisible node that contains the top level groups
+     */
+    enum { Root = 0 };
+
+    /**
+     * Create an empty model
+     *
+     * @param parent is the parent object
+     */
+    ScriptModel(QObject *parent = 0);
+
+    /**
+     * Remove all the groups and scripts
+     */
+    void clear();
+
+    /**
+     * Stop notifying the views each node that is added: they are reset
+     * by \ref endLoad(). It's used while a project is read
+     */
+    void beginLoad();
+
+    /**
+     * Reset the views after \ref beginLoad()
+     */
+    void endLoad();
+
+    /**
+     * Add a group at the end of a group
+     *
+     * @param parent is the group where to add the new one, \ref Root for a top level group
+     * @param name is the group name
+     * @param checked is true if the group can be executed
+     *
+     * @returns the index of the new group
+     */
+    int addGroup(int parent, const QString& name, bool checked = true);
+
+    /**
+     * Add a script at the end of a group
+     *
+     * @param parent is the group where to add the script
+     * @param absoluteFilePath is the absolute file path of the script
+     * @param checked is true if the script can be executed
+     *
+     * @returns the index of the new script
+     */
+    int addFile(int parent, const QString& absoluteFilePath, bool checked = true);
+
+    /**
+     * Remove a node with all its children
+     *
+     * @param node is the node to remove
+     */
+    void removeNode(int node);
+
+    /**
+     * Move a node with all its children at the end of a group
+     *
+     * @param node is the node to move
+     * @param parent is the new group of the node
+     *
+     * @returns false if the node cannot be moved: a group cannot be moved inside itself
+     */
+    bool moveNode(int node, int parent);
+
+    /**
+     * @returns the node shown at the model index @p index, \ref Root for an invalid index
+     */
+    int node(const QModelIndex& index) const;
+
+    /**
+     * @returns the model index of the node, an invalid one for \ref Root
+     */
+    QModelIndex indexOf(int node) const;
+
+    /**
+     * @returns the group of the node, -1 for \ref Root
+     */
+    int parentNode(int node) const;
+
+    /**
+     * @returns the number of children of the node
+     */
+    int childCount(int node) const;
+
+    /**
+     * @returns the child of the node at the position @p row
+     */
+    int child(int node, int row) const;
+
+    /**
+     * @returns true if the node is a group (\ref Root is a group too)
+     */
+    bool isGroup(int node) const;
+
+    /**
+     * @returns true if the node is a script file
+     */
+    bool isFile(int node) const;
+
+    /**
+     * @returns the name shown: the group name or the script file name
+     */
+    QString name(int node) const;
+
+    /**
+     * Rename a group
+     *
+     * @param node is the group
+     * @param name is the new name
+     */
+    void setName(int node, const QString& name);
+
+    /**
+     * @returns the assigned complete name:
+     *   - Group Name if the node is a Group
+     *   - Absolute File Path if the node is a File
+     */
+    QString assignedName(int node) const;
+
+    /**
+     * Assign the file name saved in the project, it's also the name shown
+     *
+     * @param node is the script
+     * @param name is the file name
+     */
+    void setFileName(int node, const QString& name);
+
+    /**
+     * @returns file name without the path if the node is a File
+     */
+    QString fileName(int node) const;
+
+    /**
+     * @returns path of the file if the node is a File
+     */
+    QString filePath(int node) const;
+
+    /**
+     * Check or remove check on the node
+     *
+     * @param node is the group or the script
+     * @param checked is true if the File/Group will be executed
+     */
+    void setChecked(int node, bool checked);
+
+    /**
+     * @returns true if the node is checked: the File/Group will be executed
+     */
+    bool checked(int node) const;
+
+    /**
+     * Set the number of times the script has to be executed
+     */
+    void setTimes(int node, int times);
+
+    /**
+     * @returns the number of times to exec a script File
+     */
+    int times(int node) const;
+
+    /**
+     * Set the number of seconds the script has to be delayed before to run again
+     */
+    void setDelay(int node, int delay);
+
+    /**
+     * @returns seconds of time to delay before exec a script File again
+     */
+    int delay(int node) const;
+
+    /**
+     * Set the benchmark mode of the script: the times of its runs are collected in statistics
+     */
+    void setBenchmark(int node, bool benchmark);
+
+    /**
+     * @returns true if the script is executed in benchmark mode
+     */
+    bool benchmark(int node) const;
+
+    /**
+     * Set the number of runs executed, in benchmark mode, before the measured ones
+     */
+    void setWarmup(int node, int warmup);
+
+    /**
+     * @returns the number of runs executed, in benchmark mode, before the measured ones
+     */
+    int warmup(int node) const;
+
+    /**
+     * Set the result cache use of the script (see \ref ScriptJob::setCached())
+     */
+    void setCached(int node, bool cached);
+
+    /**
+     * @returns true if the results of the script are taken from the cache when possible
+     */
+    bool cached(int node) const;
+
+    /**
+     * Assign the files the script reads, relative to its directory or absolute
+     */
+    void setInputs(int node, const QStringList& files);
+
+    /**
+     * @returns the files the script reads
+     */
+    QStringList inputs(int node) const;
+
+    /**
+     * Assign the parameter sweep of the script (see \ref Sweep)
+     */
+    void setSweep(int node, const Sweep& sweep);
+
+    /**
+     * @returns the parameter sweep of the script, empty if it's executed just once
+     */
+    Sweep sweep(int node) const;
+
+    /**
+     * Assign the input parameters line for the script
+     */
+    void setParameters(int node, const QString& params);
+
+    /**
+     * @returns the input parameters line
+     */
+    QString parameters(int node) const;
+
+    /**
+     * Assign the identifier other scripts use to say they have to run after this one
+     */
+    void setScriptId(int node, const QString& id);
+
+    /**
+     * @returns the script identifier
+     */
+    QString scriptId(int node) const;
+
+    /**
+     * Assign the identifiers of the scripts that have to end correctly before this one can start
+     */
+    void setDependencies(int node, const QStringList& ids);
+
+    /**
+     * @returns the identifiers of the scripts that have to end correctly before this one
+     */
+    QStringList dependencies(int node) const;
+
+    /**
+     * Assign the expected execution time of the script in milliseconds
+     */
+    void setEstimate(int node, qint64 msecs);
+
+    /**
+     * @returns the expected execution time of the script in milliseconds, 0 if unknown
+     */
+    qint64 estimate(int node) const;
+
+    /**
+     * Set how the items of a Group are executed: "serial", "parallel" or "parallel:N"
+     * (see \ref ScriptQueue::parseExecutionMode())
+     */
+    void setExecutionMode(int node, const QString& mode);
+
+    /**
+     * @returns the execution mode of the Group (the default is "parallel")
+     */
+    QString executionMode(int node) const;
+
+    /**
+     * Set the longest time an execution of a script File, or the whole execution
+     * of a Group, can take
+     *
+     * @param seconds is the timeout, 0 means no limit
+     */
+    void setTimeout(int node, int seconds);
+
+    /**
+     * @returns the timeout of the File/Group in seconds, 0 if there is no limit
+     */
+    int timeout(int node) const;
+
+    /**
+     * Set the longest time a script File can run without writing anything
+     *
+     * @param seconds is the timeout, 0 means no limit
+     */
+    void setIdleTimeout(int node, int seconds);
+
+    /**
+     * @returns the longest time in seconds the script can run without output, 0 if there is no limit
+     */
+    int idleTimeout(int node) const;
+
+    /**
+     * Assign the environment of the script
+     *
+     * @param node is the script
+     * @param environment is the list of variables: name and value
+     */
+    void setEnvironment(int node, const QList< QPair<QString, QString> >& environment);
+
+    /**
+     * @returns the environment of the script: name and value of each variable
+     */
+    QList< QPair<QString, QString> > environment(int node) const;
+
+    /**
+     * Associate the Monitor View box that shows the output of the script
+     */
+    void setTextEditMonitor(int node, TextEditMonitor *box);
+
+    /**
+     * @return the reference to the TextEditMonitor if available (!= 0)
+     */
+    TextEditMonitor *textEditMonitor(int node) const;
+
+    /**
+     * Assign the execution state of the script. A script that succeeded or
+     * failed has been executed: it has a log file
+     */
+    void setState(int node, State state);
+
+    /**
+     * @returns the execution state of the script
+     */
+    State state(int node) const;
+
+    /**
+     * @returns true if the script is running, even if it's paused
+     */
+    bool running(int node) const;
+
+    /**
+     * @returns true if the script was executed
+     */
+    bool executed(int node) const;
+
+    /**
+     * Show all the nodes as never executed in this run: the scripts that were
+     * executed keep their log file
+     */
+    void resetStates();
+
+    // QAbstractItemModel
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex& index) const;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole);
+    Qt::ItemFlags flags(const QModelIndex& index) const;
+
+  signals:
+    /**
+     * Emitted when the user renames a group or checks/unchecks a node in a view
+     */
+    void modified();
+
+  private:
+    /**
+     * A group or a script of the project
+     */
+    struct Node
+    {
+      /**
+       * Create a checked group that is not in the model yet
+       */
+      Node() : parent(-1), row(0), type(Group), state(Idle), checked(true), executed(false),
+        benchmark(false), cached(false), times(0), delay(0), warmup(0), timeout(0), idleTimeout(0), estimate(0), monitor(0) {}
+
+      /**
+       * The group that contains the node, -1 for the root or a removed node
+       */
+      int parent;
+
+      /**
+       * The position of the node in its group
+       */
+      int row;
+
+      /**
+       * The kind of node (\ref Type)
+       */
+      quint8 type;
+
+      /**
+       * The execution state of the script (\ref State)
+       */
+      quint8 state;
+
+      /**
+       * It's true if the node is checked
+       */
+      bool checked;
+
+      /**
+       * It's false if the script was never executed
+       */
+      bool executed;
+
+      /**
+       * It's true if the script is executed in benchmark mode
+       */
+      bool benchmark;
+
+      /**
+       * It's true if the results of the script are taken from the cache when possible
+       */
+      bool cached;
+
+      /**
+       * The number of times the script has to be executed
+       */
+      int times;
+
+      /**
+       * The number of seconds the script has to be delayed before to run again
+       */
+      int delay;
+
+      /**
+       * The number of runs, in benchmark mode, before the measured ones
+       */
+      int warmup;
+
+      /**
+       * The longest time in seconds the script execution or the group can take (0 for no limit)
+       */
+      int timeout;
+
+      /**
+       * The longest time in seconds the script can run without output (0 for no limit)
+       */
+      int idleTimeout;
+
+      /**
+       * The expected execution time in milliseconds (0 if unknown)
+       */
+      qint64 estimate;
+
+      /**
+       * The name shown: the group name or the script file name
+       */
+      QString name;
+
+      /**
+       * The absolute file path of the script
+       */
+      QString absoluteFilePath;
+
+      /**
+       * The input parameters line
+       */
+      QString parameters;
+
+      /**
+       * The identifier of the script
+       */
+      QString scriptId;
+
+      /**
+       * How the items of a group are executed
+       */
+      QString executionMode;
+
+      /**
+       * The identifiers of the scripts that have to end correctly before this one
+       */
+      QStringList dependencies;
+
+      /**
+       * The files the script reads
+       */
+      QStringList inputs;
+
+      /**
+       * The parameter sweep of the script
+       */
+      Sweep sweep;
+
+      /**
+       * The environment variables of the script: name and value
+       */
+      QList< QPair<QString, QString> > environment;
+
+      /**
+       * The Monitor View box showing the script output, 0 if none
+       */
+      TextEditMonitor *monitor;
+
+      /**
+       * The indexes of the children of a group
+       */
+      QVector<int> children;
+    };
+
+    /**
+     * Append a new node to a group
+     *
+     * @returns the index of the new node
+     */
+    int appendNode(int parent, Node& node);
+
+    /**
+     * Release the memory of a removed node and of its children
+     */
+    void releaseNode(int node);
+
+    /**
+     * Notify the views that a node has to be shown again
+     */
+    void nodeChanged(int node);
+
+  private:
+    /**
+     * All the nodes: the root is the first one
+     */
+    QVector<Node> m_nodes;
+
+    /**
+     * It's true between \ref beginLoad() and \ref endLoad()
+     */
+    bool m_loading;
+
+    /**
+     * The icon of the groups
+     */
+    QIcon m_groupIcon;
+
+    /**
+     * The icon of the scripts
+     */
+    QIcon m_fileIcon;
+};
+
+#endif
@@ -18,24 +18,82 @@
  ***************************************************************************/
 
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QTimer>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTextCodec>
+#include <QtCore/QProcessEnvironment>
+#include <QtCore/QJsonDocument>
 #include <QtCore/QDebug>
 
-#include <QtWidgets/QMessageBox>
+#ifndef Q_OS_WIN
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <signal.h>
+  #include <string.h>
+  #include <unistd.h>
+  #include <sys/wait.h>
+#endif
 
 #include "scriptprocess.h"
-#include "treewidgetitem.h"
-#include "textedit.h"
-#include "texteditmonitor.h"
+#include "logwriter.h"
+#include "processsampler.h"
+#include "resultcache.h"
+#ifndef Q_OS_WIN
+  #include "spawnserver.h"
+#endif
 
-ScriptProcess::ScriptProcess(QList<QString> *tree, TreeWidgetItem *item, const QString &basedir)
+ScriptProcess::ScriptProcess(const ScriptJob& job, const QString &basedir)
  : QProcess()
 {
-  m_times = item->times();
-  m_delay = item->delay();
-  m_name = item->assignedName();
-  m_params = item->parameters();
-  m_environment = item->environment();
+  // in benchmark mode the warmup runs are executed before the measured ones
+  m_benchmarkMode = job.benchmark();
+  m_warmup = m_benchmarkMode ? qMax(job.warmup(), 0) : 0;
+  m_times = job.times() + m_warmup;
+  m_delay = job.delay();
+  m_name = job.name();
+  m_params = job.parameters();
+  m_environment = job.environment();
+  m_id = job.id();
+  m_taskId = job.taskId();
+  m_taskLabel = job.taskLabel();
+  m_dependencies = job.dependencies();
+  m_estimate = job.estimate();
+
+  // a benchmark has to measure the script: it's always executed
+  m_cached = job.cached() && !m_benchmarkMode;
+  m_inputs = job.inputs();
+  m_cacheDir = ResultCache::dirFor(basedir);
+  m_cacheSize = 0;
+  m_fromCache = false;
+  m_duration = 0;
+  m_code = 0;
+  m_spawned = false;
+  m_scriptExited = false;
+  m_waitStatus = 0;
+  m_orphans = 0;
+  m_channels[0] = m_channels[1] = m_channels[2] = -1;
+  m_inNotifier = m_outNotifier = m_errNotifier = 0;
+  m_throttled = false;
+  m_decoders[0] = m_decoders[1] = 0;
+
+  // a hung script is terminated: it doesn't hold its slot forever
+  m_timeout = qMax(job.timeout(), 0);
+  m_idleTimeout = qMax(job.idleTimeout(), 0);
+  m_gracePeriod = 5;
+  m_stopped = m_timedOut = false;
+  m_paused = m_pendingRun = m_pendingResult = false;
+  m_runPaused = m_totalPaused = 0;
+  m_timeoutLeft = -1;
+  m_timeoutTimer = new QTimer(this);
+  m_timeoutTimer->setSingleShot(true);
+  connect(m_timeoutTimer, SIGNAL(timeout()), SLOT(executionTimedOut()));
+  m_idleTimer = new QTimer(this);
+  m_idleTimer->setSingleShot(true);
+  connect(m_idleTimer, SIGNAL(timeout()), SLOT(checkIdle()));
+  m_killTimer = new QTimer(this);
+  m_killTimer->setSingleShot(true);
+  connect(m_killTimer, SIGNAL(timeout()), SLOT(killScript()));
 
   qDebug() << "execution of: '" << m_name << "'";
 
@@ -45,75 +103,339 @@ ScriptProcess::ScriptProcess(QList<QString> *tree, TreeWidgetItem *item, const Q
   connect(this, SIGNAL(error(QProcess::ProcessError)), SLOT(gotError(QProcess::ProcessError)));
   connect(this, SIGNAL(started()), SLOT(startedProcess()));
 
-  m_mvOut = item->textEditMonitor();
-
+  // the directories and the files are created only when the script starts:
+  //  a queued script doesn't hold any file descriptor
   QDir file(m_name);
-  QString str(basedir + "/");
-  while (!tree->isEmpty())
+  m_logDir = basedir + "/";
+  QStringList groups = job.logPath();
+  for (int i = 0; i < groups.size(); i++)
+    m_logDir += groups.at(i) + "/";
+
+  // each point of a sweep has its own files
+  QString base = m_logDir + file.dirName();
+  if (m_taskId >= 0)
   {
-    str += tree->takeLast() + "/";
+    m_sweepFileName = base + ".sweep.json";
+    base += "." + QString::number(m_taskId);
   }
-  if (!file.mkpath(str))
-    qDebug() << "cannot create" << str;
-  m_logfile.setFileName(str + file.dirName() + ".log");
+  m_logFileName = base + ".log";
+  m_usageFileName = base + ".usage";
+  m_benchmarkFileName = base + ".bench.json";
+  m_baselineFileName = base + ".baseline.json";
+  m_log = -1;
+  m_tmpLog = -1;
+  m_usageLog = -1;
+  m_lookup = 0;
+  m_restore = 0;
+  m_restoredDuration = 0;
+  m_processId = 0;
+  m_executedTimes = 0;
   m_running = false;
-  if (!m_tmp.open())
-    qDebug() << "cannot open in writing the temporary file:" << m_tmp.fileName();
-  m_tmp.setAutoRemove( true );
-  m_tmpFile.setDevice(&m_tmp);
-  m_outputBox = 0;
+}
+
+
+ScriptProcess::~ScriptProcess()
+{
+#ifndef Q_OS_WIN
+  // QProcess kills its own process, not its descendants: the whole tree is killed here
+  if (m_processId)
+    signalScript(SIGKILL);
+  if (m_spawned)
+    SpawnServer::instance()->setOwner((qint64)m_pid, 0);
+#endif
+  closeSpawnedChannels();
+  if (m_processId)
+    ProcessSampler::instance()->unwatch(m_processId);
+
+  // the lookup is deleted with the script: it has to finish first
+  if (m_lookup)
+    m_lookup->wait();
+
+  // the temporary file has to be closed before it's removed
+  if (m_log >= 0)
+    LogWriter::instance()->close(m_log);
+  if (m_usageLog >= 0)
+    LogWriter::instance()->close(m_usageLog);
+  if (m_tmpLog >= 0)
+    LogWriter::instance()->close(m_tmpLog, true);
+
+  delete m_decoders[0];
+  delete m_decoders[1];
 }
 
 
 void ScriptProcess::run()
 {
+  m_timer.start();
+  m_stopped = m_timedOut = false;
+  m_paused = m_pendingRun = m_pendingResult = false;
+  m_totalPaused = 0;
   emit running(this);
 
   // check if log file's writeble
-  if (!m_logfile.open(QIODevice::Append | QIODevice::Text))
+  if (!openLog())
   {
-    qDebug() << "cannot create file in writing: " << m_logfile.fileName();
+    closeLog();
     emit finishedBad(this);
     return;
   }
 
+  // each run of the project has its own statistics
+  m_benchmark = Benchmark();
+  if (m_benchmarkMode)
+    m_benchmark.loadBaseline(m_baselineFileName);
+
+  // the same inputs give the same result: no need to execute the script
+  m_fromCache = false;
+  m_cacheKey.clear();
+  if (m_cached && (m_cacheSize > 0))
+  {
+    // the inputs are hashed now, a previous script may have written them, but
+    //  not in this thread: the files can be big
+    m_lookup = new ResultLookup(m_cacheDir, m_cacheSize, m_name, m_params, m_environment, m_inputs, m_times, this);
+    connect(m_lookup, SIGNAL(finished()), SLOT(restoreResult()));
+    m_lookup->start();
+    return;
+  }
+
+  execute();
+}
+
+
+void ScriptProcess::execute()
+{
   m_executedTimes = 1;
-  m_outLog.setDevice(&m_logfile);
   qDebug() << "executing #" << m_executedTimes << " of " << m_times << " " << m_name;
   if (m_times > 1)
   {
-    m_outLog << "executing #1 of " << m_times << "\n\n";
-    m_outLog.flush();
-    m_tmpFile << "executing #1 of " << m_times << "\n\n";
-    m_tmpFile.flush();
+    appendLog(QString("executing #1 of %1%2\n\n").arg(m_times)
+      .arg(m_warmup > 0 ? " (warmup)" : "").toLocal8Bit());
   }
 
-  QStringList env;
-  QMapIterator<QTreeWidgetItem*, QPair<QString, QString> > iterator(m_environment);
-  while (iterator.hasNext())
-  {
-    iterator.next();
+  launch();
+}
+
 
-    // prepare the environment
-    env << iterator.value().first + "=" + iterator.value().second;
+void ScriptProcess::launch()
+{
+  // measure each execution on its own
+  m_usage = ResourceUsage();
+  m_scriptExited = false;
+  m_orphans = 0;
+  m_runPaused = 0;
+  m_started = QDateTime::currentDateTime();
+  m_runTimer.start();
+
+  // each execution has its own time limits
+  if (m_timeout > 0)
+    m_timeoutTimer->start(1000 * m_timeout);
+  if (m_idleTimeout > 0)
+  {
+    m_lastOutput.start();
+    m_idleTimer->start(1000 * m_idleTimeout);
   }
-  setEnvironment(env);
+
+  // the variables of the script are added to the QRunner environment: a
+  //  list of variables alone would replace it, PATH and HOME included
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  for (int i = 0; i < m_environment.size(); i++)
+    environment.insert(m_environment.at(i).first, m_environment.at(i).second);
+  QStringList env = environment.toStringList();
 
 #ifdef Q_OS_WIN
+  setEnvironment(env);
   start("cmd /C \"" + m_name + "\" " + m_params);
 #else
   QStringList params = m_params.split(' ');
+  if (spawnScript(params, env))
+    return;
+
+  // the spawn helper is not available: fork QRunner
+  setEnvironment(env);
   start(m_name, params);
 #endif
 }
 
 
+bool ScriptProcess::spawnScript(const QStringList& params, const QStringList& env)
+{
+#ifdef Q_OS_WIN
+  Q_UNUSED(params);
+  Q_UNUSED(env);
+  return false;
+#else
+  SpawnServer *server = SpawnServer::instance();
+  if (!server || !server->isAvailable())
+    return false;
+
+  int pipes[3][2];
+  for (int i = 0; i < 3; i++)
+  {
+    if (pipe(pipes[i]) < 0)
+    {
+      qDebug() << "cannot create the pipes for" << m_name << ":" << strerror(errno);
+      for (int j = 0; j < i; j++)
+      {
+        close(pipes[j][0]);
+        close(pipes[j][1]);
+      }
+      return false;
+    }
+  }
+
+  // the script gets the read end of stdin and the write ends of stdout and stderr
+  int fds[3] = { pipes[0][0], pipes[1][1], pipes[2][1] };
+  m_channels[0] = pipes[0][1];
+  m_channels[1] = pipes[1][0];
+  m_channels[2] = pipes[2][0];
+  for (int i = 0; i < 3; i++)
+  {
+    fcntl(m_channels[i], F_SETFD, FD_CLOEXEC);
+    fcntl(m_channels[i], F_SETFL, fcntl(m_channels[i], F_GETFL) | O_NONBLOCK);
+  }
+
+  int error;
+  qint64 pid = server->spawn(m_name, params, env, QDir::currentPath(), fds, &error);
+  for (int i = 0; i < 3; i++)
+    close(fds[i]);
+
+  if (pid < 0)
+  {
+    closeSpawnedChannels();
+    if (!server->isAvailable())
+      return false;
+
+    qDebug() << "cannot start" << m_name << ":" << strerror(error);
+    gotError(QProcess::FailedToStart);
+    return true;
+  }
+
+  m_inNotifier = new QSocketNotifier(m_channels[0], QSocketNotifier::Write, this);
+  m_inNotifier->setEnabled(false);
+  connect(m_inNotifier, SIGNAL(activated(int)), SLOT(writeSpawnedInput()));
+  m_outNotifier = new QSocketNotifier(m_channels[1], QSocketNotifier::Read, this);
+  connect(m_outNotifier, SIGNAL(activated(int)), SLOT(readSpawnedOutput(int)));
+  m_errNotifier = new QSocketNotifier(m_channels[2], QSocketNotifier::Read, this);
+  connect(m_errNotifier, SIGNAL(activated(int)), SLOT(readSpawnedOutput(int)));
+
+  // the script is running with PID: m_pid
+  m_spawned = true;
+  m_running = true;
+  m_pid = pid;
+  m_processId = pid;
+  server->setOwner(pid, this);
+  ProcessSampler::instance()->watch(m_processId);
+  return true;
+#endif
+}
+
+
+void ScriptProcess::closeSpawnedChannels()
+{
+  if (m_throttled)
+  {
+    disconnect(LogWriter::instance(), SIGNAL(drained()), this, SLOT(logDrained()));
+    m_throttled = false;
+  }
+  m_throttledNotifiers.clear();
+  delete m_inNotifier;
+  delete m_outNotifier;
+  delete m_errNotifier;
+  m_inNotifier = m_outNotifier = m_errNotifier = 0;
+  m_input.clear();
+
+#ifndef Q_OS_WIN
+  for (int i = 0; i < 3; i++)
+  {
+    if (m_channels[i] >= 0)
+      close(m_channels[i]);
+    m_channels[i] = -1;
+  }
+#endif
+}
+
+
 QString ScriptProcess::tmpFile() const
 {
   return m_tmp.fileName();
 }
 
 
+void ScriptProcess::syncTmpFile()
+{
+  LogWriter::instance()->sync(m_tmpLog);
+}
+
+
+bool ScriptProcess::openLog()
+{
+  if (!QDir().mkpath(m_logDir))
+    qDebug() << "cannot create" << m_logDir;
+
+  if (m_log < 0)
+    m_log = LogWriter::instance()->open(m_logFileName);
+  if (m_log < 0)
+  {
+    qDebug() << "cannot create file in writing: " << m_logFileName;
+    return false;
+  }
+
+  if (m_tmp.fileName().isEmpty())
+  {
+    // the first run: create the temporary file, it's removed with the script
+    if (!m_tmp.open())
+    {
+      qDebug() << "cannot open in writing the temporary file:" << m_tmp.fileName();
+      return false;
+    }
+    m_tmp.setAutoRemove( true );
+
+    // the temporary file is written by the log writer thread
+    m_tmp.close();
+  }
+
+  if (m_tmpLog < 0)
+    m_tmpLog = LogWriter::instance()->open(m_tmp.fileName());
+  if (m_tmpLog < 0)
+  {
+    qDebug() << "cannot open in writing the temporary file:" << m_tmp.fileName();
+    return false;
+  }
+
+  // the script runs anyway if its resources cannot be recorded
+  if (m_usageLog < 0)
+    m_usageLog = LogWriter::instance()->open(m_usageFileName);
+  if (m_usageLog < 0)
+    qDebug() << "cannot create file in writing: " << m_usageFileName;
+
+  return true;
+}
+
+
+void ScriptProcess::appendLog(const QByteArray& data)
+{
+  // the log writer thread puts the data on disk in batches
+  LogWriter::instance()->write(m_log, data);
+  LogWriter::instance()->write(m_tmpLog, data);
+}
+
+
+void ScriptProcess::closeLog()
+{
+  // the script ended: write everything now and release the files,
+  //  the temporary file stays on disk for the console
+  if (m_log >= 0)
+    LogWriter::instance()->close(m_log);
+  m_log = -1;
+  if (m_usageLog >= 0)
+    LogWriter::instance()->close(m_usageLog);
+  m_usageLog = -1;
+  if (m_tmpLog >= 0)
+    LogWriter::instance()->close(m_tmpLog);
+  m_tmpLog = -1;
+}
+
+
 QString ScriptProcess::name() const
 {
   return m_name;
@@ -126,99 +448,680 @@ int ScriptProcess::times() const
 }
 
 
-void ScriptProcess::assignConsole(TextEdit* outbox)
+bool ScriptProcess::isBenchmark() const
+{
+  return m_benchmarkMode;
+}
+
+
+Benchmark ScriptProcess::benchmark() const
+{
+  return m_benchmark;
+}
+
+
+QString ScriptProcess::benchmarkFile() const
+{
+  return m_benchmarkFileName;
+}
+
+
+QString ScriptProcess::baselineFile() const
+{
+  return m_baselineFileName;
+}
+
+
+int ScriptProcess::taskId() const
+{
+  return m_taskId;
+}
+
+
+QString ScriptProcess::taskLabel() const
+{
+  return m_taskLabel;
+}
+
+
+QString ScriptProcess::sweepFile() const
+{
+  return m_sweepFileName;
+}
+
+
+QString ScriptProcess::id() const
+{
+  return m_id;
+}
+
+
+QStringList ScriptProcess::dependencies() const
+{
+  return m_dependencies;
+}
+
+
+qint64 ScriptProcess::estimate() const
+{
+  return m_estimate;
+}
+
+
+qint64 ScriptProcess::duration() const
 {
-  m_outputBox = outbox;
+  return m_duration;
 }
 
 
 bool ScriptProcess::isRunning()
 {
-  return m_running;
+  // hashing the inputs and restoring their result are part of the run
+  return m_running || m_lookup || m_restore;
+}
+
+
+int ScriptProcess::returnCode() const
+{
+  return m_code;
+}
+
+
+qint64 ScriptProcess::pid() const
+{
+  return m_processId;
+}
+
+
+int ScriptProcess::executedTimes() const
+{
+  return m_executedTimes;
+}
+
+
+ResourceUsage ScriptProcess::usage() const
+{
+  return m_usage;
+}
+
+
+void ScriptProcess::setGracePeriod(int seconds)
+{
+  m_gracePeriod = seconds;
+}
+
+
+void ScriptProcess::setCacheSize(qint64 bytes)
+{
+  m_cacheSize = qMax(bytes, (qint64)0);
+}
+
+
+bool ScriptProcess::fromCache() const
+{
+  return m_fromCache;
+}
+
+
+bool ScriptProcess::timedOut() const
+{
+  return m_timedOut;
+}
+
+
+void ScriptProcess::timeOut(const QString& reason)
+{
+  if (!m_running || m_timedOut)
+    return;
+
+  qDebug() << m_name << "timed out:" << reason;
+  m_stopped = m_timedOut = true;
+  appendLog(("\n\nQRunner: " + reason + ": terminated\n").toLocal8Bit());
+  terminateScript();
+}
+
+
+void ScriptProcess::stop()
+{
+  if (m_lookup || m_restore)
+  {
+    // the script is not executed when its inputs have been hashed
+    m_stopped = true;
+    if (m_pendingResult)
+    {
+      // they have been hashed while it was paused: it ends now
+      m_pendingResult = false;
+      restoreResult();
+    }
+    return;
+  }
+  if (!m_running)
+    return;
+
+  // the user stopped the script: it's not executed again
+  m_stopped = true;
+  terminateScript();
+}
+
+
+bool ScriptProcess::pause()
+{
+#ifdef Q_OS_WIN
+  return false;
+#else
+  // hashing the inputs the script doesn't start until it's resumed
+  if ((!m_running && !m_lookup) || m_paused || m_stopped)
+    return false;
+
+  // the whole process group stops: it doesn't use the CPU until it's resumed
+  if (m_processId)
+    signalScript(SIGSTOP);
+  m_paused = true;
+  m_pauseTimer.start();
+
+  // the paused time doesn't count for the timeouts
+  m_timeoutLeft = m_timeoutTimer->isActive() ? m_timeoutTimer->remainingTime() : -1;
+  m_timeoutTimer->stop();
+  m_idleTimer->stop();
+
+  qDebug() << m_name << "paused";
+  emit paused(this);
+  return true;
+#endif
+}
+
+
+void ScriptProcess::resume()
+{
+#ifndef Q_OS_WIN
+  if (!m_paused)
+    return;
+
+  m_paused = false;
+  qint64 paused = m_pauseTimer.nsecsElapsed();
+  m_runPaused += paused;
+  m_totalPaused += paused;
+  if (m_processId)
+    signalScript(SIGCONT);
+
+  // the time limits go on from where they were: a terminated script doesn't need them
+  if (m_processId && !m_stopped)
+  {
+    if (m_timeoutLeft >= 0)
+      m_timeoutTimer->start(m_timeoutLeft);
+    if (m_idleTimeout > 0)
+    {
+      m_lastOutput.start();
+      m_idleTimer->start(1000 * m_idleTimeout);
+    }
+  }
+  m_timeoutLeft = -1;
+
+  qDebug() << m_name << "resumed";
+  emit resumed(this);
+
+  if (m_pendingRun)
+  {
+    // it has been paused while waiting to run again
+    m_pendingRun = false;
+    runAgain();
+  }
+  else if (m_pendingResult)
+  {
+    // its inputs have been hashed while it was paused
+    m_pendingResult = false;
+    restoreResult();
+  }
+#endif
+}
+
+
+bool ScriptProcess::isPaused() const
+{
+  return m_paused;
+}
+
+
+qint64 ScriptProcess::runTime() const
+{
+  qint64 paused = m_runPaused + (m_paused ? m_pauseTimer.nsecsElapsed() : 0);
+  return m_runTimer.nsecsElapsed() - paused;
+}
+
+
+void ScriptProcess::terminateScript()
+{
+  if (m_processId == 0)
+  {
+    // waiting to run again: the next run doesn't start, even if it was paused
+    resume();
+    return;
+  }
+
+  // let the script and its descendants clean up before they are killed
+#ifdef Q_OS_WIN
+  terminate();
+#else
+  signalScript(SIGTERM);
+#endif
+
+  // a paused script gets the signal when it goes on
+  resume();
+
+  if (!m_killTimer->isActive())
+    m_killTimer->start(1000 * m_gracePeriod);
+}
+
+
+void ScriptProcess::killScript() // SLOT
+{
+  if (m_processId == 0)
+    // it ended meanwhile
+    return;
+
+  qDebug() << m_name << "didn't end within" << m_gracePeriod << "s: killed";
+#ifdef Q_OS_WIN
+  kill();
+#else
+  signalScript(SIGKILL);
+#endif
+}
+
+
+void ScriptProcess::signalScript(int signal)
+{
+#ifdef Q_OS_WIN
+  Q_UNUSED(signal);
+#else
+  pid_t group = (pid_t)m_pid;
+  if (group <= 0)
+    // kill(0) would signal QRunner itself
+    return;
+
+  // the script leads its process group: the descendants that left it are signalled one by one,
+  //  the orphans that left it by the spawn helper that adopted them
+  QList<qint64> descendants = ProcessSampler::descendants(group);
+  if (!m_spawned || !SpawnServer::instance()->signalGroup(group, signal))
+    ::kill(-group, signal);
+  for (int i = 0; i < descendants.size(); i++)
+  {
+    pid_t pid = (pid_t)descendants.at(i);
+    if (::getpgid(pid) != group)
+      ::kill(pid, signal);
+  }
+#endif
+}
+
+
+#ifndef Q_OS_WIN
+void ScriptProcess::setupChildProcess()
+{
+  // the script started by QProcess leads its own process group too
+  ::setpgid(0, 0);
+}
+#endif
+
+
+void ScriptProcess::executionTimedOut() // SLOT
+{
+  timeOut(QString("the execution took more than %1 s").arg(m_timeout));
+}
+
+
+void ScriptProcess::checkIdle() // SLOT
+{
+  // the output only restarts the clock: the timer is moved forward here
+  qint64 idle = m_lastOutput.elapsed();
+  if (idle < 1000 * (qint64)m_idleTimeout)
+  {
+    m_idleTimer->start(1000 * m_idleTimeout - idle);
+    return;
+  }
+
+  timeOut(QString("no output for %1 s").arg(m_idleTimeout));
+}
+
+
+qint64 ScriptProcess::sendInput(const QByteArray& data)
+{
+#ifndef Q_OS_WIN
+  if (m_spawned)
+  {
+    if (m_channels[0] < 0)
+      return -1;
+
+    // the script may not be reading: the GUI doesn't wait for it
+    m_input += data;
+    if (!m_inNotifier->isEnabled())
+      writeSpawnedInput();
+    return (m_channels[0] < 0) ? -1 : data.size();
+  }
+#endif
+  return write(data);
+}
+
+
+void ScriptProcess::writeSpawnedInput() // SLOT
+{
+#ifndef Q_OS_WIN
+  while (!m_input.isEmpty())
+  {
+    ssize_t n = ::write(m_channels[0], m_input.constData(), m_input.size());
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN)
+      {
+        // the pipe is full: the rest goes when the script reads
+        m_inNotifier->setEnabled(true);
+        return;
+      }
+
+      qDebug() << "cannot write to" << m_name << "standard input:" << strerror(errno);
+      m_inNotifier->setEnabled(false);
+      m_inNotifier->deleteLater();
+      m_inNotifier = 0;
+      m_input.clear();
+      close(m_channels[0]);
+      m_channels[0] = -1;
+      return;
+    }
+    m_input.remove(0, n);
+  }
+  m_inNotifier->setEnabled(false);
+#endif
 }
 
 
 void ScriptProcess::runAgain()
 {
+  if (m_stopped)
+  {
+    // stopped while waiting to run again
+    finish(QProcess::CrashExit);
+    return;
+  }
+
+  if (m_paused)
+  {
+    // paused while waiting to run again: the next run starts when it's resumed
+    m_pendingRun = true;
+    return;
+  }
+
   // run again a script: m_times > 1
   m_executedTimes++;
   qDebug() << "executing #" << m_executedTimes << " of " << m_times << " " << m_name;
-  m_outLog << "\n\nexecuting #" << m_executedTimes << " of " << m_times << "\n\n";
-  m_outLog.flush();
-  m_tmpFile << "\n\nexecuting #" << m_executedTimes << " of " << m_times << "\n\n";
-  m_tmpFile.flush();
+  appendLog(QString("\n\nexecuting #%1 of %2%3\n\n").arg(m_executedTimes).arg(m_times)
+    .arg(m_executedTimes <= m_warmup ? " (warmup)" : "").toLocal8Bit());
+
+  launch();
+}
+
+
+void ScriptProcess::sentOutputText() // SLOT
+{
+  readChannel(QProcess::StandardOutput);
+}
+
+
+void ScriptProcess::sentErrorText() // SLOT
+{
+  readChannel(QProcess::StandardError);
+}
 
-  QStringList env;
-  QMapIterator<QTreeWidgetItem*, QPair<QString, QString> > iterator(m_environment);
-  while (iterator.hasNext())
+
+void ScriptProcess::readChannel(QProcess::ProcessChannel channel)
+{
+  // read in place: no buffer is allocated for each chunk
+  char buffer[ReadSize];
+  qint64 n;
+  setReadChannel(channel);
+  while (!m_throttled && ((n = read(buffer, sizeof(buffer))) > 0))
   {
-    iterator.next();
+    writeOutput(QByteArray::fromRawData(buffer, n), channel == QProcess::StandardError);
+    if (logFull())
+      // QProcess keeps buffering what the script writes: the spawn helper path doesn't
+      throttleOutput();
+  }
+}
 
-    // prepare the environment
-    env << iterator.value().first + "=" + iterator.value().second;
+
+bool ScriptProcess::logFull() const
+{
+  return LogWriter::instance()->isFull(m_log) || LogWriter::instance()->isFull(m_tmpLog);
+}
+
+
+void ScriptProcess::throttleOutput()
+{
+  if (m_throttled)
+    return;
+
+  // the log writer tells when the buffers are on disk: just this script listens
+  m_throttled = true;
+  connect(LogWriter::instance(), SIGNAL(drained()), SLOT(logDrained()));
+  QSocketNotifier *notifiers[2] = { m_outNotifier, m_errNotifier };
+  for (int i = 0; i < 2; i++)
+  {
+    if (notifiers[i] && notifiers[i]->isEnabled())
+    {
+      notifiers[i]->setEnabled(false);
+      m_throttledNotifiers.append(notifiers[i]);
+    }
   }
-  setEnvironment(env);
+}
+
+
+void ScriptProcess::logDrained() // SLOT
+{
+  if (!m_throttled || logFull())
+    return;
+
+  disconnect(LogWriter::instance(), SIGNAL(drained()), this, SLOT(logDrained()));
+  m_throttled = false;
+
+  // the notifiers are activated again by the data still in the pipes
+  for (int i = 0; i < m_throttledNotifiers.size(); i++)
+    m_throttledNotifiers.at(i)->setEnabled(true);
+  m_throttledNotifiers.clear();
+
+  if (!m_spawned)
+  {
+    readChannel(QProcess::StandardOutput);
+    readChannel(QProcess::StandardError);
+  }
+}
+
 
+void ScriptProcess::writeOutput(const QByteArray& newData, bool error)
+{
+  if (newData.isEmpty())
+    return;
+
+  // the script is alive: cheaper than restarting the idle timer for each chunk
+  if (m_idleTimeout > 0)
+    m_lastOutput.start();
+
+  // the log files get the bytes as they come
+  appendLog(newData);
+
+  // decode the text just for who shows it
+  if (receivers(SIGNAL(outputText(QString))) == 0)
+  {
+    // the next one who shows the text doesn't get half a sequence from here
+    delete m_decoders[0];
+    delete m_decoders[1];
+    m_decoders[0] = m_decoders[1] = 0;
+    return;
+  }
+
+  // each channel has its own decoder: it keeps the multibyte sequences split between two reads
+  QTextDecoder *&decoder = m_decoders[error ? 1 : 0];
+  if (!decoder)
+  {
 #ifdef Q_OS_WIN
-  start("cmd /C \"" + m_name + "\" " + m_params);
+    decoder = QTextCodec::codecForName("ISO-8859-1")->makeDecoder();
 #else
-  QStringList params = m_params.split(' ');
-  start(m_name, params);
+    decoder = QTextCodec::codecForLocale()->makeDecoder();
 #endif
+  }
+
+  QString textToWrite = decoder->toUnicode(newData);
+  if (textToWrite.isEmpty())
+    // just the beginning of a multibyte sequence
+    return;
+
+  if (error && (textToWrite.at(textToWrite.length() - 1) == '\n'))
+    textToWrite.resize(textToWrite.length() - 1);
+  emit outputText(textToWrite);
 }
 
 
-void ScriptProcess::sentOutputText() // SLOT
+void ScriptProcess::readSpawnedOutput(int fd) // SLOT
 {
-  QByteArray newData = readAllStandardOutput();
 #ifdef Q_OS_WIN
-  QString textToWrite = QString::fromLatin1(newData);
+  Q_UNUSED(fd);
 #else
-  QString textToWrite = QString::fromLocal8Bit(newData);
+  // read one chunk: the notifier is activated again if there is more
+  char buffer[ReadSize];
+  ssize_t n;
+  do
+    n = read(fd, buffer, sizeof(buffer));
+  while ((n < 0) && (errno == EINTR));
+
+  if (n > 0)
+  {
+    writeOutput(QByteArray::fromRawData(buffer, n), fd == m_channels[2]);
+    if (logFull())
+      throttleOutput();
+  }
+  else if ((n == 0) || (errno != EAGAIN))
+  {
+    // the script closed the channel
+    if (fd == m_channels[1])
+      m_outNotifier->setEnabled(false);
+    else
+      m_errNotifier->setEnabled(false);
+  }
 #endif
+}
 
-  m_outLog << textToWrite;
-  m_outLog.flush();
-  m_tmpFile << textToWrite;
-  m_tmpFile.flush();
 
-  if (m_outputBox)
-    m_outputBox->append(textToWrite);
+void ScriptProcess::spawnedExited(qint64 pid, qint64 group, int status, bool left,
+  const ResourceUsage& usage) // SLOT
+{
+#ifdef Q_OS_WIN
+  Q_UNUSED(pid);
+  Q_UNUSED(group);
+  Q_UNUSED(status);
+  Q_UNUSED(left);
+  Q_UNUSED(usage);
+#else
+  if (!m_spawned || (group != (qint64)m_pid))
+    return;
+
+  // the helper measured the script or its orphan when it reaped it
+  m_usage.add(usage);
+  if (pid != (qint64)m_pid)
+  {
+    m_orphans++;
+    return;
+  }
 
-  if (m_mvOut != 0)
-    m_mvOut->append(textToWrite);
+  // the script ended, but it's over when the last process of its group ended:
+  //  what is still running holds the pipes and is measured with the script
+  m_waitStatus = status;
+  m_scriptExited = true;
+  if (left)
+  {
+    // the processes left by the script don't outlive it
+    appendLog("\n\nQRunner: the script left processes running: terminated\n");
+    terminateScript();
+  }
+#endif
 }
 
 
-void ScriptProcess::sentErrorText() // SLOT
+void ScriptProcess::spawnedAdopted(qint64 pid) // SLOT
 {
-  QByteArray newData = readAllStandardError();
 #ifdef Q_OS_WIN
-  QString textToWrite = QString::fromLatin1(newData);
+  Q_UNUSED(pid);
 #else
-  QString textToWrite = QString::fromLocal8Bit(newData);
+  if (!m_spawned)
+    return;
+
+  qDebug() << m_name << "left its process group with" << pid << ": measured with it";
+  ProcessSampler::instance()->addOrphan(m_processId, pid);
 #endif
+}
 
-  m_outLog << textToWrite;
-  m_outLog.flush();
-  m_tmpFile << textToWrite;
-  m_tmpFile.flush();
 
-  if (textToWrite.at(textToWrite.length() - 1) == '\n')
-    textToWrite.resize(textToWrite.length() - 1);
-  if (m_outputBox)
-    m_outputBox->append(textToWrite);
+void ScriptProcess::spawnedGroupEnded(qint64 group) // SLOT
+{
+#ifdef Q_OS_WIN
+  Q_UNUSED(group);
+#else
+  if (!m_spawned || !m_scriptExited || (group != (qint64)m_pid))
+    return;
+
+  if (m_orphans > 0)
+    qDebug() << m_name << "left" << m_orphans << "processes: reaped and measured with it";
+
+  // get what the script wrote before ending
+  char buffer[ReadSize];
+  for (int i = 1; i < 3; i++)
+  {
+    ssize_t n;
+    while (((n = read(m_channels[i], buffer, sizeof(buffer))) > 0) || ((n < 0) && (errno == EINTR)))
+    {
+      if (n > 0)
+        writeOutput(QByteArray::fromRawData(buffer, n), i == 2);
+    }
+  }
+  closeSpawnedChannels();
+  m_spawned = false;
 
-  if (m_mvOut != 0)
-    m_mvOut->append(textToWrite);
+  if (WIFEXITED(m_waitStatus))
+    scriptEnded(WEXITSTATUS(m_waitStatus), QProcess::NormalExit);
+  else
+    scriptEnded(WIFSIGNALED(m_waitStatus) ? WTERMSIG(m_waitStatus) : -1, QProcess::CrashExit);
+#endif
 }
 
 
 void ScriptProcess::scriptEnded(int code, QProcess::ExitStatus status) // SLOT
 {
+  if (m_throttled && !m_spawned)
+  {
+    // the script ended: what QProcess buffered meanwhile goes to the log now
+    disconnect(LogWriter::instance(), SIGNAL(drained()), this, SLOT(logDrained()));
+    m_throttled = false;
+    writeOutput(readAllStandardOutput(), false);
+    writeOutput(readAllStandardError(), true);
+  }
+
   m_status = status;
   m_code = code;
-  if (m_times > m_executedTimes)
+  m_timeoutTimer->stop();
+  m_idleTimer->stop();
+  m_killTimer->stop();
+#ifndef Q_OS_WIN
+  if (!m_scriptExited && (m_pid > 0))
+    // QProcess reaped the script and nobody waits for its orphans: they are killed
+    ::kill(-(pid_t)m_pid, SIGKILL);
+#endif
+  recordUsage();
+
+  // the execution ended: stop measuring it
+  ProcessSampler::instance()->unwatch(m_processId);
+  m_processId = 0;
+
+  // reset its pid now: the next run sets its own one while it's launched
+  m_pid = Q_PID(NULL);
+
+  if (!m_stopped && (m_times > m_executedTimes))
   {
     // delay if requested and more then one run
     if (m_delay > 0)
@@ -229,24 +1132,198 @@ void ScriptProcess::scriptEnded(int code, QProcess::ExitStatus status) // SLOT
       runAgain();
   }
   else
+    finish(status);
+}
+
+
+void ScriptProcess::finish(QProcess::ExitStatus status)
+{
+  if (m_paused)
   {
-    m_running = false;
-    m_logfile.close();
-    switch (status)
+    // killed while it was paused
+    m_paused = false;
+    m_totalPaused += m_pauseTimer.nsecsElapsed();
+    emit resumed(this);
+  }
+
+  m_running = false;
+  m_duration = m_timer.elapsed() - m_totalPaused / 1000000;
+
+  // only the executions that ended correctly are cached: a failure may not depend on the inputs
+  if (!m_cacheKey.isEmpty() && !m_fromCache && !m_stopped && (status == QProcess::NormalExit) && (m_code == 0))
+    storeResult();
+  closeLog();
+
+  // a stopped script failed even if it ended normally on SIGTERM, and so did
+  //  a script that exited with an error code or a benchmark slower than its
+  //  baseline: its successors must not start
+  if ((status == QProcess::NormalExit) && !m_stopped && (m_code == 0) &&
+      !(m_benchmarkMode && m_benchmark.regressed()))
+    // the script finished normally
+    emit finishedOK(this);
+  else
+    // the script finished with a crash or an error code, it has been stopped, it timed out or it regressed
+    emit finishedBad(this);
+}
+
+
+void ScriptProcess::recordUsage()
+{
+  // QProcess reaps its scripts itself: just the elapsed time is known
+  m_usage.setWallTime(runTime() / 1000000);
+
+  QJsonObject json = m_usage.toJson();
+  json.insert("script", m_name);
+  json.insert("run", m_executedTimes);
+  json.insert("times", m_times);
+  if (m_taskId >= 0)
+    json.insert("task_id", m_taskId);
+  json.insert("started", m_started.toString(Qt::ISODate));
+  json.insert("exit_code", m_code);
+  json.insert("crashed", m_status == QProcess::CrashExit);
+  if (m_executedTimes <= m_warmup)
+    json.insert("warmup", true);
+  if (m_timedOut)
+    json.insert("timed_out", true);
+  if (m_orphans > 0)
+    json.insert("orphans", m_orphans);
+  if (m_fromCache)
+    json.insert("cached", true);
+
+  // one line for each execution
+  LogWriter::instance()->write(m_usageLog, QJsonDocument(json).toJson(QJsonDocument::Compact) + '\n');
+
+  if (m_benchmarkMode)
+    recordBenchmark();
+
+  emit executed(this);
+}
+
+
+void ScriptProcess::recordBenchmark()
+{
+  if (m_executedTimes <= m_warmup)
+    // a warmup run: the caches are filled, nothing is measured
+    return;
+
+  // a benchmark needs more than the milliseconds of the usage
+  bool ok = (m_status == QProcess::NormalExit) && (m_code == 0);
+  m_benchmark.addRun(runTime() / 1000000.0, m_usage, ok);
+  if (m_executedTimes < m_times)
+    return;
+
+  // the last run: the statistics are ready
+  m_benchmark.save(m_benchmarkFileName);
+  appendLog("\n\n" + m_benchmark.summary().toLocal8Bit() + "\n");
+}
+
+
+void ScriptProcess::restoreResult() // SLOT
+{
+  if (m_paused && !m_stopped)
+  {
+    // the queue is paused: the script doesn't start until it's resumed
+    m_pendingResult = true;
+    return;
+  }
+
+  m_cacheKey = m_lookup->key();
+  bool found = m_lookup->found();
+  ResultCache::Result result = m_lookup->result();
+  m_lookup->deleteLater();
+  m_lookup = 0;
+
+  if (m_stopped)
+  {
+    // stopped while hashing its inputs: the script is not executed
+    m_cacheKey.clear();
+    m_code = -1;
+    m_status = QProcess::CrashExit;
+    finish(QProcess::CrashExit);
+    return;
+  }
+
+  if (!found)
+  {
+    execute();
+    return;
+  }
+
+  m_restore = new QFile(result.logFile, this);
+  if (!m_restore->open(QIODevice::ReadOnly))
+  {
+    // removed by an eviction meanwhile
+    qDebug() << "cannot read the file:" << result.logFile;
+    delete m_restore;
+    m_restore = 0;
+    execute();
+    return;
+  }
+
+  qDebug() << "result of" << m_name << "taken from the cache";
+  m_fromCache = true;
+  m_restoredDuration = result.duration;
+
+  // the restored execution is recorded as the last run
+  m_executedTimes = m_times;
+  m_usage = ResourceUsage();
+  m_started = QDateTime::currentDateTime();
+  m_runPaused = 0;
+  m_runTimer.start();
+  m_code = result.code;
+  restoreLog();
+}
+
+
+void ScriptProcess::restoreLog() // SLOT
+{
+  disconnect(LogWriter::instance(), SIGNAL(drained()), this, SLOT(restoreLog()));
+  if (m_stopped)
+  {
+    // stopped while its log was restored: the run didn't end
+    delete m_restore;
+    m_restore = 0;
+    m_cacheKey.clear();
+    m_code = -1;
+    m_status = QProcess::CrashExit;
+    finish(QProcess::CrashExit);
+    return;
+  }
+
+  // the log can be as big as the script output: the consoles and the log files
+  //  get it a chunk at a time, and the next chunk waits for the log writer
+  if (!m_restore->atEnd())
+  {
+    QByteArray chunk = m_restore->read(ReadSize);
+    if (!chunk.isEmpty())
     {
-      case QProcess::NormalExit:
-        // the script finished normally
-        emit finishedOK(this);
-        break;
-      case QProcess::CrashExit:
-        // the script finished with a crash
-        emit finishedBad(this);
-        break;
+      writeOutput(chunk, false);
+      connect(LogWriter::instance(), SIGNAL(drained()), SLOT(restoreLog()));
+      if (!logFull())
+      {
+        disconnect(LogWriter::instance(), SIGNAL(drained()), this, SLOT(restoreLog()));
+        QTimer::singleShot(0, this, SLOT(restoreLog()));
+      }
+      return;
     }
   }
 
-  // reset its pid
-  m_pid = Q_PID(NULL);
+  delete m_restore;
+  m_restore = 0;
+  appendLog(QString("\n\nQRunner: not executed, the inputs did not change since the execution "
+    "that took %1 ms\n").arg(m_restoredDuration).toLocal8Bit());
+  m_status = QProcess::NormalExit;
+  recordUsage();
+  finish(QProcess::NormalExit);
+}
+
+
+void ScriptProcess::storeResult()
+{
+  // the temporary file has the whole log of this execution
+  LogWriter::instance()->sync(m_tmpLog);
+  if (!ResultCache(m_cacheDir, m_cacheSize).store(m_cacheKey, m_tmp.fileName(), m_code, m_duration))
+    qDebug() << "cannot cache the result of" << m_name;
 }
 
 
@@ -267,6 +1344,17 @@ void ScriptProcess::gotError(QProcess::ProcessError err) //SLOT
   }
 */
   m_err = err;
+
+  if (err == QProcess::FailedToStart)
+  {
+    // no finished() signal will come: the script ended here
+    m_timeoutTimer->stop();
+    m_idleTimer->stop();
+    m_running = false;
+    m_duration = m_timer.elapsed();
+    closeLog();
+    emit finishedBad(this);
+  }
 }
 
 
@@ -278,6 +1366,8 @@ void ScriptProcess::startedProcess()  // SLOT
 
     // the script is running with PID: m_pid
     m_pid = processId();
+    m_processId = processId();
+    ProcessSampler::instance()->watch(m_processId);
   }
   else
     // not running: reset PID
@@ -22,20 +22,26 @@
 
 #include <QtCore/QProcess>
 #include <QtCore/QList>
-#include <QtCore/QFile>
 #include <QtCore/QTemporaryFile>
-#include <QtCore/QTextStream>
-
-class TextEdit;
-class TreeWidgetItem;
-class QTreeWidgetItem;
-class TextEditMonitor;
+#include <QtCore/QStringList>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QDateTime>
 
 #include <QtCore/QPair>
-#include <QtCore/QMap>
+
+#include "scriptjob.h"
+#include "resourceusage.h"
+#include "benchmark.h"
+
+class QSocketNotifier;
+class QFile;
+class QTimer;
+class QTextDecoder;
+class ResultLookup;
 
 /**
- * This class let define and start scripts
+ * This class let define and start scripts. It doesn't know anything about
+ * the GUI: who wants to show the script output connects to \ref outputText()
  *
  * @author Giovanni Venturi
  */
@@ -44,14 +50,18 @@ class ScriptProcess : public QProcess
 Q_OBJECT
   public:
     /**
-     * You construct a Process Script releted to an item and using the
+     * You construct a Process Script releted to a job and using the
      * base directory as starting path for its log file
      *
-     * @param tree is needed to navigate the project tree and to know the path to give to the log file
-     * @param item is the item related to the script with all its properties
+     * @param job is the description of the script with all its properties
      * @param basedir is the base directory path where to write the log file
      */
-    ScriptProcess(QList<QString> *tree, TreeWidgetItem *item, const QString &basedir);
+    ScriptProcess(const ScriptJob& job, const QString &basedir);
+
+    /**
+     * Kill the script if it's still running
+     */
+    ~ScriptProcess();
 
     /**
      * start running the related process
@@ -59,7 +69,8 @@ Q_OBJECT
     void run();
 
     /**
-     * @returns the temporary file used by Qt to store the temporary log
+     * @returns the temporary file used by Qt to store the temporary log, empty
+     * if the script has never been started
      *
      * You need it instead of using log file directly because you can run the
      * same project more times and in this case the temporary file report just
@@ -68,27 +79,304 @@ Q_OBJECT
      */
     QString tmpFile() const;
 
+    /**
+     * Wait until the output received so far is in the temporary file
+     */
+    void syncTmpFile();
+
     /**
      * @returns the name of the script
      */
     QString name() const;
 
     /**
-     * @returns the number of times the script has to be executed
+     * @returns the number of times the script has to be executed, the warmup runs included
      */
     int times() const;
 
     /**
-     * Assign the TextEdit box to this script to show its temporary log messages
+     * @returns true if the script is executed in benchmark mode
+     */
+    bool isBenchmark() const;
+
+    /**
+     * @returns the statistics of the measured runs when the script is executed in benchmark mode
+     */
+    Benchmark benchmark() const;
+
+    /**
+     * @returns the file with the benchmark results
+     */
+    QString benchmarkFile() const;
+
+    /**
+     * @returns the file with the baseline the benchmark results are compared with
+     */
+    QString baselineFile() const;
+
+    /**
+     * @returns the point number of the script in its sweep, -1 if it's not a sweep point
+     */
+    int taskId() const;
+
+    /**
+     * @returns the values of the sweep point in a readable form, empty if it's not a sweep point
      */
-    void assignConsole(TextEdit* outbox);
+    QString taskLabel() const;
+
+    /**
+     * @returns the file where the outcomes of all the points of the sweep are saved,
+     * empty if it's not a sweep point
+     */
+    QString sweepFile() const;
+
+    /**
+     * @returns the identifier other scripts use to run after this one
+     */
+    QString id() const;
+
+    /**
+     * @returns the identifiers of the scripts that have to end correctly before this one
+     */
+    QStringList dependencies() const;
+
+    /**
+     * @returns the expected execution time in milliseconds, 0 if unknown
+     */
+    qint64 estimate() const;
+
+    /**
+     * @returns the time in milliseconds the script took to execute all its runs
+     */
+    qint64 duration() const;
 
     /**
      * @returns true is the scipt is running
      */
     bool isRunning();
 
+    /**
+     * @returns the return code of the last execution of the script
+     */
+    int returnCode() const;
+
+    /**
+     * @returns the PID of the running execution, 0 if the script is not running
+     */
+    qint64 pid() const;
+
+    /**
+     * @returns the number of times the script has been started in the current run
+     */
+    int executedTimes() const;
+
+    /**
+     * @returns the resources used by the last execution of the script
+     */
+    ResourceUsage usage() const;
+
+    /**
+     * Set the time the script has to end after it has been asked to terminate:
+     * then it's killed
+     *
+     * @param seconds is the grace period
+     */
+    void setGracePeriod(int seconds);
+
+    /**
+     * Set the size limit of the result cache (see \ref ResultCache): it's used
+     * only by the scripts whose results are cached
+     *
+     * @param bytes is the size limit, 0 means that the results are not cached
+     */
+    void setCacheSize(qint64 bytes);
+
+    /**
+     * @returns true if the script has not been executed: its result has been taken from the cache
+     */
+    bool fromCache() const;
+
+    /**
+     * @returns true if the script has been terminated because it ran out of time
+     */
+    bool timedOut() const;
+
+    /**
+     * Terminate the running script because it ran out of time: it's not executed again
+     *
+     * @param reason tells, in the log, which limit has been reached
+     */
+    void timeOut(const QString& reason);
+
+    /**
+     * Terminate the running script: it's killed if it doesn't end within the grace period
+     */
+    void stop();
+
+    /**
+     * Suspend the running script with all its process group (SIGSTOP): the paused time
+     * doesn't count for the timeouts and for the duration. Waiting to run again, or
+     * hashing its inputs before the first run, the next run doesn't start until the
+     * script is resumed
+     *
+     * @returns false if the script is not running, it's already paused or it's being
+     * terminated, or if the system cannot suspend it (Windows)
+     */
+    bool pause();
+
+    /**
+     * Let the paused script go on (SIGCONT)
+     */
+    void resume();
+
+    /**
+     * @returns true if the script has been paused
+     */
+    bool isPaused() const;
+
+    /**
+     * Write to the standard input of the running script. Like QProcess::write()
+     * it doesn't wait for the script: what doesn't fit in the pipe is written
+     * when the script reads
+     *
+     * @param data is the text to send
+     *
+     * @returns the number of bytes written or queued, -1 on error
+     */
+    qint64 sendInput(const QByteArray& data);
+
+  protected:
+#ifndef Q_OS_WIN
+    /**
+     * Make the script started by QProcess the leader of its own process group
+     */
+    void setupChildProcess();
+#endif
+
+  private:
+    /**
+     * Start the script: through the spawn helper if it's running (see \ref SpawnServer),
+     * otherwise with QProcess
+     */
+    void launch();
+
+    /**
+     * Ask the spawn helper to start the script with its standard channels connected
+     * to pipes read by QRunner
+     *
+     * @param params are the script arguments
+     * @param env is the script environment
+     *
+     * @returns false if the helper is not available and QProcess has to be used
+     */
+    bool spawnScript(const QStringList& params, const QStringList& env);
+
+    /**
+     * Close the pipes connected to the script started by the spawn helper
+     */
+    void closeSpawnedChannels();
+
+    /**
+     * Create the log directory and open the log file and the temporary file
+     *
+     * @returns false if a file cannot be opened
+     */
+    bool openLog();
+
+    /**
+     * Append data to the log file and to the temporary file
+     *
+     * @param data is the data to append
+     */
+    void appendLog(const QByteArray& data);
+
+    /**
+     * Close the log file and the temporary file when the script ended
+     */
+    void closeLog();
+
+    /**
+     * Read what the script started by QProcess wrote on a channel
+     *
+     * @param channel is the channel with data to read
+     */
+    void readChannel(QProcess::ProcessChannel channel);
+
+    /**
+     * @returns true if the log buffers are full: the output is not read until they are written
+     */
+    bool logFull() const;
+
+    /**
+     * Stop reading the output of the script until the log buffers are written (see
+     * \ref logDrained()): the pipe slows the script down
+     */
+    void throttleOutput();
+
+    /**
+     * Record the resources used by the execution that just ended into the usage
+     * file and tell it with \ref executed()
+     */
+    void recordUsage();
+
+    /**
+     * Add the execution that just ended to the benchmark statistics: after the
+     * last one the results are compared with the baseline and saved
+     */
+    void recordBenchmark();
+
+    /**
+     * Execute the script for the first time of the run
+     */
+    void execute();
+
+    /**
+     * Save the log and the exit code of the execution into the result cache:
+     * the temporary file is copied, if it fits
+     */
+    void storeResult();
+
+    /**
+     * Ask the running script and its descendants to end (SIGTERM) and kill them
+     * if they don't end within the grace period
+     */
+    void terminateScript();
+
+    /**
+     * @returns the nanoseconds the current execution has been running, without the
+     * time it has been paused
+     */
+    qint64 runTime() const;
+
+    /**
+     * Send a signal to the process group of the script and to the descendants
+     * that left it (Unix only)
+     *
+     * @param signal is the signal to send
+     */
+    void signalScript(int signal);
+
+    /**
+     * The script ended its last execution: close the log and tell how it ended
+     *
+     * @param status is how the last execution ended
+     */
+    void finish(QProcess::ExitStatus status);
+
+    /**
+     * Write the output of the script to the log files as it is and publish it,
+     * decoded, if somebody is connected to \ref outputText()
+     *
+     * @param data is the output of the script: it's not kept after the call
+     * @param error is true if the output comes from the standard error channel
+     */
+    void writeOutput(const QByteArray& data, bool error);
+
   private:
+    /**
+     * The number of bytes read from the script channels at once
+     */
+    static const int ReadSize = 16384;
 
     /**
      * The script name
@@ -101,24 +389,130 @@ Q_OBJECT
     QString m_params;
 
     /**
-     * The log file
+     * The script identifier
      */
-    QFile m_logfile;
+    QString m_id;
 
     /**
-     * The Qt temporary file handler
+     * The point number in the sweep, -1 if it's not a sweep point
      */
-    QTemporaryFile m_tmp;
+    int m_taskId;
+
+    /**
+     * The values of the sweep point
+     */
+    QString m_taskLabel;
+
+    /**
+     * The name of the file with the outcomes of the sweep points
+     */
+    QString m_sweepFileName;
+
+    /**
+     * The identifiers of the scripts that have to end correctly before this one
+     */
+    QStringList m_dependencies;
 
     /**
-     * The Qt temporary file stream
+     * The expected execution time in milliseconds
      */
-    QTextStream m_tmpFile;
+    qint64 m_estimate;
 
     /**
-     * The log file stream
+     * Measure the execution time of the script
      */
-    QTextStream m_outLog;
+    QElapsedTimer m_timer;
+
+    /**
+     * true if the script has been paused
+     */
+    bool m_paused;
+
+    /**
+     * true if the next run has to start when the paused script is resumed
+     */
+    bool m_pendingRun;
+
+    /**
+     * true if the inputs have been hashed while the script was paused: it's
+     * executed, or its result is restored, when it's resumed
+     */
+    bool m_pendingResult;
+
+    /**
+     * Measure the current pause
+     */
+    QElapsedTimer m_pauseTimer;
+
+    /**
+     * The nanoseconds the current execution has been paused
+     */
+    qint64 m_runPaused;
+
+    /**
+     * The nanoseconds the script has been paused since it started its first execution
+     */
+    qint64 m_totalPaused;
+
+    /**
+     * The milliseconds left to the execution timeout when the script has been paused, -1 if none
+     */
+    qint64 m_timeoutLeft;
+
+    /**
+     * The time in milliseconds the script took to execute all its runs
+     */
+    qint64 m_duration;
+
+    /**
+     * The directory of the log file
+     */
+    QString m_logDir;
+
+    /**
+     * The log file name
+     */
+    QString m_logFileName;
+
+    /**
+     * The name of the file with the resources used by each execution: a JSON object per line
+     */
+    QString m_usageFileName;
+
+    /**
+     * The usage file handle of the log writer, -1 if not open
+     */
+    int m_usageLog;
+
+    /**
+     * When the current execution started
+     */
+    QDateTime m_started;
+
+    /**
+     * Measure the elapsed time of the current execution
+     */
+    QElapsedTimer m_runTimer;
+
+    /**
+     * The resources used by the last execution
+     */
+    ResourceUsage m_usage;
+
+    /**
+     * The log file handle of the log writer, -1 if not open
+     */
+    int m_log;
+
+    /**
+     * The Qt temporary file handler
+     */
+    QTemporaryFile m_tmp;
+
+    /**
+     * The temporary file handle of the log writer, -1 if not open
+     */
+    int m_tmpLog;
 
     /**
      * The return code of the executed script
@@ -126,10 +520,80 @@ Q_OBJECT
     int m_code;
 
     /**
-     * The number of times the script has to be executed
+     * The number of times the script has to be executed, the warmup runs included
      */
     int m_times;
 
+    /**
+     * The number of runs before the measured ones, 0 if the script is not executed in benchmark mode
+     */
+    int m_warmup;
+
+    /**
+     * true if the script is executed in benchmark mode
+     */
+    bool m_benchmarkMode;
+
+    /**
+     * The statistics of the measured runs in benchmark mode
+     */
+    Benchmark m_benchmark;
+
+    /**
+     * The name of the file with the benchmark results
+     */
+    QString m_benchmarkFileName;
+
+    /**
+     * The name of the file with the baseline of the benchmark
+     */
+    QString m_baselineFileName;
+
+    /**
+     * true if the result is taken from the cache when the inputs did not change
+     */
+    bool m_cached;
+
+    /**
+     * The files the script reads, part of the inputs of a cached script
+     */
+    QStringList m_inputs;
+
+    /**
+     * The directory of the result cache
+     */
+    QString m_cacheDir;
+
+    /**
+     * The size limit of the result cache in bytes
+     */
+    qint64 m_cacheSize;
+
+    /**
+     * The hash of the inputs of the current run, empty if they cannot be read
+     */
+    QString m_cacheKey;
+
+    /**
+     * The thread hashing the inputs of the current run, 0 if it's not looking for a result
+     */
+    ResultLookup *m_lookup;
+
+    /**
+     * true if the result of the current run has been taken from the cache
+     */
+    bool m_fromCache;
+
+    /**
+     * The log of the result taken from the cache while it's being appended, 0 if none
+     */
+    QFile *m_restore;
+
+    /**
+     * The milliseconds the execution taken from the cache took
+     */
+    qint64 m_restoredDuration;
+
     /**
      * The number of seconds the script has to delay before start again
      */
@@ -141,19 +605,54 @@ Q_OBJECT
     int m_executedTimes;
 
     /**
-     * The running script condition
+     * The longest time in seconds an execution can take, 0 for no limit
      */
-    bool m_running;
+    int m_timeout;
+
+    /**
+     * The longest time in seconds the script can run without output, 0 for no limit
+     */
+    int m_idleTimeout;
+
+    /**
+     * The seconds the script has to end after it has been asked to terminate
+     */
+    int m_gracePeriod;
+
+    /**
+     * Fire when the execution ran out of time
+     */
+    QTimer *m_timeoutTimer;
+
+    /**
+     * Fire when the script could have been without output for too long
+     */
+    QTimer *m_idleTimer;
+
+    /**
+     * Fire when the grace period of a terminated script ended
+     */
+    QTimer *m_killTimer;
+
+    /**
+     * Measure the time since the last output of the script
+     */
+    QElapsedTimer m_lastOutput;
 
     /**
-     * The reference for the TextEdit widget
+     * true if the script has been stopped or timed out: it's not executed again
      */
-    TextEdit *m_outputBox;
+    bool m_stopped;
 
     /**
-     * The reference for the TextEditMonitor widget
+     * true if the script has been terminated because it ran out of time
      */
-    TextEditMonitor *m_mvOut;
+    bool m_timedOut;
+
+    /**
+     * The running script condition
+     */
+    bool m_running;
 
     /**
      * The QProcess status on exit
@@ -171,11 +670,91 @@ Q_OBJECT
     Q_PID m_pid;
 
     /**
-     * The enviroment variables related to the TreeWidgetItem that corresponds to the script
+     * The PID of the running execution measured by the \ref ProcessSampler, 0 if none
+     */
+    qint64 m_processId;
+
+    /**
+     * The enviroment variables of the script: name and value
+     */
+    QList<QPair<QString, QString> > m_environment;
+
+    /**
+     * true if the running script has been started by the spawn helper
+     */
+    bool m_spawned;
+
+    /**
+     * true if the spawned script ended and its orphans are still running in its group
+     */
+    bool m_scriptExited;
+
+    /**
+     * The wait status of the spawned script, kept until its process group ended
+     */
+    int m_waitStatus;
+
+    /**
+     * The orphans of the current execution reaped by the spawn helper
+     */
+    int m_orphans;
+
+    /**
+     * The pipes connected to the script started by the spawn helper: its standard
+     * input (write end), output and error (read ends). -1 if not open
      */
-    QMap<QTreeWidgetItem*, QPair<QString, QString> > m_environment;
+    int m_channels[3];
+
+    /**
+     * Watch the standard input pipe of the script started by the spawn helper
+     * while there is input waiting to be written
+     */
+    QSocketNotifier *m_inNotifier;
+
+    /**
+     * The input sent to the script started by the spawn helper that doesn't fit in the pipe yet
+     */
+    QByteArray m_input;
+
+    /**
+     * Watch the standard output pipe of the script started by the spawn helper
+     */
+    QSocketNotifier *m_outNotifier;
+
+    /**
+     * Watch the standard error pipe of the script started by the spawn helper
+     */
+    QSocketNotifier *m_errNotifier;
+
+    /**
+     * true while the output is not read because the log buffers are full
+     */
+    bool m_throttled;
+
+    /**
+     * The notifiers disabled while the output is not read
+     */
+    QList<QSocketNotifier*> m_throttledNotifiers;
+
+    /**
+     * The decoders of the standard output and error text, created when somebody shows it
+     */
+    QTextDecoder *m_decoders[2];
 
   private slots:
+    /**
+     * Says what to do when the inputs have been hashed: if the result of an
+     * execution with the same inputs has been found, its log is appended and
+     * the script ends with its exit code without being executed
+     */
+    void restoreResult();
+
+    /**
+     * Append the next chunk of the log taken from the cache, as if the script
+     * wrote it: the last one ends the script
+     */
+    void restoreLog();
+
 
     /**
      * Says what to do when the standard output channel gets data
@@ -207,15 +786,74 @@ Q_OBJECT
      */
     void runAgain();
 
+    /**
+     * Terminate the execution that took too long
+     */
+    void executionTimedOut();
+
+    /**
+     * Terminate the script if it has been without output for too long
+     */
+    void checkIdle();
+
+    /**
+     * Kill the script that didn't end within the grace period
+     */
+    void killScript();
+
+    /**
+     * Read the output of the script started by the spawn helper
+     *
+     * @param fd is the pipe with data to read
+     */
+    void readSpawnedOutput(int fd);
+
+    /**
+     * Write the queued input of the script started by the spawn helper, as much
+     * as the pipe takes: on error the standard input of the script is closed
+     */
+    void writeSpawnedInput();
+
+    /**
+     * Read the output again when the log buffers have been written
+     */
+    void logDrained();
+
+    /**
+     * Says what to do when a script started by the spawn helper, or one of its orphans, ended
+     *
+     * @param pid is the PID of the ended program
+     * @param group is the process group of the ended program
+     * @param status is its wait status
+     * @param left is true if the script ended leaving processes running
+     * @param usage is what the program used
+     */
+    void spawnedExited(qint64 pid, qint64 group, int status, bool left, const ResourceUsage& usage);
+
+    /**
+     * Measure with the script an orphan that left its process group: the spawn helper adopted it
+     *
+     * @param pid is the PID of the orphan
+     */
+    void spawnedAdopted(qint64 pid);
+
+    /**
+     * Says what to do when the last process of the group of a spawned script ended
+     *
+     * @param group is the ended process group
+     */
+    void spawnedGroupEnded(qint64 group);
+
   signals:
 
     /**
-     * Emitted when script process ended correctly
+     * Emitted when script process ended correctly: it exited with code 0
      */
     void finishedOK(ScriptProcess*);
 
     /**
-     * Emitted when script process ended not correctly
+     * Emitted when script process ended not correctly: it crashed, exited with an
+     * error code, has been stopped, timed out or, as a benchmark, regressed
      */
     void finishedBad(ScriptProcess*);
 
@@ -223,6 +861,28 @@ Q_OBJECT
      *  Emitted when script process start running
      */
     void running(ScriptProcess*);
+
+    /**
+     * Emitted when an execution of the script ended: \ref usage() tells what it used
+     */
+    void executed(ScriptProcess*);
+
+    /**
+     * Emitted when the script has been paused
+     */
+    void paused(ScriptProcess*);
+
+    /**
+     * Emitted when the paused script goes on
+     */
+    void resumed(ScriptProcess*);
+
+    /**
+     * Emitted when the script wrote something on its standard output or error channel
+     *
+     * @param text is the text written by the script
+     */
+    void outputText(const QString& text);
 };
 
 #endif
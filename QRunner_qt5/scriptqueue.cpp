@@ -19,26 +19,159 @@
 
 #include "scriptqueue.h"
 
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+#include <QtCore/QHash>
 #include <QtCore/QDebug>
 
 ScriptQueue::ScriptQueue(QObject *parent)
    : QObject(parent)
 {
   m_countRunning = 0;
+  m_countQueued = 0;
+  m_countDone = 0;
   m_running = false;
+  m_dispatching = false;
+  m_paused = m_frozen = false;
+  m_countPaused = 0;
+  m_frozenAt = 0;
+
+  // the top level groups run at the same time
+  m_root = new QueueItem(0, 0);
+  m_current = m_root;
+
+  // by default run as many scripts as the CPU cores
+  setMaxParallel(0);
+
+  // a stopped script has 5 seconds to clean up before it's killed
+  m_gracePeriod = 5;
+
+  // the cached results take up to 1 GB
+  m_cacheSize = Q_INT64_C(1024) * 1024 * 1024;
+
+  m_clock.start();
+  m_deadlineTimer = new QTimer(this);
+  m_deadlineTimer->setSingleShot(true);
+  connect(m_deadlineTimer, SIGNAL(timeout()), SLOT(checkDeadlines()));
+}
+
+
+ScriptQueue::~ScriptQueue()
+{
+  clear();
+  delete m_root;
 }
 
 
-void ScriptQueue::add(QList<QString> *list, TreeWidgetItem* item)
+ScriptProcess *ScriptQueue::add(const ScriptJob& job, int node)
 {
-  ScriptProcess *script = new ScriptProcess(list, item, m_basedir);
-  QueueItem *elem = new QueueItem(script, item);
+  ScriptProcess *script = new ScriptProcess(job, m_basedir);
+  script->setGracePeriod(m_gracePeriod);
+  script->setCacheSize(m_cacheSize);
+  QueueItem *elem = new QueueItem(script, node, m_current);
   m_queue.push_back(elem);
+  m_current->m_children.append(elem);
+
+  // the finished scripts and the clicked items are looked for in the indexes
+  m_scripts.insert(script, elem);
+  if (node)
+    m_nodes.insert(node, elem);
 
   // connect the ScriptProcess...
   connect(script, SIGNAL(finishedOK(ScriptProcess*)), SLOT(executedOK(ScriptProcess*)));
   connect(script, SIGNAL(finishedBad(ScriptProcess*)), SLOT(executedBad(ScriptProcess*)));
   connect(script, SIGNAL(running(ScriptProcess*)), SLOT(running(ScriptProcess*)));
+  connect(script, SIGNAL(paused(ScriptProcess*)), SLOT(pausedScript(ScriptProcess*)));
+  connect(script, SIGNAL(resumed(ScriptProcess*)), SLOT(resumedScript(ScriptProcess*)));
+
+  return script;
+}
+
+
+QList<ScriptProcess*> ScriptQueue::addSweep(const ScriptJob& job, int node)
+{
+  QList<ScriptProcess*> scripts;
+  if (job.sweep().isEmpty())
+  {
+    scripts.append(add(job, node));
+    return scripts;
+  }
+
+  // the points run side by side, like the scripts of a parallel group
+  QList<ScriptJob> jobs = job.expandSweep();
+  SweepReport *report = 0;
+  beginGroup(node, 0, 0);
+  for (int i = 0; i < jobs.size(); i++)
+  {
+    ScriptProcess *script = add(jobs.at(i), node);
+    if (!report)
+    {
+      report = new SweepReport(script->sweepFile(), job.name(), jobs.size());
+      m_sweeps.append(report);
+    }
+    m_sweepReports.insert(script, report);
+    scripts.append(script);
+  }
+  endGroup();
+
+  return scripts;
+}
+
+
+SweepReport *ScriptQueue::sweepReport(ScriptProcess* proc) const
+{
+  return m_sweepReports.value(proc, 0);
+}
+
+
+void ScriptQueue::beginGroup(int node, int limit, int timeout)
+{
+  QueueItem *group = new QueueItem(0, node, m_current, limit);
+  group->m_timeout = timeout;
+  m_current->m_children.append(group);
+  m_current = group;
+}
+
+
+void ScriptQueue::endGroup()
+{
+  if (m_current == m_root)
+    // no group to close
+    return;
+
+  QueueItem *group = m_current;
+  m_current = group->parent();
+  if (group->m_children.isEmpty())
+  {
+    // no script to run in this group
+    m_current->m_children.removeOne(group);
+    delete group;
+  }
+}
+
+
+bool ScriptQueue::parseExecutionMode(const QString& mode, int *limit)
+{
+  int value = -1;
+
+  if (mode.isEmpty() || (mode == "parallel"))
+    value = 0;
+  else if (mode == "serial")
+    value = 1;
+  else if (mode.startsWith("parallel:"))
+  {
+    bool ok;
+    int n = mode.mid(9).toInt(&ok);
+    if (ok && (n > 0))
+      value = n;
+  }
+
+  if (value < 0)
+    return false;
+
+  if (limit)
+    *limit = value;
+  return true;
 }
 
 
@@ -54,12 +187,77 @@ int ScriptQueue::countRunning() const
 }
 
 
+int ScriptQueue::countQueued() const
+{
+  return m_countQueued;
+}
+
+
+int ScriptQueue::countDone() const
+{
+  return m_countDone;
+}
+
+
+void ScriptQueue::setMaxParallel(int max)
+{
+  if (max < 1)
+    max = QThread::idealThreadCount();
+
+  // idealThreadCount() returns -1 if it cannot detect the cores
+  m_maxParallel = (max < 1) ? 1 : max;
+}
+
+
+int ScriptQueue::maxParallel() const
+{
+  return m_maxParallel;
+}
+
+
+void ScriptQueue::setGracePeriod(int seconds)
+{
+  m_gracePeriod = qMax(seconds, 0);
+  for (int i = 0; i < m_queue.size(); i++)
+    m_queue.at(i)->script()->setGracePeriod(m_gracePeriod);
+}
+
+
+void ScriptQueue::setCacheSize(qint64 bytes)
+{
+  m_cacheSize = qMax(bytes, (qint64)0);
+  for (int i = 0; i < m_queue.size(); i++)
+    m_queue.at(i)->script()->setCacheSize(m_cacheSize);
+}
+
+
 bool ScriptQueue::isRunning()
 {
   return m_running;
 }
 
 
+void ScriptQueue::setPaused(bool paused)
+{
+  if (m_paused == paused)
+    return;
+
+  m_paused = paused;
+  freezeDeadlines();
+  emit progress(m_countQueued, m_countRunning, m_countDone);
+
+  if (!m_paused)
+    // start the scripts that waited meanwhile
+    dispatch();
+}
+
+
+bool ScriptQueue::isPaused() const
+{
+  return m_paused;
+}
+
+
 void ScriptQueue::clear()
 {
   int index = 0;
@@ -71,29 +269,46 @@ void ScriptQueue::clear()
     delete m_queue.at(index++);
   }
   m_queue.clear();
+  m_scripts.clear();
+  m_nodes.clear();
+  m_sweepReports.clear();
+  qDeleteAll(m_sweeps);
+  m_sweeps.clear();
+  m_timedGroups.clear();
+  m_deadlineTimer->stop();
+  m_countPaused = 0;
+  m_frozen = false;
+
+  // now remove the groups
+  deleteGroups(m_root);
+  m_root->m_children.clear();
+  reset(m_root);
+  m_current = m_root;
 }
 
 
 void ScriptQueue::run()
 {
-  int index = m_countRunning = 0;
+  m_countRunning = m_countDone = 0;
+  m_countQueued = m_queue.size();
 
   m_running = true;
   if (m_queue.isEmpty())
   {
     m_running = false;
     emit allScriptExecuted();
+    return;
   }
 
-  while (index < m_queue.size())
-  {
-    // we don't want to remove the element from the queue, but just to access to it
-    m_script = m_queue.at(index)->script();
-    m_queue.at(index++)->widget()->setRunning();
-
-    m_countRunning++;
-    m_script->run();
-  }
+  // all the scripts wait for a free slot and for their predecessors:
+  // they are started by dispatch()
+  m_timedGroups.clear();
+  m_countPaused = 0;
+  m_frozen = false;
+  freezeDeadlines();
+  reset(m_root);
+  resolveDependencies();
+  dispatch();
 }
 
 
@@ -104,116 +319,544 @@ void ScriptQueue::runLast()
   {
     m_running = false;
     emit allScriptExecuted();
+    return;
   }
 
-  // add the item to the queue and start running it
-  m_script = m_queue.last()->script();
-  m_queue.last()->widget()->setRunning();
+  // the last item was added to the root group: a script, or the group of the
+  //  points of a sweep. Let it wait for a free slot
+  QueueItem *elem = m_root->m_children.last();
+  reset(elem);
+
+  // the user asked to run this script now: don't wait for other scripts
+  QList<QueueItem*> items;
+  items << elem;
+  while (!items.isEmpty())
+  {
+    QueueItem *item = items.takeFirst();
+    if (item->isGroup())
+    {
+      items << item->m_children;
+      continue;
+    }
+    item->m_predecessors.clear();
+    item->m_successors.clear();
+    item->m_blockers = 0;
+    m_countQueued++;
+  }
+  if (m_root->m_state == QueueItem::Done)
+    m_root->m_state = QueueItem::Pending;
+  m_root->m_waiting.append(elem);
+  m_root->m_undone++;
 
-  m_script->run();
+  dispatch();
 }
 
 
-TreeWidgetItem *ScriptQueue::lookforScript(ScriptProcess* proc)
+void ScriptQueue::dispatch()
 {
-  int index = 0;
-  bool found = false;
-  TreeWidgetItem *elem = 0;
+  if (m_dispatching)
+    // the outer loop will start the next scripts
+    return;
+
+  m_dispatching = true;
+  QueueItem *elem;
+  while (!m_paused && (m_countRunning < m_maxParallel) && (elem = nextReady(m_root)))
+  {
+    markStarted(elem);
+    m_script = elem->script();
+
+    m_countQueued--;
+    m_countRunning++;
+    emit progress(m_countQueued, m_countRunning, m_countDone);
+    m_script->run();
+  }
+
+  if (!m_paused && (m_countRunning == 0) && (m_countQueued > 0))
+    // nothing is running and nothing can start: the scripts wait for each other
+    skipBlocked();
+  m_dispatching = false;
+
+  if ((m_countRunning == 0) && (m_countQueued == 0) && m_running)
+  {
+    m_running = false;
+    emit allScriptExecuted();
+  }
+}
+
+
+QueueItem *ScriptQueue::nextReady(QueueItem *group)
+{
+  QueueItem *best = 0;
+  QueueItem *elem;
+
+  // the sub groups already running are already counted in the group limit
+  for (int i = 0; i < group->m_activeGroups.size(); i++)
+  {
+    elem = nextReady(group->m_activeGroups.at(i));
+    if (elem && (!best || (elem->m_rank > best->m_rank)))
+      best = elem;
+  }
+
+  if ((group->m_limit > 0) && (group->m_active >= group->m_limit))
+    // no more items of this group can start now
+    return best;
+
+  for (int i = 0; i < group->m_waiting.size(); i++)
+  {
+    elem = group->m_waiting.at(i);
+    if (elem->isGroup())
+      elem = nextReady(elem);
+    else if (elem->m_blockers > 0)
+      // it's still waiting for its predecessors
+      elem = 0;
+
+    // on the same rank the first item in the tree wins
+    if (elem && (!best || (elem->m_rank > best->m_rank)))
+      best = elem;
+
+    if (group->m_limit == 1)
+      // serial group: just the first item can start
+      break;
+  }
+
+  return best;
+}
+
+
+void ScriptQueue::markStarted(QueueItem *item)
+{
+  item->m_state = QueueItem::Running;
+
+  // the item is active for its group: if the group was not started yet
+  // it becomes active for its parent group too
+  QueueItem *parent;
+  while ((parent = item->parent()))
+  {
+    parent->m_waiting.removeOne(item);
+    parent->m_active++;
+    if (item->isGroup())
+      parent->m_activeGroups.append(item);
+
+    if (parent->m_state != QueueItem::Pending)
+      break;
+
+    parent->m_state = QueueItem::Running;
+    if (parent->m_timeout > 0)
+      // the time of the group starts with its first item
+      startDeadline(parent);
+    item = parent;
+  }
+}
+
+
+void ScriptQueue::markEnded(QueueItem *item, bool started)
+{
+  item->m_state = QueueItem::Done;
 
-  while ((index < m_queue.size()) && (!found))
+  // when all the items of a group ended the group itself ended
+  QueueItem *parent;
+  while ((parent = item->parent()))
   {
-    if (m_queue.at(index)->script() == proc)
+    if (started)
     {
-      found = true;
-      elem = m_queue.at(index)->widget();
+      parent->m_active--;
+      if (item->isGroup())
+        parent->m_activeGroups.removeOne(item);
     }
-    index++;
+    else
+      parent->m_waiting.removeOne(item);
+    parent->m_undone--;
+
+    if (parent->m_undone > 0)
+      break;
+
+    started = (parent->m_state == QueueItem::Running);
+    parent->m_state = QueueItem::Done;
+    item = parent;
   }
+}
 
-  return elem;
+
+void ScriptQueue::skipSuccessors(QueueItem *item)
+{
+  for (int i = 0; i < item->m_successors.size(); i++)
+    skip(item->m_successors.at(i));
 }
 
 
-ScriptProcess *ScriptQueue::lookforWidget(TreeWidgetItem* widget)
+void ScriptQueue::skip(QueueItem *item)
 {
-  int index = 0;
-  bool found = false;
-  ScriptProcess *elem = 0;
+  if (item->m_state != QueueItem::Pending)
+    // already started, ended or skipped
+    return;
+
+  markEnded(item, false);
+  m_countQueued--;
+  m_countDone++;
 
-  while ((index < m_queue.size()) && (!found))
+  // the script has not been executed
+  recordSweep(item->script(), false, true);
+  emit skipped(item->script());
+
+  skipSuccessors(item);
+}
+
+
+void ScriptQueue::resolveDependencies()
+{
+  QMultiHash<QString, QueueItem*> ids;
+  int index;
+
+  for (index = 0; index < m_queue.size(); index++)
   {
-    if (m_queue.at(index)->widget() == widget)
+    QueueItem *elem = m_queue.at(index);
+    elem->m_predecessors.clear();
+    elem->m_successors.clear();
+    elem->m_visit = 0;
+    if (!elem->script()->id().isEmpty())
+      ids.insert(elem->script()->id(), elem);
+  }
+
+  for (index = 0; index < m_queue.size(); index++)
+  {
+    QueueItem *elem = m_queue.at(index);
+    QStringList dependencies = elem->script()->dependencies();
+    for (int i = 0; i < dependencies.size(); i++)
     {
-      found = true;
-      elem = m_queue.at(index)->script();
+      QList<QueueItem*> predecessors = ids.values(dependencies.at(i));
+      if (predecessors.isEmpty())
+        // the script is not in the queue: no need to wait for it
+        qDebug() << elem->script()->name() << "doesn't wait for" << dependencies.at(i) << ": not queued";
+
+      for (int j = 0; j < predecessors.size(); j++)
+      {
+        QueueItem *pred = predecessors.at(j);
+        if ((pred != elem) && !elem->m_predecessors.contains(pred))
+        {
+          elem->m_predecessors.append(pred);
+          pred->m_successors.append(elem);
+        }
+      }
     }
-    index++;
   }
 
-  return elem;
+  // the rank removes the dependencies closing a cycle: count the blockers after it
+  for (index = 0; index < m_queue.size(); index++)
+    computeRank(m_queue.at(index));
+  for (index = 0; index < m_queue.size(); index++)
+    m_queue.at(index)->m_blockers = m_queue.at(index)->m_predecessors.size();
 }
 
 
-bool ScriptQueue::isEmpty()
+qint64 ScriptQueue::computeRank(QueueItem *item)
 {
-  return m_queue.isEmpty();
+  if (item->m_visit == 2)
+    // already computed
+    return item->m_rank;
+
+  item->m_visit = 1;
+  qint64 longest = 0;
+  int i = 0;
+  while (i < item->m_successors.size())
+  {
+    QueueItem *next = item->m_successors.at(i);
+    if (next->m_visit == 1)
+    {
+      // the dependency closes a cycle: the successor cannot wait for this script
+      qDebug() << "dependency cycle between" << item->script()->name() << "and" << next->script()->name();
+      item->m_successors.removeAt(i);
+      next->m_predecessors.removeOne(item);
+      continue;
+    }
+
+    qint64 rank = computeRank(next);
+    if (rank > longest)
+      longest = rank;
+    i++;
+  }
+
+  // a script never executed counts as one second
+  qint64 estimate = item->script()->estimate();
+  item->m_rank = ((estimate > 0) ? estimate : 1000) + longest;
+  item->m_visit = 2;
+
+  return item->m_rank;
 }
 
 
-// SLOTS
-void ScriptQueue::executedOK(ScriptProcess* proc)
+void ScriptQueue::skipBlocked()
 {
-  TreeWidgetItem *item;
+  for (int index = 0; index < m_queue.size(); index++)
+  {
+    if (m_queue.at(index)->m_state == QueueItem::Pending)
+    {
+      qDebug() << m_queue.at(index)->script()->name() << "cannot start: skipped";
+      skip(m_queue.at(index));
+    }
+  }
+}
+
+
+void ScriptQueue::reset(QueueItem *item)
+{
+  item->m_state = QueueItem::Pending;
+  item->m_active = 0;
+  item->m_undone = item->m_children.size();
+  item->m_waiting = item->m_children;
+  item->m_activeGroups.clear();
+
+  for (int i = 0; i < item->m_children.size(); i++)
+    reset(item->m_children.at(i));
+}
+
+
+void ScriptQueue::deleteGroups(QueueItem *group)
+{
+  for (int i = 0; i < group->m_children.size(); i++)
+  {
+    if (group->m_children.at(i)->isGroup())
+    {
+      deleteGroups(group->m_children.at(i));
+      delete group->m_children.at(i);
+    }
+  }
+}
+
+
+QueueItem *ScriptQueue::lookforItem(ScriptProcess* proc)
+{
+  return m_scripts.value(proc, 0);
+}
+
+
+void ScriptQueue::releaseSlot(ScriptProcess* proc, bool ok)
+{
+  QueueItem *elem = lookforItem(proc);
+  if (elem)
+  {
+    markEnded(elem);
+    if (ok)
+    {
+      // the scripts waiting for this one are one step closer to start
+      for (int i = 0; i < elem->m_successors.size(); i++)
+        elem->m_successors.at(i)->m_blockers--;
+    }
+    else
+      // the scripts waiting for this one cannot be executed anymore
+      skipSuccessors(elem);
+  }
 
   m_countRunning--;
-  if ((item = lookforScript(proc)))
+  m_countDone++;
+  emit progress(m_countQueued, m_countRunning, m_countDone);
+  freezeDeadlines();
+
+  // a slot is free: start the next ready script
+  dispatch();
+}
+
+
+void ScriptQueue::startDeadline(QueueItem *group)
+{
+  group->m_deadline = m_clock.elapsed() + 1000 * (qint64)group->m_timeout;
+  m_timedGroups.append(group);
+  scheduleDeadline();
+}
+
+
+void ScriptQueue::scheduleDeadline()
+{
+  qint64 first = -1;
+  for (int i = 0; i < m_timedGroups.size(); i++)
   {
-    // the script finished the execution correctly
-    item->setForeground(0, QBrush("#008000"));
+    if ((first < 0) || (m_timedGroups.at(i)->m_deadline < first))
+      first = m_timedGroups.at(i)->m_deadline;
+  }
 
-    // now you can open the log file with the editor: script ended its execution
-    item->setRunning(false);
-    item->setExecuted();
+  if (first < 0)
+    m_deadlineTimer->stop();
+  else
+    m_deadlineTimer->start(qMax(first - m_clock.elapsed(), (qint64)0));
+}
+
+
+void ScriptQueue::freezeDeadlines()
+{
+  bool frozen = m_paused && (m_countPaused >= m_countRunning);
+  if (frozen == m_frozen)
+    return;
+
+  m_frozen = frozen;
+  if (m_frozen)
+  {
+    m_frozenAt = m_clock.elapsed();
+    m_deadlineTimer->stop();
+    return;
   }
 
-  if (m_countRunning == 0)
+  // the paused time doesn't count: the deadlines are moved forward
+  qint64 paused = m_clock.elapsed() - m_frozenAt;
+  for (int i = 0; i < m_timedGroups.size(); i++)
+    m_timedGroups.at(i)->m_deadline += paused;
+  scheduleDeadline();
+}
+
+
+void ScriptQueue::expireGroup(QueueItem *group)
+{
+  qDebug() << "the group" << group->node() << "timed out after" << group->m_timeout << "s";
+
+  // the waiting scripts are skipped first: the ended ones must not let them start
+  QList<QueueItem*> running;
+  for (int index = 0; index < m_queue.size(); index++)
   {
-    m_running = false;
-    emit allScriptExecuted();
+    QueueItem *elem = m_queue.at(index);
+    QueueItem *parent = elem->parent();
+    while (parent && (parent != group))
+      parent = parent->parent();
+    if (!parent)
+      // not in the group
+      continue;
+
+    if (elem->m_state == QueueItem::Pending)
+      skip(elem);
+    else if (elem->m_state == QueueItem::Running)
+      running.append(elem);
   }
+
+  for (int i = 0; i < running.size(); i++)
+    running.at(i)->script()->timeOut(QString("the group timed out after %1 s").arg(group->m_timeout));
 }
 
 
-void ScriptQueue::executedBad(ScriptProcess* proc)
+void ScriptQueue::recordSweep(ScriptProcess* proc, bool ok, bool skipped)
+{
+  SweepReport *report = m_sweepReports.value(proc, 0);
+  if (!report)
+    return;
+
+  // a point fails like a script: an error code included, a regressed benchmark ended badly
+  RunState::Status status = RunState::Failed;
+  if (skipped)
+    status = RunState::Skipped;
+  else if (proc->timedOut())
+    status = RunState::TimedOut;
+  else if (ok && (proc->returnCode() == 0))
+    status = RunState::Passed;
+
+  double median = -1;
+  if (proc->isBenchmark() && !skipped && (proc->benchmark().wallTime().count > 0))
+    median = proc->benchmark().wallTime().median;
+  report->setOutcome(proc->taskId(), proc->taskLabel(), status, proc->returnCode(), proc->duration(), median);
+
+  if (report->complete() && !report->save())
+    qDebug() << "cannot save the sweep report" << report->fileName();
+}
+
+
+int ScriptQueue::lookforScript(ScriptProcess* proc)
 {
-  TreeWidgetItem *item;
+  QueueItem *elem = lookforItem(proc);
+  return elem ? elem->node() : 0;
+}
 
-  m_countRunning--;
 
-  // something gone wrong during the execution
-  if ((item = lookforScript(proc)))
+ScriptProcess *ScriptQueue::lookforNode(int node)
+{
+  // the most recent item comes first
+  QList<QueueItem*> items = m_nodes.values(node);
+  for (int i = 0; i < items.size(); i++)
   {
-    // the script finished the execution badly
-    item->setForeground(0, QBrush("#FF0000"));
+    if (items.at(i)->m_state == QueueItem::Running)
+      return items.at(i)->script();
+  }
+  return items.isEmpty() ? 0 : items.last()->script();
+}
+
 
-    // now you can open the log file with the editor: script ended its execution
-    item->setRunning(false);
-    item->setExecuted();
+QList<ScriptProcess*> ScriptQueue::runningScripts() const
+{
+  QList<ScriptProcess*> running;
+  for (int i = 0; i < m_queue.size(); i++)
+  {
+    if (m_queue.at(i)->m_state == QueueItem::Running)
+      running.append(m_queue.at(i)->m_scriptProcess);
   }
+  return running;
+}
+
+
+bool ScriptQueue::isEmpty()
+{
+  return m_queue.isEmpty();
+}
+
+
+// SLOTS
+void ScriptQueue::executedOK(ScriptProcess* proc)
+{
+  // the script finished the execution correctly
+  recordSweep(proc, true);
+  emit scriptEnded(proc, true);
+
+  releaseSlot(proc, true);
+}
+
+
+void ScriptQueue::executedBad(ScriptProcess* proc)
+{
+  // something gone wrong during the execution
+  recordSweep(proc, false);
+  emit scriptEnded(proc, false);
+
+  releaseSlot(proc, false);
+}
+
 
-  if (m_countRunning == 0)
+void ScriptQueue::checkDeadlines() // SLOT
+{
+  qint64 now = m_clock.elapsed();
+  int i = 0;
+  while (i < m_timedGroups.size())
   {
-    m_running = false;
-    emit allScriptExecuted();
+    QueueItem *group = m_timedGroups.at(i);
+    if (group->m_state != QueueItem::Running)
+      // ended in time
+      m_timedGroups.removeAt(i);
+    else if (group->m_deadline <= now)
+    {
+      m_timedGroups.removeAt(i);
+      expireGroup(group);
+
+      // skipping the scripts can change the list: start again
+      i = 0;
+    }
+    else
+      i++;
   }
+
+  scheduleDeadline();
 }
 
 
 void ScriptQueue::running(ScriptProcess* proc)
 {
-  TreeWidgetItem* item;
+  // the script started running
+  emit scriptStarted(proc);
+}
+
+
+void ScriptQueue::pausedScript(ScriptProcess* proc)
+{
+  m_countPaused++;
+  freezeDeadlines();
+  emit scriptPaused(proc, true);
+}
 
-  if ((item = lookforScript(proc)))
-    // the script started running
-    item->setForeground(0, QBrush("#DC8600"));
+
+void ScriptQueue::resumedScript(ScriptProcess* proc)
+{
+  m_countPaused--;
+  freezeDeadlines();
+  emit scriptPaused(proc, false);
 }
@@ -22,27 +22,41 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QProcess>
-#include <QtCore/QQueue>
+#include <QtCore/QList>
+#include <QtCore/QHash>
+#include <QtCore/QElapsedTimer>
 
 #include "scriptprocess.h"
-#include "treewidgetitem.h"
+#include "sweep.h"
+
+class QTimer;
 
 /**
- * This class define an item for the scripts queue
+ * This class define an item for the scripts queue. An item is a script or
+ * a group of items: the group decides how many of its children can run at
+ * the same time (see \ref ScriptQueue::parseExecutionMode()). A script can
+ * also wait for other scripts (its predecessors) to end correctly
  *
  * @author Giovanni Venturi
  */
 class QueueItem
 {
+  friend class ScriptQueue;
+
   public:
     /**
      * Create the item to insert into the script queue
      *
-     * @param script is the script to insert in the scripts queue
-     * @param widget is the related TreeWidgetItem of the script
+     * @param script is the script to insert in the scripts queue, 0 if the item is a group
+     * @param node is the related Script Model node of the script, 0 if there is none
+     * @param parent is the group the item belongs to
+     * @param limit is the number of children that can run at the same time if the item
+     *   is a group: 0 means no limit, 1 means that the children run in order one after the other
      */
-    QueueItem(ScriptProcess* script, TreeWidgetItem* widget)
-      { m_scriptProcess = script; m_treeWidgetItem = widget; }
+    QueueItem(ScriptProcess* script, int node, QueueItem* parent = 0, int limit = 0)
+      { m_scriptProcess = script; m_node = node; m_parent = parent; m_limit = limit;
+        m_state = Pending; m_active = 0; m_undone = 0; m_blockers = 0; m_rank = 0; m_visit = 0;
+        m_timeout = 0; m_deadline = 0; }
 
     /**
      * @returns the related Script Process reference
@@ -50,25 +64,120 @@ class QueueItem
     ScriptProcess* script() { return m_scriptProcess; }
 
     /**
-     * @returns the related TreeWidgetItem reference
+     * @returns the related Script Model node, 0 if there is none
+     */
+    int node() const { return m_node; }
+
+    /**
+     * @returns the group the item belongs to
      */
-    TreeWidgetItem* widget() { return m_treeWidgetItem; }
+    QueueItem* parent() { return m_parent; }
+
+    /**
+     * @returns true if the item is a group of items and not a script
+     */
+    bool isGroup() const { return m_scriptProcess == 0; }
 
   private:
+    /**
+     * The scheduling state of the item
+     */
+    enum State {Pending, Running, Done};
+
     /**
      * The Script Process reference
      */
     ScriptProcess* m_scriptProcess;
 
     /**
-     * The TreeWidgetItem reference
+     * The Script Model node
+     */
+    int m_node;
+
+    /**
+     * The group the item belongs to
+     */
+    QueueItem* m_parent;
+
+    /**
+     * The items of the group in tree order
      */
-    TreeWidgetItem* m_treeWidgetItem;
+    QList<QueueItem*> m_children;
+
+    /**
+     * The children of the group not yet started
+     */
+    QList<QueueItem*> m_waiting;
+
+    /**
+     * The children groups started and not yet ended
+     */
+    QList<QueueItem*> m_activeGroups;
+
+    /**
+     * Number of children that can run at the same time: 0 is no limit, 1 is serial
+     */
+    int m_limit;
+
+    /**
+     * The scheduling state
+     */
+    State m_state;
+
+    /**
+     * Number of children started and not yet ended
+     */
+    int m_active;
+
+    /**
+     * Number of children not yet ended
+     */
+    int m_undone;
+
+    /**
+     * The scripts that have to end correctly before this one
+     */
+    QList<QueueItem*> m_predecessors;
+
+    /**
+     * The scripts that wait for this one to end correctly
+     */
+    QList<QueueItem*> m_successors;
+
+    /**
+     * Number of predecessors not yet ended
+     */
+    int m_blockers;
+
+    /**
+     * The expected time to execute this script and the longest chain of its
+     * successors: the ready script with the highest rank starts first
+     */
+    qint64 m_rank;
+
+    /**
+     * Visiting state used to find cycles between the dependencies
+     */
+    int m_visit;
+
+    /**
+     * The longest time in seconds the group can take since its first item started, 0 for no limit
+     */
+    int m_timeout;
+
+    /**
+     * When the running group times out, in milliseconds of the queue clock
+     */
+    qint64 m_deadline;
 };
 
 /**
  * This class define a queue for the scripts, so when the running script process
- * starts this queue is accessed and the script inside the queue is enabled is executed
+ * starts this queue is accessed and the script inside the queue is enabled is executed.
+ * No more than \ref maxParallel() scripts run at the same time: the others wait
+ * to start as soon as a running script ends. The scripts are organized in groups
+ * like in the project tree and each group can run its items in order (serial) or
+ * at the same time (parallel), see \ref beginGroup()
  *
  * @author Giovanni Venturi
  */
@@ -85,25 +194,135 @@ class ScriptQueue : public QObject
     ScriptQueue(QObject *parent= 0);
 
     /**
-     * Add a list of scripts (a group)
+     * Delete all the scripts and the groups of the queue
+     */
+    ~ScriptQueue();
+
+    /**
+     * Add a script to the current group
+     *
+     * @param job is the description of the script to add to the queue
+     * @param node is the script node in the Script Model, it can be 0 if there is no GUI
+     *
+     * @returns the Script Process created to execute the script
+     */
+    ScriptProcess *add(const ScriptJob& job, int node = 0);
+
+    /**
+     * Add a script to the current group, once for each point of its sweep (see
+     * \ref ScriptJob::expandSweep()). The points share the node and they run like
+     * the scripts of a parallel group, within the limit of scripts running at the
+     * same time. A script without sweep is added once
+     *
+     * @param job is the description of the script to add to the queue
+     * @param node is the script node in the Script Model, it can be 0 if there is no GUI
+     *
+     * @returns the Script Processes created to execute the points
+     */
+    QList<ScriptProcess*> addSweep(const ScriptJob& job, int node = 0);
+
+    /**
+     * @returns the outcomes of the sweep a script belongs to, 0 if it's not a sweep point.
+     * The outcome of the script is already in when \ref scriptEnded() or \ref skipped()
+     * are emitted
      *
-     * @param dir is the list of scripts to add to the queue
-     * @param item is the group widget
+     * @param proc is a Script Process of the queue
      */
-    void add(QList<QString> *dir, TreeWidgetItem* item);
+    SweepReport *sweepReport(ScriptProcess* proc) const;
 
     /**
-     * Not yet used. It will be in future versions.
+     * Open a new group inside the current one: the next scripts added with \ref add()
+     * belong to this group until \ref endGroup() is called
      *
+     * @param node is the group node in the Script Model, it can be 0 if there is no GUI
+     * @param limit is the number of items of the group that can run at the same time:
+     *   0 means no limit, 1 means that the items run in order one after the other
+     * @param timeout is the longest time in seconds the group can take since its first
+     *   item started: then its scripts are terminated and the waiting ones skipped. 0 means no limit
+     */
+    void beginGroup(int node, int limit = 0, int timeout = 0);
+
+    /**
+     * Close the current group. An empty group is removed from the queue
+     */
+    void endGroup();
+
+    /**
+     * Parse the group execution mode:
+     *   - "serial": the items run in order one after the other
+     *   - "parallel": the items run at the same time
+     *   - "parallel:N": no more than N items run at the same time
+     *
+     * @param mode is the execution mode as written in the project file
+     * @param limit is where to store the number of items that can run at the same time
+     *   (0 means no limit)
+     *
+     * @returns false if @p mode is not a valid execution mode
+     */
+    static bool parseExecutionMode(const QString& mode, int *limit = 0);
+
+    /**
      * @returns the number of process that are running in the queue
      */
     int countRunning() const;
 
+    /**
+     * @returns the number of process that are waiting for a free slot to start
+     */
+    int countQueued() const;
+
+    /**
+     * @returns the number of process that ended their execution since the last run
+     */
+    int countDone() const;
+
+    /**
+     * Set the maximum number of scripts that can run at the same time
+     *
+     * @param max is the number of slots: if it's less than 1 the number of CPU cores is used
+     */
+    void setMaxParallel(int max);
+
+    /**
+     * @returns the maximum number of scripts that can run at the same time
+     */
+    int maxParallel() const;
+
+    /**
+     * Set the time a script has to end after it has been asked to terminate
+     * (it's stopped or timed out): then it's killed
+     *
+     * @param seconds is the grace period
+     */
+    void setGracePeriod(int seconds);
+
+    /**
+     * Set the size limit of the result cache under the log base directory
+     * (see \ref ResultCache)
+     *
+     * @param bytes is the size limit, 0 means that the results are not cached
+     */
+    void setCacheSize(qint64 bytes);
+
     /**
      * @returns true is the queue is running the scripts processes
      */
     bool isRunning();
 
+    /**
+     * Stop or go on starting the waiting scripts: the running ones are not touched
+     * (see \ref ScriptProcess::pause()). The group timeouts don't count while the
+     * queue and all its running scripts are paused
+     *
+     * @param paused is true to stop starting scripts, false to start them again
+     */
+    void setPaused(bool paused);
+
+    /**
+     * @returns true if the queue doesn't start the waiting scripts
+     */
+    bool isPaused() const;
+
     /**
      * Assign the base directory path to save log files for ScriptProcess class
      */
@@ -121,29 +340,142 @@ class ScriptQueue : public QObject
 
     /**
      * Execute the last element added to the queue. Needed when you want to run just a script
-     * and not all the queue
+     * and not all the queue: all the points of a sweep are executed
      */
     void runLast();
 
     /**
-     * @returns the TreeWidgetItem reference if its related Script Process reference is in the queue else 0
+     * @returns the Script Model node if its related Script Process reference is in the queue else 0
      *
      * @param proc is the Script Process to look for into the queue
      */
-    TreeWidgetItem *lookforScript(ScriptProcess* proc);
+    int lookforScript(ScriptProcess* proc);
 
     /**
-     * @returns the Script Process if its related TreeWidgetItem reference is in the queue else 0
+     * @returns the Script Process if its related Script Model node is in the queue else 0:
+     * the running one, or the first queued, if the node is queued more times
      *
-     * @param proc is the Script Process to look for into the queue
+     * @param node is the Script Model node to look for into the queue
+     */
+    ScriptProcess *lookforNode(int node);
+
+    /**
+     * @returns the scripts that are running now, the paused ones included
      */
-    ScriptProcess *lookforWidget(TreeWidgetItem* widget);
+    QList<ScriptProcess*> runningScripts() const;
 
     /**
      * @returns true is the queue is empty
      */
     bool isEmpty();
 
+  private:
+    /**
+     * Start the pending scripts while there are free slots
+     */
+    void dispatch();
+
+    /**
+     * @returns the script of the group @p group that can start according to the execution
+     *   mode of the group and of its sub groups, with all its predecessors ended and on the
+     *   longest chain of dependencies; 0 if there is no one
+     */
+    QueueItem *nextReady(QueueItem *group);
+
+    /**
+     * Mark the script @p item as running and update the counters of the groups it belongs to
+     */
+    void markStarted(QueueItem *item);
+
+    /**
+     * Mark the item @p item as ended and update the counters of the groups it belongs to
+     *
+     * @param started is false if the item ended without starting (i.e. it has been skipped)
+     */
+    void markEnded(QueueItem *item, bool started = true);
+
+    /**
+     * Skip the scripts waiting for @p item: it ended badly
+     */
+    void skipSuccessors(QueueItem *item);
+
+    /**
+     * Skip the script @p item and all the scripts waiting for it
+     */
+    void skip(QueueItem *item);
+
+    /**
+     * Record the outcome of a sweep point: the report is saved when the last point ends
+     *
+     * @param proc is the Script Process of the point
+     * @param ok is true if the script ended correctly
+     * @param skipped is true if the script has not been executed
+     */
+    void recordSweep(ScriptProcess* proc, bool ok, bool skipped = false);
+
+    /**
+     * Link the scripts in the queue with the scripts they have to wait for
+     * and assign them the rank of their chain of dependencies
+     */
+    void resolveDependencies();
+
+    /**
+     * @returns the rank of @p item computing it from its successors. A dependency
+     *   that closes a cycle is removed
+     */
+    qint64 computeRank(QueueItem *item);
+
+    /**
+     * Skip all the scripts that cannot start anymore: no script is running and the
+     * remaining ones wait for each other (i.e. a serial group waiting for one of its scripts)
+     */
+    void skipBlocked();
+
+    /**
+     * Reset the scheduling state of @p item and of all its children
+     */
+    void reset(QueueItem *item);
+
+    /**
+     * Delete the group @p group and all its sub groups (not the scripts)
+     */
+    void deleteGroups(QueueItem *group);
+
+    /**
+     * Free the slot used by an ended script, start the next pending one and
+     * advise when the whole queue has been executed
+     *
+     * @param proc is the script process that ended its execution
+     * @param ok is false if the script ended badly: the scripts waiting for it are skipped
+     */
+    void releaseSlot(ScriptProcess* proc, bool ok);
+
+    /**
+     * @returns the queue item of the Script Process @p proc, 0 if it's not in the queue
+     */
+    QueueItem *lookforItem(ScriptProcess* proc);
+
+    /**
+     * Start the timeout of a group that just started
+     */
+    void startDeadline(QueueItem *group);
+
+    /**
+     * Wake up at the first deadline of the running groups
+     */
+    void scheduleDeadline();
+
+    /**
+     * Terminate the running scripts of a group that timed out and skip the waiting ones
+     */
+    void expireGroup(QueueItem *group);
+
+    /**
+     * Stop the group deadlines when nothing can go on (the queue and all its running
+     * scripts are paused) and move them forward when something goes on again
+     */
+    void freezeDeadlines();
+
   private:
     /**
      * The generic Process script
@@ -155,6 +487,42 @@ class ScriptQueue : public QObject
      */
     QList<QueueItem*> m_queue;
 
+    /**
+     * The queue items indexed by their Script Process
+     */
+    QHash<ScriptProcess*, QueueItem*> m_scripts;
+
+    /**
+     * The queue items indexed by their Script Model node: a node is queued more
+     * times by a sweep or when it's run again
+     */
+    QMultiHash<int, QueueItem*> m_nodes;
+
+    /**
+     * The sweep reports indexed by the Script Processes of their points
+     */
+    QHash<ScriptProcess*, SweepReport*> m_sweepReports;
+
+    /**
+     * The reports of the queued sweeps
+     */
+    QList<SweepReport*> m_sweeps;
+
+    /**
+     * The root of the groups tree: all the groups run at the same time
+     */
+    QueueItem *m_root;
+
+    /**
+     * The group where \ref add() puts the scripts
+     */
+    QueueItem *m_current;
+
+    /**
+     * Total number of scripts that are waiting to start
+     */
+    int m_countQueued;
+
     /**
      * Assign the base directory path for the log files
      */
@@ -165,15 +533,77 @@ class ScriptQueue : public QObject
      */
     int m_countRunning;
 
+    /**
+     * Total number of scripts that ended their execution
+     */
+    int m_countDone;
+
+    /**
+     * Maximum number of scripts that can run at the same time
+     */
+    int m_maxParallel;
+
+    /**
+     * True while \ref dispatch() is starting scripts: a script can end
+     * immediately (i.e. it cannot open its log file) and you don't want
+     * to start dispatching again from inside the dispatch loop
+     */
+    bool m_dispatching;
+
     /**
      * Running project condition
      */
     bool m_running;
 
+    /**
+     * The seconds a script has to end after it has been asked to terminate
+     */
+    int m_gracePeriod;
+
+    /**
+     * The size limit of the result cache in bytes
+     */
+    qint64 m_cacheSize;
+
+    /**
+     * The clock of the group deadlines
+     */
+    QElapsedTimer m_clock;
+
+    /**
+     * Wake up the queue at the first group deadline
+     */
+    QTimer *m_deadlineTimer;
+
+    /**
+     * The running groups with a timeout
+     */
+    QList<QueueItem*> m_timedGroups;
+
+    /**
+     * true if the queue doesn't start the waiting scripts
+     */
+    bool m_paused;
+
+    /**
+     * Total number of running scripts that are paused
+     */
+    int m_countPaused;
+
+    /**
+     * true while the group deadlines don't count, see \ref freezeDeadlines()
+     */
+    bool m_frozen;
+
+    /**
+     * When the group deadlines stopped counting, on \ref m_clock
+     */
+    qint64 m_frozenAt;
+
   private slots:
     /**
      * Do some operations after the process has finished and it got
-     * no error: change the script color in green
+     * no error: start the scripts waiting for it
      *
      * @param proc the script process that has ended correctly
      */
@@ -181,25 +611,83 @@ class ScriptQueue : public QObject
 
     /**
      * Do some operations after the process has finished and it got
-     * some errors: change the script color in red
+     * some errors: skip the scripts waiting for it
      *
      * @param proc the script process that has ended not correctly
      */
     void executedBad(ScriptProcess* proc);
 
     /**
-     * Do some operations after the process has started: change
-     * the script color in orange
+     * Time out the groups whose deadline passed
+     */
+    void checkDeadlines();
+
+    /**
+     * Do some operations after the process has started: advise
+     * that the script is running
      *
      * @param proc the script process that has started
      */
     void running(ScriptProcess* proc);
 
+    /**
+     * Count the paused script and advise that it's paused
+     *
+     * @param proc the script process that has been paused
+     */
+    void pausedScript(ScriptProcess* proc);
+
+    /**
+     * Count the script that goes on and advise that it's running again
+     *
+     * @param proc the script process that has been resumed
+     */
+    void resumedScript(ScriptProcess* proc);
+
   signals:
+    /**
+     * Emitted when a script started running
+     *
+     * @param proc the script process that has started
+     */
+    void scriptStarted(ScriptProcess* proc);
+
+    /**
+     * Emitted when a script ended its execution
+     *
+     * @param proc the script process that has ended
+     * @param ok is true if the script ended correctly
+     */
+    void scriptEnded(ScriptProcess* proc, bool ok);
+
+    /**
+     * Emitted when a script has not been executed because a script it waits for ended badly
+     *
+     * @param proc the skipped script process
+     */
+    void skipped(ScriptProcess* proc);
+
+    /**
+     * Emitted when a running script has been paused or it goes on
+     *
+     * @param proc the script process
+     * @param paused is true if the script has been paused
+     */
+    void scriptPaused(ScriptProcess* proc, bool paused);
+
     /**
      * Emitted when all scripts processes has been executed
      */
     void allScriptExecuted();
+
+    /**
+     * Emitted when a script is started or ended
+     *
+     * @param queued is the number of scripts waiting for a free slot
+     * @param running is the number of running scripts
+     * @param done is the number of executed scripts
+     */
+    void progress(int queued, int running, int done);
 };
 
 #endif
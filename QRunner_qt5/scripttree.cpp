@@ -22,20 +22,23 @@
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QActionGroup>
+#include <QtWidgets/QInputDialog>
+#include <QtWidgets/QToolTip>
 
 #include <QtGui/QMouseEvent>
 #include <QtGui/QDesktopServices>
 #include <QtGui/QDrag>
-
-#include <QtXml/QDomDocument>
-#include <QtXml/QDomElement>
+#include <QtGui/QHelpEvent>
 
 #include <QtCore/QString>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
 #include <QtCore/QFileInfoList>
 #include <QtCore/QFile>
-#include <QtCore/QTextStream>
+#include <QtCore/QSaveFile>
+#include <QtCore/QXmlStreamWriter>
+#include <QtCore/QTimer>
 #include <QtCore/QUrl>
 #include <QtCore/QSettings>
 #include <QtCore/QMimeData>
@@ -46,21 +49,108 @@
   #include <unistd.h>
 #endif
 
-#include "treewidgetitem.h"
+#include "scriptmodel.h"
 #include "scripttree.h"
 #include "scriptconf.h"
 #include "scriptqueue.h"
+#include "scriptprocess.h"
+#include "scriptjob.h"
+#include "projectreader.h"
 #include "textedit.h"
+#include "texteditmonitor.h"
+#include "settings.h"
+#include "processsampler.h"
+#include "benchmark.h"
+
+/**
+ * This class builds the Script Model while the project file is read
+ */
+class TreeLoader : public ProjectReader
+{
+  public:
+    /**
+     * Create the loader of the project tree
+     *
+     * @param model is the Script Model where to add groups and scripts
+     */
+    TreeLoader(ScriptModel *model) : m_model(model), m_current(ScriptModel::Root) {}
+
+  protected:
+    void beginGroup(const QString& name, bool checked, const QString& mode, int timeout);
+    void endGroup();
+    void addScript(const QString& fileName, bool checked, const ScriptJob& job);
+
+  private:
+    /**
+     * The Script Model to build
+     */
+    ScriptModel *m_model;
+
+    /**
+     * The group where to add the new nodes
+     */
+    int m_current;
+};
+
+
+void TreeLoader::beginGroup(const QString& name, bool checked, const QString& mode, int timeout)
+{
+  int group = m_model->addGroup(m_current, name, checked);
+  if (!mode.isEmpty())
+    m_model->setExecutionMode(group, mode);
+  m_model->setTimeout(group, timeout);
+
+  // the next nodes belong to the new group
+  m_current = group;
+}
+
+
+void TreeLoader::endGroup()
+{
+  m_current = m_model->parentNode(m_current);
+}
+
+
+void TreeLoader::addScript(const QString& fileName, bool checked, const ScriptJob& job)
+{
+  int script = m_model->addFile(m_current, job.name(), checked);
+  m_model->setFileName(script, fileName);
+  m_model->setTimes(script, job.times());
+  m_model->setDelay(script, job.delay());
+  m_model->setBenchmark(script, job.benchmark());
+  m_model->setWarmup(script, job.warmup());
+  m_model->setTimeout(script, job.timeout());
+  m_model->setIdleTimeout(script, job.idleTimeout());
+  m_model->setCached(script, job.cached());
+  m_model->setInputs(script, job.inputs());
+  m_model->setSweep(script, job.sweep());
+  m_model->setParameters(script, job.parameters());
+
+  // the dependencies between the scripts
+  m_model->setScriptId(script, job.id());
+  m_model->setDependencies(script, job.dependencies());
+  m_model->setEstimate(script, job.estimate());
+
+  m_model->setEnvironment(script, job.environment());
+}
 
 ScriptTree::ScriptTree(TextEdit *outputBox, QWidget *parent)
-  : QTreeWidget(parent), m_outputBox(outputBox)
+  : QTreeView(parent), m_outputBox(outputBox)
 {
   m_modified = false;
   m_localAction = false;
+  m_draggingNode = ScriptModel::Root;
   enableDND();
 
+  // the view shows the project kept by the model
+  m_model = new ScriptModel(this);
+  setModel(m_model);
+  connect(m_model, SIGNAL(modified()), SLOT(itemModified()));
+
+  // all the rows have the same height: the view doesn't measure each of them
+  setUniformRowHeights(true);
+
   header()->hide();
-  m_root = 0;
   setToolTip( tr("<p>Here you can <b>drop</b> files that will "
                  "be your executable script.</p><p>You can "
                  "<b>create/delete</b> script groups.</p><p> You can "
@@ -74,6 +164,18 @@ ScriptTree::ScriptTree(TextEdit *outputBox, QWidget *parent)
 
   // connect signal
   connect(m_scriptQueue, SIGNAL(allScriptExecuted()), SIGNAL(readyToRun()));
+  connect(m_scriptQueue, SIGNAL(progress(int,int,int)), SLOT(showQueueProgress(int,int,int)));
+  connect(m_scriptQueue, SIGNAL(scriptStarted(ScriptProcess*)), SLOT(scriptStarted(ScriptProcess*)));
+  connect(m_scriptQueue, SIGNAL(scriptEnded(ScriptProcess*,bool)), SLOT(scriptEnded(ScriptProcess*,bool)));
+  connect(m_scriptQueue, SIGNAL(skipped(ScriptProcess*)), SLOT(scriptSkipped(ScriptProcess*)));
+  connect(m_scriptQueue, SIGNAL(scriptPaused(ScriptProcess*,bool)), SLOT(scriptPaused(ScriptProcess*,bool)));
+
+  // the outcomes are saved while the scripts run: an interrupted execution can be resumed
+  m_stateTimer = new QTimer(this);
+  m_stateTimer->setSingleShot(true);
+  m_stateTimer->setInterval(1000);
+  connect(m_stateTimer, SIGNAL(timeout()), SLOT(saveRunState()));
+  connect(m_scriptQueue, SIGNAL(allScriptExecuted()), SLOT(saveRunState()));
 
   m_relatedProcess = NULL;
 }
@@ -81,6 +183,8 @@ ScriptTree::ScriptTree(TextEdit *outputBox, QWidget *parent)
 
 ScriptTree::~ScriptTree()
 {
+  // the scripts still queued or running are the ones to resume
+  m_runState.save();
   m_scriptQueue->clear();
   delete m_scriptQueue;
 }
@@ -101,25 +205,22 @@ bool ScriptTree::isExecutable(const QString &exe)
 
 void ScriptTree::clean()
 {
-  if (m_root)
-  {
-    clear();
-    m_root = 0;
-    m_modified = false;
+  m_model->clear();
+  m_modified = false;
 
-    // remove the allocated resource
-    if (!m_XMLProjectDoc)
-      delete m_XMLProjectDoc;
+  // a new project has no outcomes: they are kept in memory until it's saved
+  m_runState.save();
+  m_stateTimer->stop();
+  m_runState.reset();
 
-    // need to remove all queued item too
-    m_scriptQueue->clear();
-  }
+  // need to remove all queued item too
+  m_scriptQueue->clear();
 }
 
 
 bool ScriptTree::modified()
 {
-  if (m_root)
+  if (m_model->childCount(ScriptModel::Root))
     return m_modified;
   else
     return false;
@@ -128,106 +229,7 @@ bool ScriptTree::modified()
 
 void ScriptTree::resetModified()
 {
-  if (m_root)
-    m_modified = false;
-}
-
-
-bool ScriptTree::checkSubprojectFile(QDomNode *node) const
-{
-  QDomNode *subnode = new QDomNode( node->firstChild() );
-  bool error = false;
-
-  while(!subnode->isNull() && !error)
-  {
-    if(subnode->isElement())
-    {
-      // get the QDomElement item
-      QDomElement elem = subnode->toElement();
-
-      if (elem.tagName() == "subgroup")
-      {
-        if ((elem.hasAttribute("checked")) && (elem.hasAttribute("name")))
-        {
-          if ((elem.attribute("checked") != "true") && (elem.attribute("checked") != "false"))
-            error = true;
-          else
-          { // ok the syntax is correct
-
-            // check again recursively starting from the new subnode
-            error = !checkSubprojectFile( subnode );
-          }
-        }
-        else
-          error = true;
-      }
-      else if (elem.tagName() == "file")
-      {
-        if ((elem.hasAttribute("path")) && (elem.hasAttribute("checked")) && (elem.hasAttribute("name")))
-        {
-          QDir file;
-          file.setPath( elem.attribute("path") );
-
-          // don't consider files that don't exist anymore
-          if (file.exists())
-          {
-            if ((elem.attribute("checked") != "true") && (elem.attribute("checked") != "false"))
-              error = true;
-          }
-        }
-        else
-          error = true;
-      }
-      else
-        error = true;
-    }
-    *subnode = subnode->nextSibling();
-  }
-  delete subnode;
-
-  return !error;
-}
-
-
-bool ScriptTree::checkProjectFile(const QString& filename) const
-{
-  // check if you got problem loading the XML Project file into QDomDocument
-  QDomDocument doc("project");
-  QFile file(filename);
-  if (!file.open(QIODevice::ReadOnly))
-    return false;
-  if (!doc.setContent(&file))
-  {
-    file.close();
-    return false;
-  }
-  file.close();
-
-  // now check if the tags are recognized correctly and if the XML file structure respect QRunner specifics
-  QDomElement docElem = doc.documentElement();
-  QDomNode *node = new QDomNode( docElem.firstChild() );
-  bool error = false;
-  while(!node->isNull() && !error)
-  {
-    if(node->isElement())
-    {
-      QDomElement elem = node->toElement();  // gets the element
-      if ((elem.tagName() != "group") || (!elem.hasAttribute("checked")) || (!elem.hasAttribute("name")))
-        error = true;
-      else
-      {
-        if ((elem.attribute("checked") != "true") && (elem.attribute("checked") != "false"))
-          error = true;
-        else
-          // in the "group" element we can have "subgroup" ones
-          error = !checkSubprojectFile(node);
-      }
-    }
-    *node = node->nextSibling();
-  }
-  delete node;
-
-  return !error;
+  m_modified = false;
 }
 
 
@@ -237,40 +239,29 @@ bool ScriptTree::loadProject(const QString& filename)
     // no project file selected
     return false;
 
-  // check if you got problem with the XML Project file
-  if (!checkProjectFile(filename))
-  {
-    QMessageBox::critical(0, tr("Parse Error"),
-      tr("<p>You cannot load this project.<br>The file doesn't fit the QRunner Project format!"));
-    return false;
-  }
-
   // remove Tree and set variable to "no modify"
   clean();
 
-  QDomDocument doc("project");
-  QFile file(filename);
-  doc.setContent(&file);
-  file.close();
-  QDomElement docElem = doc.documentElement();
-  QDomNode *node = new QDomNode( docElem.firstChild() );
-  int index = 0;
-  while(!node->isNull())
+  // the loader builds the tree while it's reading the XML Project file:
+  //  the view is updated just once at the end
+  TreeLoader loader(m_model);
+  m_model->beginLoad();
+  bool loaded = loader.read(filename);
+  m_model->endLoad();
+  if (!loaded)
   {
-    if(node->isElement())
-    {
-      QDomElement elem = node->toElement();  // gets the element
-      if (elem.attribute("checked") == "true")
-        createNewGroup( elem.attribute("name"), true );
-      else
-        createNewGroup( elem.attribute("name"), false );
-
-      // in the "group" element we can have "subgroup" ones
-      parseSubgroup(node, topLevelItem(index++));
-    }
-    *node = node->nextSibling();
+    // remove what has been built
+    clean();
+    QMessageBox::critical(0, tr("Parse Error"),
+      tr("<p>You cannot load this project.<br>%1").arg(loader.errorString().toHtmlEscaped()));
+    return false;
   }
-  delete node;
+  expandAll();
+
+  // show how the scripts ended the last time
+  if (!m_runState.load(RunState::fileFor(filename)))
+    emit showStatusMessage(tr("Cannot read the last outcome of the scripts."));
+  showRunState(ScriptModel::Root);
 
   // the project was just loaded, than nothing was modifyed
   m_modified = false;
@@ -282,55 +273,41 @@ bool ScriptTree::loadProject(const QString& filename)
 
 bool ScriptTree::saveProjectTree(const QString& filename)
 {
-  bool result;
-  m_XMLProjectDoc = new QDomDocument;
-  QDomElement root = m_XMLProjectDoc->createElement( "project" );
+  // the old project file is replaced only when the new one is completely written
+  QSaveFile file( filename );
+  if ( !file.open( QIODevice::WriteOnly ) )
+  {
+    QMessageBox::critical(0, tr("Writing Error"),
+      tr("Could not open file '%1' for writing").arg(filename));
+    return false;
+  }
+
+  // the elements are written while the tree is visited: no document is built
+  QXmlStreamWriter xml( &file );
+  xml.setAutoFormatting( true );
+  xml.setAutoFormattingIndent( 1 );
+  xml.writeStartDocument();
+  xml.writeStartElement( "project" );
 
   // add the QRunner project XML file version
-  root.setAttribute( "version", "1.0" );
+  xml.writeAttribute( "version", "1.0" );
 
-  m_XMLProjectDoc->appendChild( root );
+  saveProjectTree(ScriptModel::Root, xml);
 
-  for (int i = 0; i < topLevelItemCount(); i++)
-  {
-    QDomElement *subroot = new QDomElement (m_XMLProjectDoc->createElement( "group" ));
-    QDomAttr *attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "name" ) );
-    attr->setValue( topLevelItem(i)->text(0) );
-    subroot->setAttributeNode( *attr );
-    delete attr;
-
-    attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "checked" ));
-    if (((TreeWidgetItem *)topLevelItem(i))->checked())
-      attr->setValue( "true" );
-    else
-      attr->setValue( "false" );
-    subroot->setAttributeNode( *attr );
-    delete attr;
-
-    root.appendChild( *subroot );
-    if (topLevelItem(i)->child(0))
-      // append the new tree we found
-      saveProjectTree(topLevelItem(i), subroot);
-    delete subroot;
-  }
-  QString xml = "<?xml version=\"1.0\" ?>\n";
-  xml.append( m_XMLProjectDoc->toString() );
-  QFile file( filename );
-  if ( file.open( QIODevice::WriteOnly ) )
-  {
-    QTextStream stream( &file );
-    stream << xml;
-    file.close();
-    result = true;
-  }
-  else
+  xml.writeEndElement();
+  xml.writeEndDocument();
+  if (xml.hasError() || !file.commit())
   {
     QMessageBox::critical(0, tr("Writing Error"),
-      tr("Could not open temporary file '%1' for writing").arg(filename));
-    result = false;
+      tr("An error occurred writing '%1': %2").arg(filename).arg(file.errorString()));
+    return false;
   }
 
-  return result;
+  // the outcomes follow the project file
+  if (m_runState.fileName() != RunState::fileFor(filename))
+    m_runState.saveAs(RunState::fileFor(filename));
+
+  return true;
 }
 
 
@@ -350,345 +327,343 @@ void ScriptTree::enableDND(const bool& cond)
 }
 
 
-TreeWidgetItem *ScriptTree::draggingItem()
+int ScriptTree::draggingNode() const
 {
-  return m_draggingItem;
+  return m_draggingNode;
 }
 
 
-// Private members
+ScriptModel *ScriptTree::scriptModel() const
+{
+  return m_model;
+}
 
-TreeWidgetItem *ScriptTree::addFile( QTreeWidgetItem *item, const QString& filename, bool checked, const QString& absoluteFilePath, int times, int delay, const QString& params)
-{
-  // adding script reading a project file (no by drag and drop)
-  TreeWidgetItem *fileItem = new TreeWidgetItem(absoluteFilePath);
-  fileItem->setFile(times, delay);
-  fileItem->setChecked(checked);
-  fileItem->setTimes(times);
-  fileItem->setDelay(delay);
-  fileItem->setParameters(params);
-  fileItem->setForeground(0, QColor(0, 0, 0));
-  fileItem->setFileName( filename );
-  item->addChild(fileItem);
-  expandItem(item);
-  fileItem->setText(0, filename);
-  fileItem->setToolTip( 0, absoluteFilePath );
-  m_modified = true;
 
-  // give the reference to the added script File
-  return fileItem;
+// Private members
+
+int ScriptTree::nodeAt(const QPoint& pos) const
+{
+  // no item here: the root
+  return m_model->node(indexAt(pos));
 }
 
 
-void ScriptTree::createNewSubGroup( const QString& name, bool checked )
+void ScriptTree::createGroup( int parent, const QString& name, bool checked )
 {
-  TreeWidgetItem *subgroup = new TreeWidgetItem;
-  subgroup->setGroup();
-  subgroup->setChecked(checked);
-  itemAt(m_event->pos())->addChild(subgroup);
-  expandItem(itemAt(m_event->pos()));
+  int group = m_model->addGroup(parent, name, checked);
+  if (parent != ScriptModel::Root)
+    expand(m_model->indexOf(parent));
   if (name.isEmpty())
-    editItem(subgroup);
-  else
-    subgroup->setText(0, name);
+    edit(m_model->indexOf(group));
   m_modified = true;
   emit modifiedProject();
 }
 
 
-void ScriptTree::setScriptTreeColor(const QString& color)
-{
-  for (int i = 0; i < topLevelItemCount(); i++)
-  {
-    topLevelItem(i)->setForeground(0, QBrush(color, Qt::SolidPattern));
-    if (topLevelItem(i)->child(0))
-      setScriptSubtreeColor(topLevelItem(i));
-  }
-}
-
-
-void ScriptTree::setScriptSubtreeColor(QTreeWidgetItem *top, const QString& color)
+void ScriptTree::saveProjectTree(int top, QXmlStreamWriter& xml)
 {
-  for (int i = 0; i < top->childCount(); i++)
+  // write all the childs of the tree root element
+  for (int i = 0; i < m_model->childCount(top); i++)
   {
-    top->child(i)->setForeground(0, QBrush(color, Qt::SolidPattern));
-    if (top->child(i)->child(0))
-      setScriptSubtreeColor(top->child(i));
-  }
-}
-
+    int node = m_model->child(top, i);
+    if (m_model->isGroup(node))
+    {
+      // the groups contain sub groups
+      xml.writeStartElement( (top == ScriptModel::Root) ? "group" : "subgroup" );
+      xml.writeAttribute( "name", m_model->name(node) );
+      xml.writeAttribute( "checked", m_model->checked(node) ? "true" : "false" );
 
-void ScriptTree::saveProjectTree(QTreeWidgetItem *top, QDomElement *root)
-{
-  if (!root)
-    // cannot append to NULL
-    return;
+      if (m_model->executionMode(node) != "parallel")
+        // don't need to save this attribute value if it is the default one
+        xml.writeAttribute( "mode", m_model->executionMode(node) );
 
-  QDomElement subroot;
+      if (m_model->timeout(node) > 0)
+        // no limit by default
+        xml.writeAttribute( "timeout", QString::number(m_model->timeout(node)) );
 
-  // append all the childs to the tree root element
-  for (int i = 0; i < top->childCount(); i++)
-  {
-    if (((TreeWidgetItem *)top->child(i))->isGroup())
-    {
-      subroot = m_XMLProjectDoc->createElement( "subgroup" );
-      QDomAttr *attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "name" ) );
-      attr->setValue( top->child(i)->text(0) );
-      subroot.setAttributeNode( *attr );
-      delete attr;
-
-      attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "checked" ) );
-      if (((TreeWidgetItem *)top->child(i))->checked())
-        attr->setValue( "true" );
-      else
-        attr->setValue( "false" );
-      subroot.setAttributeNode( *attr );
-      delete attr;
+      saveProjectTree(node, xml);
     }
     else
     {
-      subroot = m_XMLProjectDoc->createElement( "file" );
-
-      QDomAttr *attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "checked" ));
-      if (((TreeWidgetItem *)top->child(i))->checked())
-        attr->setValue( "true" );
-      else
-        attr->setValue( "false" );
-      subroot.setAttributeNode( *attr );
-      delete attr;
-
-      attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "path" ) );
-      attr->setValue( ((TreeWidgetItem *)top->child(i))->filePath() );
-      subroot.setAttributeNode( *attr );
-      delete attr;
-
-      attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "name" ) );
-      attr->setValue( ((TreeWidgetItem *)top->child(i))->fileName() );
-      subroot.setAttributeNode( *attr );
-      delete attr;
+      xml.writeStartElement( "file" );
+      xml.writeAttribute( "checked", m_model->checked(node) ? "true" : "false" );
+      xml.writeAttribute( "path", m_model->filePath(node) );
+      xml.writeAttribute( "name", m_model->fileName(node) );
 
-      if (((TreeWidgetItem *)top->child(i))->times() > 1)
-      {
+      if (m_model->times(node) > 1)
         // don't need to save this attribute value if it is equal to 1
-        attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "times" ) );
-        attr->setValue( QString::number(((TreeWidgetItem *)top->child(i))->times()) );
-        subroot.setAttributeNode( *attr );
-        delete attr;
-      }
+        xml.writeAttribute( "times", QString::number(m_model->times(node)) );
 
-      if (((TreeWidgetItem *)top->child(i))->delay() > 0)
-      {
+      if (m_model->delay(node) > 0)
         // don't need to save this attribute value if it is equal to 0
-        attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "delay" ) );
-        attr->setValue( QString::number(((TreeWidgetItem *)top->child(i))->delay()) );
-        subroot.setAttributeNode( *attr );
-        delete attr;
-      }
+        xml.writeAttribute( "delay", QString::number(m_model->delay(node)) );
 
-      if (!((TreeWidgetItem *)top->child(i))->parameters().isEmpty())
+      if (m_model->benchmark(node))
       {
-        // don't need to save this attribute value if it is equal to 1
-        attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "parameters" ) );
-        attr->setValue( ((TreeWidgetItem *)top->child(i))->parameters() );
-        subroot.setAttributeNode( *attr );
-        delete attr;
+        // the default is the normal mode without warmup runs
+        xml.writeAttribute( "benchmark", "true" );
+        if (m_model->warmup(node) > 0)
+          xml.writeAttribute( "warmup", QString::number(m_model->warmup(node)) );
       }
 
-      // save the Environment data
-      if (!((TreeWidgetItem *)top->child(i))->environment().isEmpty())
-      {
-        QDomElement tag = m_XMLProjectDoc->createElement( "environment" );
-        subroot.appendChild( tag );
+      if (m_model->timeout(node) > 0)
+        // no limit by default
+        xml.writeAttribute( "timeout", QString::number(m_model->timeout(node)) );
 
-        QMapIterator<QTreeWidgetItem*, QPair<QString, QString> > iterator(((TreeWidgetItem *)top->child(i))->environment());
-        while (iterator.hasNext())
-        {
-          iterator.next();
-
-          // how many "env" as the number of environment variables we have
-          QDomElement subtag = m_XMLProjectDoc->createElement( "env" );
-          tag.appendChild( subtag );
-
-          // variable name
-          attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "name" ) );
-          attr->setValue( iterator.value().first );
-          subtag.setAttributeNode( *attr );
-          delete attr;
-
-          // variable value
-          attr = new QDomAttr( m_XMLProjectDoc->createAttribute( "value" ) );
-          attr->setValue( iterator.value().second );
-          subtag.setAttributeNode( *attr );
-          delete attr;
-        }
-      }
-    }
-    root->appendChild( subroot );
+      if (m_model->idleTimeout(node) > 0)
+        xml.writeAttribute( "idletimeout", QString::number(m_model->idleTimeout(node)) );
 
-    if (top->child(i)->child(0))
-      saveProjectTree(top->child(i), &subroot);
-  }
-}
+      if (m_model->cached(node))
+        // the results are not cached by default
+        xml.writeAttribute( "cache", "true" );
 
+      if (!m_model->parameters(node).isEmpty())
+        xml.writeAttribute( "parameters", m_model->parameters(node) );
 
-void ScriptTree::parseSubgroup(QDomNode *node, QTreeWidgetItem *item)
-{
-  QDomNode *subnode = new QDomNode( node->firstChild() );
+      if (!m_model->scriptId(node).isEmpty())
+        // the identifier used by the scripts that have to run after this one
+        xml.writeAttribute( "id", m_model->scriptId(node) );
 
-  while(!subnode->isNull())
-  {
-    if(subnode->isElement())
-    {
-      QDomElement elem = subnode->toElement();  // gets the element
-      if (elem.tagName() == "subgroup")
+      if (!m_model->dependencies(node).isEmpty())
+        // the scripts that have to end correctly before this one
+        xml.writeAttribute( "after", m_model->dependencies(node).join(",") );
+
+      if (m_model->estimate(node) > 0)
+        // the last execution time: the scripts on the longest chain start first
+        xml.writeAttribute( "estimate", QString::number(m_model->estimate(node)) );
+
+      // save the Environment data
+      QList< QPair<QString, QString> > environment = m_model->environment(node);
+      if (!environment.isEmpty())
       {
-        createNewSubGroup( item, elem.attribute("name"),
-          (elem.attribute("checked") == "true") );
-
-        // jump into the children widgets to get the current sub group widget just created with createNewSubGroup member.
-        // Use the recursion to parse the deeper level of the sub group into the XML file.
-        // This procedure creates the widget tree items while it's parsing the XML file with the QDomElement class.
-        // XML file is complete. The tree widget is created at run time.
-        int i = 0;
-        while (item->child(++i) != NULL)
-          ;
-        parseSubgroup( subnode, item->child(--i) );
+        xml.writeStartElement( "environment" );
+
+        // how many "env" as the number of environment variables we have
+        for (int j = 0; j < environment.size(); j++)
+        {
+          xml.writeEmptyElement( "env" );
+          xml.writeAttribute( "name", environment.at(j).first );
+          xml.writeAttribute( "value", environment.at(j).second );
+        }
+
+        xml.writeEndElement();
       }
-      else if (elem.tagName() == "file")
+
+      // save the parameter sweep: one axis for each element
+      Sweep sweep = m_model->sweep(node);
+      if (!sweep.isEmpty())
       {
-        QDir file;
-        file.setPath( elem.attribute("path") );
+        xml.writeStartElement( "sweep" );
+        if (sweep.mode() != Sweep::Product)
+          // don't need to save this attribute value if it is the default one
+          xml.writeAttribute( "mode", Sweep::modeName(sweep.mode()) );
 
-        // don't add to the tree file that doesn't exist anymore
-        if (file.exists())
+        for (int j = 0; j < sweep.axisCount(); j++)
         {
-          TreeWidgetItem *newScript = 0;
-          int times = 1;
-          if (!elem.attribute("times").isEmpty())
-            times = elem.attribute("times").toInt();
-
-          int delay = 0;
-          if (!elem.attribute("delay").isEmpty())
-            delay = elem.attribute("delay").toInt();
-
-          newScript = addFile( item, elem.attribute("name"),
-            (elem.attribute("checked") == "true"),
-            file.absoluteFilePath(elem.attribute("name")), times, delay,
-            elem.attribute("parameters") );
-
-          // parse the environment part if found
-          if (subnode->hasChildNodes())
+          if (sweep.axisName(j).isEmpty())
+            xml.writeStartElement( "parameters" );
+          else
           {
-            // "file" tag has children
-            if (subnode->firstChild().isElement())
-            {
-              // is the first child "environment"?
-              if (subnode->firstChild().toElement().tagName() == "environment")
-              {
-                // ok now get all the variables + values
-                QDomNode *envNode = new QDomNode( subnode->firstChild().firstChild() );
-                while (!envNode->isNull())
-                {
-                  if(envNode->isElement())
-                  {
-                    QDomElement envElem = envNode->toElement();  // gets the element
-                    if (envElem.tagName() == "env")
-                    {
-                      // add the new enviroment in the related item
-                      newScript->createEnvironmentItem(envElem.attribute("name"), envElem.attribute("value"));
-                    }
-                  }
-                  emit newEnvironmentItemAdded(newScript);
-                  *envNode = envNode->nextSibling();
-                }
-                delete envNode;
-              }
-            }
+            xml.writeStartElement( "env" );
+            xml.writeAttribute( "name", sweep.axisName(j) );
           }
+
+          QStringList values = sweep.axisValues(j);
+          for (int k = 0; k < values.size(); k++)
+            xml.writeTextElement( "value", values.at(k) );
+          xml.writeEndElement();
+        }
+        xml.writeEndElement();
+      }
+
+      // save the files read by the script
+      QStringList inputs = m_model->inputs(node);
+      if (!inputs.isEmpty())
+      {
+        xml.writeStartElement( "inputs" );
+        for (int j = 0; j < inputs.size(); j++)
+        {
+          xml.writeEmptyElement( "input" );
+          xml.writeAttribute( "path", inputs.at(j) );
         }
+        xml.writeEndElement();
       }
     }
-    *subnode = subnode->nextSibling();
+    xml.writeEndElement();
   }
-  delete subnode;
 }
 
 
-void ScriptTree::addProjectSubTree(QTreeWidgetItem *item)
+void ScriptTree::addProjectSubTree(int node, RunState::Selection selection)
 {
-  if (((TreeWidgetItem *)item)->isFile())
+  if (m_model->isFile(node))
   {
-    if (((TreeWidgetItem *)item)->checked())
-    {
-      // now look for the parents so to understand the dir/subdirs the file is in
-      QTreeWidgetItem *item0;
-      QList<QString> lifo;
-      item0 = item;
-      while (item0->parent() != NULL)
-      {
-        lifo.push_back(item0->parent()->text(0));
-        item0 = item0->parent();
-      }
-
+    if (m_model->checked(node))
       // now add the script to the queue
-      m_scriptQueue->add(&lifo, (TreeWidgetItem *)item);
-    }
+      queueScript(node, selection);
   }
   else
-    for (int i = 0; i < item->childCount(); i++)
+  {
+    // the group runs its scripts according to its execution mode
+    int limit = 0;
+    ScriptQueue::parseExecutionMode(m_model->executionMode(node), &limit);
+    m_scriptQueue->beginGroup(node, limit, m_model->timeout(node));
+
+    for (int i = 0; i < m_model->childCount(node); i++)
     {
-      if (((TreeWidgetItem *)item->child(i))->checked())
+      int child = m_model->child(node, i);
+      if (m_model->checked(child))
       {
         // you can run the tree
-        if (((TreeWidgetItem *)item->child(i))->isGroup())
+        if (m_model->isGroup(child))
         {
-          if (item->child(i)->child(0))
-            addProjectSubTree(item->child(i));
+          if (m_model->childCount(child))
+            addProjectSubTree(child, selection);
         }
         else
-        {
-          // now look for the parents so to understand the dir/subdirs the file is in
-          QTreeWidgetItem *item0;
-          QList<QString> lifo;
-          item0 = item;
-          lifo.push_back(item0->text(0));
-          while (item0->parent() != NULL)
-          {
-            lifo.push_back(item0->parent()->text(0));
-            item0 = item0->parent();
-          }
-
           // now add the script to the queue
-          m_scriptQueue->add(&lifo, (TreeWidgetItem *)item->child(i));
-        }
+          queueScript(child, selection);
       }
     }
+
+    m_scriptQueue->endGroup();
+  }
 }
 
 
-void ScriptTree::showConsole(ScriptProcess* process)
+void ScriptTree::queueScript(int node, RunState::Selection selection)
 {
-  // read the temporary file and put it into the m_outputBox
-  QString line;
-  QFile file(process->tmpFile());
+  ScriptJob job = createJob(node);
+  QString key = RunState::key(job);
+  if (!m_runState.selects(key, selection))
+    // it doesn't need to run again
+    return;
 
-  if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  // a sweep queues the script once for each point
+  QList<ScriptProcess*> procs = m_scriptQueue->addSweep(job, node);
+  if (procs.isEmpty())
     return;
+  setRunStatus(node, RunState::Queued);
+
+  // the script has been dropped into the Monitor View: show its output there too
+  if (m_model->textEditMonitor(node))
+  {
+    for (int i = 0; i < procs.size(); i++)
+      connect(procs.at(i), SIGNAL(outputText(QString)), m_model->textEditMonitor(node), SLOT(appendOutput(QString)));
+    m_model->textEditMonitor(node)->monitorProcess(procs.first());
+  }
+}
+
+
+ScriptJob ScriptTree::createJob(int node) const
+{
+  ScriptJob job;
+  job.setName(m_model->assignedName(node));
+  job.setParameters(m_model->parameters(node));
+  job.setTimes(m_model->times(node));
+  job.setDelay(m_model->delay(node));
+  job.setBenchmark(m_model->benchmark(node));
+  job.setWarmup(m_model->warmup(node));
+  job.setTimeout(m_model->timeout(node));
+  job.setIdleTimeout(m_model->idleTimeout(node));
+  job.setCached(m_model->cached(node));
+  job.setInputs(m_model->inputs(node));
+  job.setSweep(m_model->sweep(node));
+  job.setId(m_model->scriptId(node));
+  job.setDependencies(m_model->dependencies(node));
+  job.setEstimate(m_model->estimate(node));
+
+  QList< QPair<QString, QString> > environment = m_model->environment(node);
+  for (int i = 0; i < environment.size(); i++)
+    job.addEnvironment(environment.at(i).first, environment.at(i).second);
+
+  // now look for the parents so to understand the dir/subdirs the file is in
+  QStringList groups;
+  int parent = m_model->parentNode(node);
+  while (parent > ScriptModel::Root)
+  {
+    groups.prepend(m_model->name(parent));
+    parent = m_model->parentNode(parent);
+  }
+  job.setLogPath(groups);
+
+  return job;
+}
 
-  QTextStream in(&file);
-  while (!in.atEnd())
-    line += in.readLine() + "\n";
+
+void ScriptTree::showConsole(ScriptProcess* process)
+{
+  // read the temporary file and put it into the m_outputBox: the log
+  //  writer thread has to write what the script sent so far
+  process->syncTmpFile();
 
   m_outputBox->show();
-  m_outputBox->setText(line);
+  m_outputBox->attachFile(process->tmpFile());
   m_outputBox->assignScriptProcess(process);
-  process->assignConsole(m_outputBox);
+}
+
+
+void ScriptTree::setExecutionMode(int node, const QString& mode)
+{
+  if ((node == ScriptModel::Root) || (m_model->executionMode(node) == mode))
+    return;
+
+  m_model->setExecutionMode(node, mode);
+  m_modified = true;
+  emit modifiedProject();
+}
+
+
+void ScriptTree::loadQueueSettings()
+{
+  QSettings settings(ORGANIZATION_NAME, APPLICATION_NAME);
+
+  // 0 means as many scripts as the CPU cores
+  m_scriptQueue->setMaxParallel(settings.value("maxparallel", 0).toInt());
+
+  // 0 means that the console keeps ConsoleView::MaxScrollback lines, the most it can keep
+  m_outputBox->setScrollback(settings.value("scrollback", 100000).toInt());
+
+  // 0 means that the running scripts are not measured
+  ProcessSampler::instance()->setInterval(settings.value("sampleinterval", 1000).toInt());
+
+  // the time a stopped or timed out script has before it's killed
+  m_scriptQueue->setGracePeriod(settings.value("killgrace", 5).toInt());
+
+  // the size limit of the cached results, in MB
+  m_scriptQueue->setCacheSize(settings.value("cachesize", 1024).toLongLong() * 1024 * 1024);
 }
 
 
 
 // Protected members
 
+bool ScriptTree::viewportEvent(QEvent *event)
+{
+  if (event->type() == QEvent::ToolTip)
+  {
+    // a running script tells what it's using
+    QHelpEvent *help = static_cast<QHelpEvent*>(event);
+    int node = nodeAt(help->pos());
+    ScriptProcess *proc = 0;
+    ProcessSampler::Sample sample;
+    if (m_model->isFile(node) && (proc = m_scriptQueue->lookforNode(node)) != 0 &&
+        ProcessSampler::instance()->sample(proc->pid(), &sample))
+    {
+      QToolTip::showText(help->globalPos(),
+        tr("CPU %1%, RSS %2 MiB, %3 threads, %4 processes")
+          .arg(sample.cpu, 0, 'f', 1)
+          .arg(sample.rss / 1048576.0, 0, 'f', 1)
+          .arg(sample.threads)
+          .arg(sample.processes), viewport());
+      return true;
+    }
+  }
+
+  return QTreeView::viewportEvent(event);
+}
+
+
 void ScriptTree::dragEnterEvent(QDragEnterEvent *event)
 {
   if (event->mimeData()->hasFormat("text/plain"))
@@ -698,7 +673,8 @@ void ScriptTree::dragEnterEvent(QDragEnterEvent *event)
 
 void ScriptTree::dragMoveEvent(QDragMoveEvent *event)
 {
-  if (itemAt(event->pos()) == NULL)
+  int node = nodeAt(event->pos());
+  if (node == ScriptModel::Root)
   {
     // you cannot drop here
     event->setDropAction(Qt::IgnoreAction);
@@ -706,17 +682,17 @@ void ScriptTree::dragMoveEvent(QDragMoveEvent *event)
   }
   else
   {
-    if (((TreeWidgetItem*)itemAt(event->pos()))->isGroup())
+    if (m_model->isGroup(node))
     {
       // if the file is not yet in the group you can add it here
       int i = 0;
       bool found = false;
-      while ((i < itemAt(event->pos())->childCount()) && !found)
+      while ((i < m_model->childCount(node)) && !found)
       {
         if (m_localAction)
-          found = ((TreeWidgetItem*)itemAt(event->pos())->child(i++))->name() == event->mimeData()->text();
+          found = m_model->name(m_model->child(node, i++)) == event->mimeData()->text();
         else
-          found = ((TreeWidgetItem*)itemAt(event->pos())->child(i++))->assignedName() == event->mimeData()->text();
+          found = m_model->assignedName(m_model->child(node, i++)) == event->mimeData()->text();
       }
 
       if (!found)
@@ -756,44 +732,24 @@ void ScriptTree::dragMoveEvent(QDragMoveEvent *event)
 
 void ScriptTree::dropEvent(QDropEvent *event)
 {
-  QTreeWidgetItem *selectedItem = itemAt(event->pos());
+  int group = nodeAt(event->pos());
   if (event->mimeData()->hasText())
   {
-    if (itemAt(event->pos()) != NULL)
+    if (group != ScriptModel::Root)
     {
       // you can add a file script just to a group
-      if (((TreeWidgetItem*)selectedItem)->isGroup())
+      if (m_model->isGroup(group))
       {
         if (m_localAction)
         {
-          TreeWidgetItem* itemA = static_cast<TreeWidgetItem*>(itemAt(m_dragStartPosition));
-          TreeWidgetItem* itemB = static_cast<TreeWidgetItem*>(selectedItem);
-          if (itemA->isFile())
+          // the file, or the group with all its items, is moved into the group
+          if (m_model->moveNode(m_draggingNode, group))
           {
-            itemA->parent()->takeChild(itemA->parent()->indexOfChild(itemA));
-            itemB->addChild(itemA);
-            expandItem(itemB);
+            expand(m_model->indexOf(m_draggingNode));
+            expand(m_model->indexOf(group));
             emit groupSelected();
-//            m_localAction = false;  // the drop comes from File System Tree
-          }
-          else if (itemA->isGroup())
-          {
-            TreeWidgetItem* newItem;
-            if (m_localAction && (itemA != itemB) )
-            {
-              // just if action is local and not referred to the same folder as source and destination
-              newItem = new TreeWidgetItem( itemA->text(0) );
-              newItem->setGroup();
-              newItem->addChildren( itemA->takeChildren() );
-              itemB->addChild( newItem );
-              delete itemA;
-
-              expandItem( newItem );
-              expandItem( itemB );
-              emit groupSelected();
-//              m_localAction = false;  // the drop comes from File System Tree
-            }
           }
+//          m_localAction = false;  // the drop comes from File System Tree
         }
         else
         {
@@ -806,22 +762,12 @@ void ScriptTree::dropEvent(QDropEvent *event)
 
             QFileInfoList list = dir.entryInfoList();
             for (int i = 0; i < list.size(); ++i)
-            {
-              QFileInfo fileInfo = list.at(i);
-              TreeWidgetItem *item = new TreeWidgetItem(fileInfo.absoluteFilePath());
-              item->setFile();
-              selectedItem->addChild(item);
-              expandItem(selectedItem);
-            }
+              m_model->addFile(group, list.at(i).absoluteFilePath());
           }
           else
-          {
             // it's a simple file not a directory: added
-            TreeWidgetItem *item = new TreeWidgetItem(event->mimeData()->text());
-            item->setFile();
-            selectedItem->addChild(item);
-            expandItem(selectedItem);
-          }
+            m_model->addFile(group, event->mimeData()->text());
+          expand(m_model->indexOf(group));
         }
         m_modified = true;
         emit modifiedProject();
@@ -835,24 +781,20 @@ void ScriptTree::dropEvent(QDropEvent *event)
 void ScriptTree::mousePressEvent(QMouseEvent *event)
 {
   ScriptProcess* process;
-  if ((event->button() == Qt::LeftButton) && (itemAt(event->pos()) != NULL))
+  int node = nodeAt(event->pos());
+  if ((event->button() == Qt::LeftButton) && (node != ScriptModel::Root))
   {
-    m_statebefore = itemAt(event->pos())->checkState(0);
-    if (((TreeWidgetItem *)itemAt(event->pos()))->isFile())
+    if (m_model->isFile(node))
     {
-      if ((process = m_scriptQueue->lookforWidget((TreeWidgetItem *)itemAt(event->pos()))))
+      if ((process = m_scriptQueue->lookforNode(node)))
       {
-        // virtually remove the connections for the current process output to the m_outputBox
-        if (m_outputBox->process())
-          m_outputBox->process()->assignConsole(0);
-
         // if the file is a script that's running or it's been stopped than show its console
         showConsole(process);
 
         if (!process->isRunning())
         {
           // clicked on file while the script is not running: show configuration options
-          emit fileSelected((TreeWidgetItem *)itemAt(event->pos()));
+          emit fileSelected(node);
         }
         else
         {
@@ -867,7 +809,7 @@ void ScriptTree::mousePressEvent(QMouseEvent *event)
         m_outputBox->hide();
 
         // clicked on file: show configuration options
-        emit fileSelected((TreeWidgetItem *)itemAt(event->pos()));
+        emit fileSelected(node);
       }
     }
     else
@@ -878,20 +820,17 @@ void ScriptTree::mousePressEvent(QMouseEvent *event)
       emit groupSelected();
     }
 
-    if (event->button() == Qt::LeftButton)
-    {
-      // annotate the position and the name of the item where you left clicked
-      m_dragStartPosition = event->pos();
-      m_draggingItem = ((TreeWidgetItem *)itemAt(event->pos()));
-      m_data = m_draggingItem->text(0);
-    }
+    // annotate the position and the name of the item where you left clicked
+    m_dragStartPosition = event->pos();
+    m_draggingNode = node;
+    m_data = m_model->name(node);
   }
   else
   {
     hideConsole();
     emit nothingSelected();
   }
-  QTreeWidget::mousePressEvent(event);
+  QTreeView::mousePressEvent(event);
 }
 
 
@@ -915,60 +854,52 @@ void ScriptTree::mouseMoveEvent(QMouseEvent *event)
 }
 
 
-void ScriptTree::mouseReleaseEvent(QMouseEvent *event)
-{
-  QTreeWidget::mouseReleaseEvent(event);
-  if ((event->button() == Qt::LeftButton) && (itemAt(event->pos()) != NULL))
-  {
-    Qt::CheckState stateafter = itemAt(event->pos())->checkState(0);
-    if ((m_statebefore == Qt::Unchecked) && (stateafter == Qt::Checked))
-      ((TreeWidgetItem *)itemAt(event->pos()))->setChecked();
-
-    else if ((m_statebefore == Qt::Checked) && (stateafter == Qt::Unchecked))
-      ((TreeWidgetItem *)itemAt(event->pos()))->setChecked(false);
-
-    if (stateafter != m_statebefore)
-    {
-      // the check was changed
-      m_modified = true;
-      emit modifiedProject();
-    }
-  }
-}
-
-
 void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
 {
   QMenu menu(this);
-  TreeWidgetItem* item = (TreeWidgetItem*)itemAt(event->pos());
+  int node = nodeAt(event->pos());
   if (m_scriptQueue->isRunning())
   {
-    if (item->isGroup())
-    {
-    }
-    else
+    if ((node != ScriptModel::Root) && m_model->isFile(node))
     {
       // clicked on a script
-      if (item->running())
+      if (m_model->running(node))
       {
-        m_relatedProcess = m_scriptQueue->lookforWidget(item);
+        m_relatedProcess = m_scriptQueue->lookforNode(node);
         QAction *stopScript = new QAction(tr("&Stop this script"), this);
         stopScript->setStatusTip(tr("Stop running this script"));
         connect(stopScript, SIGNAL(triggered()), this, SLOT(stopScript()));
 
         menu.addAction(stopScript);
+
+#ifndef Q_OS_WIN
+        if (m_relatedProcess->isPaused())
+        {
+          QAction *resumeScript = new QAction(tr("&Resume this script"), this);
+          resumeScript->setStatusTip(tr("Let this paused script go on"));
+          connect(resumeScript, SIGNAL(triggered()), this, SLOT(resumeScript()));
+          menu.addAction(resumeScript);
+        }
+        else
+        {
+          QAction *pauseScript = new QAction(tr("&Pause this script"), this);
+          pauseScript->setStatusTip(tr("Suspend this script with all its processes"));
+          connect(pauseScript, SIGNAL(triggered()), this, SLOT(pauseScript()));
+          menu.addAction(pauseScript);
+        }
+#endif
         menu.exec(event->globalPos());
       }
       else
       {
-        if (item->executed())
+        if (m_model->executed(node))
         {
           QAction *showLogFile = new QAction(tr("&Show the Log file"), this);
           showLogFile->setStatusTip(tr("Show the related Log file with a text editor"));
           connect(showLogFile, SIGNAL(triggered()), this, SLOT(showLogFile()));
           menu.addAction(showLogFile);
 
-          if (item->checked())
+          if (m_model->checked(node))
           {
             QAction* runScript = new QAction(tr("&Run this script again"), this);
             runScript->setStatusTip(tr("Run this script again"));
@@ -988,17 +919,16 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
   {
     QAction *runScript;
 
-    if (item != NULL)
+    if (node != ScriptModel::Root)
     {
-      if (item->isGroup())
+      if (m_model->isGroup(node))
       {
-        m_event = event;
         QAction *delGroup = new QAction(tr("&Delete the group"), this);
         delGroup->setStatusTip(tr("Remove the group from the project"));
         connect(delGroup, SIGNAL(triggered()), this, SLOT(deleteItem()));
 
         // you can create a new subgroup when you click on a group: not on a file
-        if ( (item->child(0) == NULL) || ((item->child(0) != NULL) && (((TreeWidgetItem*)item)->isGroup())) )
+        if ( !m_model->childCount(node) || m_model->isGroup(m_model->child(node, 0)) )
         {
           QAction *newSubGroup = new QAction(tr("&Create a new sub group"), this);
           newSubGroup->setStatusTip(tr("Create a new script sub group to add to the project"));
@@ -1008,7 +938,39 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
         }
 
         menu.addAction(delGroup);
-        if (item->checked())
+
+        // how the group items have to be executed
+        int limit = 0;
+        ScriptQueue::parseExecutionMode(m_model->executionMode(node), &limit);
+        QMenu *modeMenu = menu.addMenu(tr("&Execution mode"));
+        QActionGroup *modeGroup = new QActionGroup(modeMenu);
+
+        QAction *serialMode = new QAction(tr("&Serial: one script after the other"), modeGroup);
+        serialMode->setStatusTip(tr("Run the group items in order, one after the other"));
+        serialMode->setCheckable(true);
+        serialMode->setChecked(limit == 1);
+        connect(serialMode, SIGNAL(triggered()), this, SLOT(setSerialMode()));
+
+        QAction *parallelMode = new QAction(tr("&Parallel: all the scripts together"), modeGroup);
+        parallelMode->setStatusTip(tr("Run the group items at the same time"));
+        parallelMode->setCheckable(true);
+        parallelMode->setChecked(limit == 0);
+        connect(parallelMode, SIGNAL(triggered()), this, SLOT(setParallelMode()));
+
+        QAction *limitedMode = new QAction(tr("Parallel, &at most..."), modeGroup);
+        limitedMode->setStatusTip(tr("Run at the same time no more than a number of group items"));
+        limitedMode->setCheckable(true);
+        limitedMode->setChecked(limit > 1);
+        connect(limitedMode, SIGNAL(triggered()), this, SLOT(setLimitedParallelMode()));
+
+        modeMenu->addActions(modeGroup->actions());
+
+        QAction *groupTimeout = new QAction(tr("Set the &timeout..."), this);
+        groupTimeout->setStatusTip(tr("Terminate the group scripts if the group takes too long"));
+        connect(groupTimeout, SIGNAL(triggered()), this, SLOT(setGroupTimeout()));
+        menu.addAction(groupTimeout);
+
+        if (m_model->checked(node))
         {
           runScript = new QAction(tr("&Run this script folder"), this);
           runScript->setStatusTip(tr("Run this script folder with all subfolders"));
@@ -1018,12 +980,20 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
       }
       else
       {
-        if (item->executed())
+        if (m_model->executed(node))
         {
           QAction *showLogFile = new QAction(tr("&Show the Log file"), this);
           showLogFile->setStatusTip(tr("Show the related Log file with a text editor"));
           connect(showLogFile, SIGNAL(triggered()), this, SLOT(showLogFile()));
           menu.addAction(showLogFile);
+
+          if (m_model->benchmark(node) && m_scriptQueue->lookforNode(node))
+          {
+            QAction *saveBaseline = new QAction(tr("Use the benchmark results as &baseline"), this);
+            saveBaseline->setStatusTip(tr("Compare the next benchmarks of this script with the last one"));
+            connect(saveBaseline, SIGNAL(triggered()), this, SLOT(saveBaseline()));
+            menu.addAction(saveBaseline);
+          }
         }
 
         QAction *delFile = new QAction(tr("&Delete the script"), this);
@@ -1031,7 +1001,7 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
         connect(delFile, SIGNAL(triggered()), this, SLOT(deleteItem()));
         menu.addAction(delFile);
 
-        if (item->checked())
+        if (m_model->checked(node))
         {
           runScript = new QAction(tr("&Run this script"), this);
           runScript->setStatusTip(tr("Run this script"));
@@ -1046,7 +1016,7 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
     else
     {
       // there is at least one group
-      if (topLevelItemCount())
+      if (m_model->childCount(ScriptModel::Root))
       {
         QAction *runProject = new QAction(tr("Run all folders scripts"), this);
         runProject->setStatusTip(tr("Run all the project folders scripts"));
@@ -1054,6 +1024,15 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
 
         // adding menu
         menu.addAction(runProject);
+
+        // just the scripts that need it, according to their last outcome
+        QMenu *againMenu = menu.addMenu(tr("Run &again"));
+        QAction *runFailed = againMenu->addAction(tr("The &failed scripts"), this, SLOT(runFailedScripts()));
+        runFailed->setStatusTip(tr("Run the scripts that failed or timed out the last time"));
+        QAction *runNotRun = againMenu->addAction(tr("The scripts &not run yet"), this, SLOT(runNotRunScripts()));
+        runNotRun->setStatusTip(tr("Run the scripts that have never been executed or have been skipped"));
+        QAction *runInterrupted = againMenu->addAction(tr("The &interrupted run"), this, SLOT(runInterruptedScripts()));
+        runInterrupted->setStatusTip(tr("Run the scripts that were queued or running when the last execution stopped"));
       }
 
       QAction *newGroup = new QAction(tr("&Create a new group"), this);
@@ -1098,44 +1077,36 @@ void ScriptTree::contextMenuEvent(QContextMenuEvent *event)
 // Slot
 void ScriptTree::createNewGroup( const QString& name, bool checked )
 {
-  if (m_root == 0)
-  {
-    m_root = new TreeWidgetItem;
-    m_root->setGroup();
-    addTopLevelItem( m_root );
-    m_root->setChecked(checked);
-    if (name.isEmpty())
-      editItem(m_root);
-    else
-      m_root->setText(0, name);
-  }
+  createGroup(ScriptModel::Root, name, checked);
+}
+
+
+// SLOT
+void ScriptTree::saveBaseline()
+{
+  ScriptProcess *proc = m_scriptQueue->lookforNode(nodeAt(m_pointerPosition));
+  if (!proc)
+    return;
+
+  if (Benchmark::saveBaseline(proc->benchmarkFile(), proc->baselineFile()))
+    emit showStatusMessage(tr("The next benchmarks of %1 are compared with the last one.").arg(QFileInfo(proc->name()).fileName()));
   else
-  {
-    TreeWidgetItem *group = new TreeWidgetItem;
-    group->setGroup();
-    addTopLevelItem( group );
-    group->setChecked(checked);
-    if (name.isEmpty())
-      editItem(group);
-    else
-      group->setText(0, name);
-  }
-  m_modified = true;
-  emit modifiedProject();
+    QMessageBox::critical(0, tr("Writing Error"),
+      tr("Could not copy the benchmark results '%1' to '%2'").arg(proc->benchmarkFile()).arg(proc->baselineFile()));
 }
 
 
 // SLOT
 void ScriptTree::showLogFile()
 {
-  TreeWidgetItem* item = ((TreeWidgetItem*)itemAt(m_pointerPosition));
-  TreeWidgetItem* parent = ((TreeWidgetItem*)item->parent());
+  int node = nodeAt(m_pointerPosition);
+  int parent = m_model->parentNode(node);
   QStringList list;
-  list << item->fileName();
-  while (parent != NULL)
+  list << m_model->fileName(node);
+  while (parent > ScriptModel::Root)
   {
-    list << parent->name();
-    parent = (TreeWidgetItem*)parent->parent();
+    list << m_model->name(parent);
+    parent = m_model->parentNode(parent);
   }
   QString fullpath = m_basedir;
   int i = list.size();
@@ -1154,17 +1125,15 @@ void ScriptTree::showLogFile()
 
 
 // Slot
-void ScriptTree::createNewSubGroup( QTreeWidgetItem *item, const QString& subgroupname, bool checked )
-{
-  TreeWidgetItem *subgroup = new TreeWidgetItem;
-  subgroup->setGroup();
-  subgroup->setChecked(checked);
-  item->addChild(subgroup);
-  expandItem(item);
-  if (subgroupname.isEmpty())
-    editItem(subgroup);
-  else
-    subgroup->setText(0, subgroupname);
+void ScriptTree::createNewSubGroup( const QString& name, bool checked )
+{
+  createGroup(nodeAt(m_pointerPosition), name, checked);
+}
+
+
+// Slot
+void ScriptTree::itemModified()
+{
   m_modified = true;
   emit modifiedProject();
 }
@@ -1173,8 +1142,8 @@ void ScriptTree::createNewSubGroup( QTreeWidgetItem *item, const QString& subgro
 // Slot
 void ScriptTree::deleteItem()
 {
-  delete itemAt(m_pointerPosition);
-  if (topLevelItemCount())
+  m_model->removeNode(nodeAt(m_pointerPosition));
+  if (m_model->childCount(ScriptModel::Root))
   {
     // there are more elements available
     m_modified = true;
@@ -1200,7 +1169,7 @@ void ScriptTree::runScript()
 
   // queue the scripts
   m_scriptQueue->clear();
-  addProjectSubTree(itemAt(m_pointerPosition));
+  addProjectSubTree(nodeAt(m_pointerPosition));
 
   // now we can execute the queued scripts
   if (m_scriptQueue->isEmpty())
@@ -1211,28 +1180,108 @@ void ScriptTree::runScript()
   }
   else
   {
-    // set the default color for the tree widgets
-    setScriptTreeColor();
+    // set the default color for the tree items
+    m_model->resetStates();
 
     // advise that the script is going to start
     emit runningScript();
 
+    loadQueueSettings();
     m_scriptQueue->run();
   }
 }
 
 
+// Slot
+void ScriptTree::setSerialMode()
+{
+  setExecutionMode(nodeAt(m_pointerPosition), "serial");
+}
+
+
+// Slot
+void ScriptTree::setParallelMode()
+{
+  setExecutionMode(nodeAt(m_pointerPosition), "parallel");
+}
+
+
+// Slot
+void ScriptTree::setLimitedParallelMode()
+{
+  int node = nodeAt(m_pointerPosition);
+  int limit = 0;
+  ScriptQueue::parseExecutionMode(m_model->executionMode(node), &limit);
+
+  bool ok;
+  limit = QInputDialog::getInt(this, tr("Execution mode"),
+    tr("Number of scripts of the group that can run at the same time:"),
+    (limit > 1) ? limit : 2, 1, 1024, 1, &ok);
+  if (ok)
+    setExecutionMode(node, (limit == 1) ? QString("serial") : QString("parallel:%1").arg(limit));
+}
+
+
+// Slot
+void ScriptTree::setGroupTimeout()
+{
+  int node = nodeAt(m_pointerPosition);
+
+  bool ok;
+  int timeout = QInputDialog::getInt(this, tr("Group timeout"),
+    tr("Seconds the group can take before its scripts are terminated (0 for no limit):"),
+    m_model->timeout(node), 0, 7 * 24 * 3600, 60, &ok);
+  if (ok && (timeout != m_model->timeout(node)))
+  {
+    m_model->setTimeout(node, timeout);
+    m_modified = true;
+    emit modifiedProject();
+  }
+}
+
+
 // Slot
 void ScriptTree::stopScript()
 {
-  m_relatedProcess->kill();
+  m_relatedProcess->stop();
+}
+
+
+// Slot
+void ScriptTree::pauseScript()
+{
+  if (!m_relatedProcess->pause())
+    emit showStatusMessage(tr("The script cannot be paused now."));
+}
+
+
+// Slot
+void ScriptTree::resumeScript()
+{
+  m_relatedProcess->resume();
+}
+
+
+// Slot
+void ScriptTree::setPaused(bool paused)
+{
+  // no script starts and the running ones are suspended: the CPU is free
+  m_scriptQueue->setPaused(paused);
+  QList<ScriptProcess*> running = m_scriptQueue->runningScripts();
+  for (int i = 0; i < running.size(); i++)
+  {
+    if (paused)
+      running.at(i)->pause();
+    else
+      running.at(i)->resume();
+  }
 }
 
 
 // Slot
 void ScriptTree::runScriptAgain()
 {
-  addProjectSubTree(itemAt(m_pointerPosition));
+  addProjectSubTree(nodeAt(m_pointerPosition));
 
   // now we can execute the queued scripts
   if (m_scriptQueue->isEmpty())
@@ -1246,6 +1295,7 @@ void ScriptTree::runScriptAgain()
     // advise that the script is going to start
     emit runningScript();
 
+    loadQueueSettings();
     m_scriptQueue->runLast();
   }
 }
@@ -1262,6 +1312,33 @@ void ScriptTree::finishedShowLog( int exitCode, QProcess::ExitStatus exitStatus
 
 // Slot
 void ScriptTree::runProjectTree()
+{
+  runProject(RunState::AllScripts);
+}
+
+
+// Slot
+void ScriptTree::runFailedScripts()
+{
+  runProject(RunState::FailedScripts);
+}
+
+
+// Slot
+void ScriptTree::runNotRunScripts()
+{
+  runProject(RunState::NotRunScripts);
+}
+
+
+// Slot
+void ScriptTree::runInterruptedScripts()
+{
+  runProject(RunState::InterruptedScripts);
+}
+
+
+void ScriptTree::runProject(RunState::Selection selection)
 {
   // clear and hide the TextEdit
   m_outputBox->hide();
@@ -1270,17 +1347,24 @@ void ScriptTree::runProjectTree()
   // remove all the scripts from the queue
   m_scriptQueue->clear();
 
-  for (int i = 0; i < topLevelItemCount(); i++)
+  for (int i = 0; i < m_model->childCount(ScriptModel::Root); i++)
   {
-    if (((TreeWidgetItem *)topLevelItem(i))->checked())
+    int group = m_model->child(ScriptModel::Root, i);
+    if (m_model->checked(group))
       // you can run the tree
-      if (topLevelItem(i)->child(0))
+      if (m_model->childCount(group))
         // queue the scripts
-        addProjectSubTree(topLevelItem(i));
+        addProjectSubTree(group, selection);
   }
 
   // execute the scripts
-  if (m_scriptQueue->isEmpty())
+  if (m_scriptQueue->isEmpty() && (selection != RunState::AllScripts))
+  {
+    QMessageBox::information(0, tr("Nothing to Run"),
+      tr("<p>No script needs to run again.</p>"));
+    emit readyToRun();
+  }
+  else if (m_scriptQueue->isEmpty())
   {
     QMessageBox::critical(0, tr("Running Error"),
       tr("<p>You cannot execute scripts if you don't add at least one script!</p>"));
@@ -1291,11 +1375,187 @@ void ScriptTree::runProjectTree()
     // advise that the script is going to start
     emit runningScript();
 
+    loadQueueSettings();
     m_scriptQueue->run();
   }
 }
 
 
+// Slot
+void ScriptTree::showQueueProgress(int queued, int running, int done)
+{
+  if (m_scriptQueue->isPaused())
+    emit showStatusMessage(tr("Paused: %1 running, %2 queued, %3 done.")
+      .arg(running).arg(queued).arg(done));
+  else
+    emit showStatusMessage(tr("Executing scripts: %1 running, %2 queued, %3 done.")
+      .arg(running).arg(queued).arg(done));
+}
+
+
+void ScriptTree::scriptStarted(ScriptProcess *proc)
+{
+  int node;
+
+  if ((node = m_scriptQueue->lookforScript(proc)))
+  {
+    // the script started running
+    m_model->setState(node, ScriptModel::Running);
+    setRunStatus(node, RunState::Running);
+  }
+}
+
+
+void ScriptTree::scriptEnded(ScriptProcess *proc, bool ok)
+{
+  int node;
+
+  if ((node = m_scriptQueue->lookforScript(proc)))
+  {
+    // the points of a sweep share the node: it shows the outcome of the whole sweep
+    SweepReport *sweep = m_scriptQueue->sweepReport(proc);
+    if (sweep)
+    {
+      m_model->setEstimate(node, proc->duration());
+      showSweepOutcome(node, sweep);
+      return;
+    }
+
+    // the script finished the execution correctly or badly: now you can
+    //  open the log file with the editor
+    m_model->setState(node, ok ? ScriptModel::Succeeded : ScriptModel::Failed);
+    m_model->setEstimate(node, proc->duration());
+
+    // a script terminated because it ran out of time is shown on its own
+    if (proc->timedOut())
+      m_model->setState(node, ScriptModel::TimedOut);
+
+    // a benchmark slower than its baseline failed: tell why
+    if (!ok && proc->isBenchmark() && proc->benchmark().regressed())
+      emit showStatusMessage(tr("%1: %2").arg(m_model->name(node)).arg(proc->benchmark().summary()));
+
+    // a script that exits with an error code has to run again too
+    if (m_model->state(node) == ScriptModel::TimedOut)
+      setRunStatus(node, RunState::TimedOut, proc->returnCode());
+    else if ((m_model->state(node) == ScriptModel::Succeeded) && (proc->returnCode() == 0))
+      setRunStatus(node, RunState::Passed);
+    else
+      setRunStatus(node, RunState::Failed, proc->returnCode());
+  }
+}
+
+
+void ScriptTree::scriptPaused(ScriptProcess *proc, bool paused)
+{
+  int node;
+
+  if ((node = m_scriptQueue->lookforScript(proc)))
+    m_model->setState(node, paused ? ScriptModel::Paused : ScriptModel::Running);
+}
+
+
+void ScriptTree::scriptSkipped(ScriptProcess *proc)
+{
+  int node;
+
+  if ((node = m_scriptQueue->lookforScript(proc)))
+  {
+    SweepReport *sweep = m_scriptQueue->sweepReport(proc);
+    if (sweep)
+    {
+      showSweepOutcome(node, sweep);
+      return;
+    }
+
+    // the script has not been executed
+    m_model->setState(node, ScriptModel::Skipped);
+    setRunStatus(node, RunState::Skipped);
+  }
+}
+
+
+void ScriptTree::showSweepOutcome(int node, SweepReport *sweep)
+{
+  if (!sweep->complete())
+    // the node keeps running until the last point ends
+    return;
+
+  RunState::Status outcome = sweep->outcome();
+  switch (outcome)
+  {
+    case RunState::Passed:
+      m_model->setState(node, ScriptModel::Succeeded);
+      break;
+    case RunState::TimedOut:
+      m_model->setState(node, ScriptModel::TimedOut);
+      break;
+    case RunState::Skipped:
+      m_model->setState(node, ScriptModel::Skipped);
+      break;
+    default:
+      m_model->setState(node, ScriptModel::Failed);
+      break;
+  }
+  setRunStatus(node, outcome);
+  emit showStatusMessage(tr("%1: %2").arg(m_model->name(node)).arg(sweep->summary()));
+}
+
+
+QString ScriptTree::scriptKey(int node) const
+{
+  return RunState::key(createJob(node));
+}
+
+
+void ScriptTree::setRunStatus(int node, RunState::Status status, int code)
+{
+  m_runState.setStatus(scriptKey(node), status, code);
+  if (!m_stateTimer->isActive())
+    m_stateTimer->start();
+}
+
+
+void ScriptTree::saveRunState() // SLOT
+{
+  m_stateTimer->stop();
+  if (!m_runState.save())
+    emit showStatusMessage(tr("Cannot save the outcome of the scripts into '%1'.").arg(m_runState.fileName()));
+}
+
+
+void ScriptTree::showRunState(int node)
+{
+  for (int i = 0; i < m_model->childCount(node); i++)
+  {
+    int child = m_model->child(node, i);
+    if (m_model->isGroup(child))
+    {
+      showRunState(child);
+      continue;
+    }
+
+    switch (m_runState.status(scriptKey(child)))
+    {
+      case RunState::Passed:
+        m_model->setState(child, ScriptModel::Succeeded);
+        break;
+      case RunState::Failed:
+        m_model->setState(child, ScriptModel::Failed);
+        break;
+      case RunState::TimedOut:
+        m_model->setState(child, ScriptModel::TimedOut);
+        break;
+      case RunState::Skipped:
+        m_model->setState(child, ScriptModel::Skipped);
+        break;
+      default:
+        // not run or interrupted: nothing to show
+        break;
+    }
+  }
+}
+
+
 void ScriptTree::setExternalDND()
 {
   // the drop comes from File System Tree
@@ -22,25 +22,29 @@
 
 #include <QtCore/QProcess>
 
-#include <QtWidgets/QTreeWidget>
+#include <QtWidgets/QTreeView>
+
+#include "runstate.h"
 
 class QString;
 class QMouseEvent;
-class QDomDocument;
-class QDomElement;
-class QDomNode;
-class TreeWidgetItem;
+class QXmlStreamWriter;
+class QTimer;
+class ScriptModel;
 class TextEdit;
 class ScriptQueue;
 class ScriptProcess;
+class ScriptJob;
+class SweepReport;
 
 /**
- * This class expand the QTreeWidget to have a specialized tree widget that
- * let to save a project, let to load a project, ...
+ * This class expand the QTreeView to have a specialized tree view that
+ * let to save a project, let to load a project, ... The groups and the
+ * scripts are kept by the Script Model the view shows
  *
  * @author Giovanni Venturi
  */
-class ScriptTree : public QTreeWidget
+class ScriptTree : public QTreeView
 {
   Q_OBJECT
 
@@ -85,26 +89,6 @@ class ScriptTree : public QTreeWidget
      */
     void resetModified();
 
-    /**
-     * Check recursively if a project sub tree is correct (has all the requested
-     * attributes, their names are correct, ...)
-     *
-     * @returns true if the sub tree is correct and compliant to the specifics
-     *
-     * @param node is the QDomNode reference where start visiting the sub tree
-     */
-    bool checkSubprojectFile(QDomNode *node) const;
-
-    /**
-     * Check recursively if a project tree is correct (has all the requested
-     * attributes, their names are correct, ...)
-     *
-     * @returns true if the project tree is correct and compliant to the specifics
-     *
-     * @param node is the QDomNode reference where start visiting the tree
-     */
-    bool checkProjectFile(const QString& filename) const;
-
     /**
      * @returns true if the project was loaded correctly
      *
@@ -130,76 +114,103 @@ class ScriptTree : public QTreeWidget
     void enableDND(const bool& cond = true);
 
     /**
-     * The reference of the dragging Tree Widget
+     * The node of the dragging item in the Script Model
      *
-     * @returns the reference of the dragging Tree Widget
+     * @returns the node of the dragging item
+     */
+    int draggingNode() const;
+
+    /**
+     * @returns the Script Model with the groups and the scripts of the project
      */
-    TreeWidgetItem *draggingItem();
+    ScriptModel *scriptModel() const;
 
   private:
     /**
-     * Add a file script to the script tree
+     * @returns the Script Model node at the position @p pos of the view, 0 if there is none
+     */
+    int nodeAt(const QPoint& pos) const;
+
+    /**
+     * Create a new group/sub group and let the user edit its name if it's not given
      *
-     * @param item is the refernce where to add the new script file
-     * @param filename is the filename of the file
-     * @param checked is true if the script is checked: you can execute the script when start running
-     * @param absoluteFilePath is the absolute file path for the filename
-     * @param times is the number of times the script has to be executed (default is 1)
-     * @param delay is the number of seconds the script has to be delayed before to run again (default is 0)
-     * @param params is the input parameters line for the script
+     * @param parent is the group where to add the new one, 0 for a top level group
+     * @param name is the name of the group
+     * @param checked is the checked condition that let you know if a group is enabled or disabled to run
+     */
+    void createGroup( int parent, const QString& name, bool checked );
+
+    /**
+     * Save the project tree (usually sub tree: it's used into \ref saveProjectTree(QString) )
      *
-     * @returns the reference to the new TreeWidgetItem added
+     * @param top the Script Model node where the tree begins
+     * @param xml is the writer of the project file
      */
-    TreeWidgetItem *addFile( QTreeWidgetItem *item, const QString& filename, bool checked, const QString& absoluteFilePath, int times = 1, int delay = 0, const QString& params = "" );
+    void saveProjectTree(int top, QXmlStreamWriter& xml);
 
     /**
-     * Create a new sub tree to host a group/sub group
+     * Add the scripts (visiting the tree) to the Script Queue
      *
-     * @param item is the QTreeWidgetItem reference: the point when to add the element in the tree
-     * @param name is the name of the script
-     * @param checked is the checked condition that let you know if a script is enabled or disabled to run
+     * @param node is the starting point into the tree
+     * @param selection tells which scripts are queued according to their last outcome
      */
-    void createNewSubGroup( QTreeWidgetItem *item, const QString& name, bool checked );
+    void addProjectSubTree(int node, RunState::Selection selection = RunState::AllScripts);
 
     /**
-     * Save the project tree (usually sub tree: it's used into \ref saveProjectTree(QString) )
+     * Add a script to the Script Queue and show its output into the Monitor View
+     * if the script has been dropped into it
      *
-     * @param top the QTreeWidgetItem reference where the tree begins
-     * @param root the QDomElement reference where the XML structure begins
+     * @param node is the script node
+     * @param selection tells if the script is queued according to its last outcome
      */
-    void saveProjectTree(QTreeWidgetItem *top, QDomElement *root);
+    void queueScript(int node, RunState::Selection selection = RunState::AllScripts);
 
     /**
-     * Set the script color into the tree
+     * Execute the checked scripts of the whole project selected by their last outcome
      *
-     * @param color is the tree script color: default is black
+     * @param selection tells which scripts are executed
      */
-    void setScriptTreeColor(const QString& color = "#000000"); // start from the root to set color to the project tree
+    void runProject(RunState::Selection selection);
 
     /**
-     * Set the script color into the sub tree
+     * @returns the key of a script in the run state: its groups and its file name
      *
-     * @param color is the sub tree script color: default is black
+     * @param node is the script node
      */
-    void setScriptSubtreeColor(QTreeWidgetItem *top, const QString& color = "#000000");
+    QString scriptKey(int node) const;
 
     /**
-     * Check each item of the sub tree and append. It's needed QDomNode reference and QTreeWidgetItem
-     * reference because if it's compliant to the specifics than add the node.
-     * It's used into \ref loadProject(QString)
+     * Record the outcome of a script into the run state: it's saved shortly after
      *
-     * @param node is the QDomNode reference where to begin parsing
-     * @param item is the QTreeWidgetItem reference where it begins adding the item
-     * if it's compliant to the specifics
+     * @param node is the script node
+     * @param status is the outcome
+     * @param code is the exit code of the script if it ended
      */
-    void parseSubgroup(QDomNode *node, QTreeWidgetItem *item);
+    void setRunStatus(int node, RunState::Status status, int code = 0);
 
     /**
-     * Add the scripts (visiting the tree) to the Script Queue
+     * Show in the tree the outcome of a sweep when its last point ended
+     *
+     * @param node is the script node shared by the points
+     * @param sweep is the report of the sweep
+     */
+    void showSweepOutcome(int node, SweepReport *sweep);
+
+    /**
+     * Show in the tree the last outcome of the scripts (visiting the tree)
+     *
+     * @param node is the starting point into the tree
+     */
+    void showRunState(int node);
+
+    /**
+     * Describe the script to execute: its options and the groups it is in
      *
-     * @param item is the starting point reference into the tree
+     * @param node is the script node
+     *
+     * @returns the job to assign to the Script Queue
      */
-    void addProjectSubTree(QTreeWidgetItem *item);
+    ScriptJob createJob(int node) const;
 
     /**
      * Show the console for the related process
@@ -208,21 +219,30 @@ class ScriptTree : public QTreeWidget
      */
     void showConsole(ScriptProcess* process);
 
-  private:
     /**
-     * The textbox on which to write the script output
+     * Change the execution mode of a group and mark the project as modified
+     *
+     * @param node is the group node
+     * @param mode is the new execution mode: "serial", "parallel" or "parallel:N"
      */
-    TextEdit *m_outputBox;
+    void setExecutionMode(int node, const QString& mode);
+
+    /**
+     * Assign to the Script Queue the options stored in the general settings
+     * (i.e. the maximum number of scripts running at the same time)
+     */
+    void loadQueueSettings();
 
+  private:
     /**
-     * The root of the scripts tree
+     * The textbox on which to write the script output
      */
-    TreeWidgetItem *m_root;
+    TextEdit *m_outputBox;
 
     /**
-     * Contains the check state before changing it
+     * The groups and the scripts of the project
      */
-    Qt::CheckState m_statebefore;
+    ScriptModel *m_model;
 
     /**
      * Contains the midified condition. If it's added/removed items into/from the tree than it's changed to true.
@@ -239,16 +259,6 @@ class ScriptTree : public QTreeWidget
      */
     QPoint m_dragStartPosition;
 
-    /**
-     * The QContextMenuEvent reference. It's needed from other members to execute RMB actions
-     */
-    QContextMenuEvent *m_event;
-
-    /**
-     * QDomDocument reference. It's needed in \ref saveProjectTree(QTreeWidgetItem,QDomElement)
-     */
-    QDomDocument *m_XMLProjectDoc;
-
     /**
      * Drag and drop condition. True if the drag and drop is enabled
      */
@@ -285,11 +295,29 @@ class ScriptTree : public QTreeWidget
     QProcess *m_procShowLog;
 
     /**
-     * The reference to the dragging Tree Widget
+     * The Script Model node of the dragging item
+     */
+    int m_draggingNode;
+
+    /**
+     * The last outcome of every script of the project
      */
-    TreeWidgetItem *m_draggingItem;
+    RunState m_runState;
+
+    /**
+     * Save the run state a while after it changed: not on each script event
+     */
+    QTimer *m_stateTimer;
 
   protected:
+    /**
+     * Reimplement the viewportEvent. It needs to show in the tooltip of a running
+     * script the CPU and the memory it's using.
+     *
+     * @param event is the QEvent reference
+     */
+    bool viewportEvent(QEvent *event);
+
     /**
      * Reimplement the dragEnterEvent. It needs to set the drag and drop object to text/plain
      *
@@ -327,13 +355,6 @@ class ScriptTree : public QTreeWidget
      */
     void mouseMoveEvent(QMouseEvent *event);
 
-    /**
-     * Reimplement the mouseReleaseEvent. It needs to understand if it has check or uncheck the item.
-     *
-     * @param event is the QMouseEvent reference
-     */
-    void mouseReleaseEvent(QMouseEvent *event);
-
     /**
      * Reimplement the contextMenuEvent. It needs to understand what context menu
      * has to show according to mouse pointer position.
@@ -348,6 +369,12 @@ class ScriptTree : public QTreeWidget
      */
     void showLogFile();
 
+    /**
+     * Make the last benchmark results of the script according to mouse pointer position
+     * the baseline of its next benchmarks. \ref m_pointerPosition
+     */
+    void saveBaseline();
+
     /**
      * Create a new Group in the tree project and then the user has to edit it assigning a name
      *
@@ -364,6 +391,11 @@ class ScriptTree : public QTreeWidget
      */
     void createNewSubGroup( const QString& name = "", bool checked = true );
 
+    /**
+     * Mark the project as modified: a group was renamed or an item was checked/unchecked
+     */
+    void itemModified();
+
     /**
      * Remove the selected item form the tree
      */
@@ -374,11 +406,41 @@ class ScriptTree : public QTreeWidget
      */
     void runScript();
 
+    /**
+     * Run the items of the selected group one after the other
+     */
+    void setSerialMode();
+
+    /**
+     * Run the items of the selected group at the same time
+     */
+    void setParallelMode();
+
+    /**
+     * Ask how many items of the selected group can run at the same time
+     */
+    void setLimitedParallelMode();
+
+    /**
+     * Ask how long the selected group can take before its scripts are terminated
+     */
+    void setGroupTimeout();
+
     /**
      * Stop the selected script
      */
     void stopScript();
 
+    /**
+     * Suspend the selected script
+     */
+    void pauseScript();
+
+    /**
+     * Let the selected paused script go on
+     */
+    void resumeScript();
+
     /**
      * Run again the script. The number of time a script has to be executed is greater that one
      */
@@ -389,17 +451,85 @@ class ScriptTree : public QTreeWidget
      */
     void finishedShowLog( int exitCode, QProcess::ExitStatus exitStatus );
 
+    /**
+     * Show in the status bar how many scripts are queued, running and executed
+     *
+     * @param queued is the number of scripts waiting for a free slot
+     * @param running is the number of running scripts
+     * @param done is the number of executed scripts
+     */
+    void showQueueProgress(int queued, int running, int done);
+
+    /**
+     * Show in the tree that a script started running
+     *
+     * @param proc is the started script
+     */
+    void scriptStarted(ScriptProcess *proc);
+
+    /**
+     * Show in the tree how a script ended its execution
+     *
+     * @param proc is the ended script
+     * @param ok is true if the script finished normally
+     */
+    void scriptEnded(ScriptProcess *proc, bool ok);
+
+    /**
+     * Show in the tree that a script has not been executed
+     *
+     * @param proc is the skipped script
+     */
+    void scriptSkipped(ScriptProcess *proc);
+
+    /**
+     * Write the run state into the state file of the project
+     */
+    void saveRunState();
+
+    /**
+     * Show in the tree that a script has been paused or it goes on
+     *
+     * @param proc is the script
+     * @param paused is true if the script has been paused
+     */
+    void scriptPaused(ScriptProcess *proc, bool paused);
+
   public slots:
     /**
      * Execute the whole scripts tree of the project
      */
     void runProjectTree();
 
+    /**
+     * Execute the scripts that failed or timed out in their last execution
+     */
+    void runFailedScripts();
+
+    /**
+     * Execute the scripts that have never been executed or that have been skipped
+     */
+    void runNotRunScripts();
+
+    /**
+     * Execute the scripts that were queued or running when the last execution has
+     * been interrupted (i.e. QRunner has been closed)
+     */
+    void runInterruptedScripts();
+
     /**
      * set the not local drag and drop
      */
     void setExternalDND();
 
+    /**
+     * Pause or resume the whole execution: the queue doesn't start the waiting
+     * scripts and the running ones are suspended
+     *
+     * @param paused is true to pause, false to go on
+     */
+    void setPaused(bool paused);
+
   signals:
     /**
      * Emitted when a new project has to be created
@@ -441,9 +571,9 @@ class ScriptTree : public QTreeWidget
     /**
      * Emitted when a file has been selected
      *
-     * @param item is the TreeWidgetItem reference has been selected
+     * @param node is the Script Model node of the selected file
      */
-    void fileSelected(TreeWidgetItem *item);
+    void fileSelected(int node);
 
     /**
      * Emitted when a group has been selected
@@ -459,11 +589,6 @@ class ScriptTree : public QTreeWidget
      * Emitted to display status messages in the main view
      */
     void showStatusMessage(QString);
-
-    /**
-     * Emitted when has been added an environment loading a project
-     */
-    void newEnvironmentItemAdded(TreeWidgetItem*);
 };
 
 #endif
@@ -22,13 +22,16 @@
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QPushButton>
+#include <QtWidgets/QSpinBox>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QDialogButtonBox>
 
 #include <QtCore/QDir>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
 
 #include "settings.h"
+#include "consoleview.h"
 
 Settings::Settings() : QDialog()
 {
@@ -58,6 +61,69 @@ Settings::Settings() : QDialog()
   basedirHoriz->addWidget(m_basedir);
   basedirHoriz->addWidget(dirButton);
 
+  QHBoxLayout* parallelHoriz = new QHBoxLayout;
+  QLabel *parallelLabel = new QLabel(tr("Scripts running at the same time:"));
+  m_maxParallel = new QSpinBox;
+
+  // 0 means as many scripts as the CPU cores
+  m_maxParallel->setRange(0, 1024);
+  m_maxParallel->setSpecialValueText(tr("CPU cores (%1)").arg(QThread::idealThreadCount()));
+  m_maxParallel->setValue(m_settings.value("maxparallel", 0).toInt());
+  m_maxParallel->setToolTip(tr("The other scripts wait for a running script to end before to start"));
+  parallelHoriz->addWidget(parallelLabel);
+  parallelHoriz->addWidget(m_maxParallel);
+
+  QHBoxLayout* scrollbackHoriz = new QHBoxLayout;
+  QLabel *scrollbackLabel = new QLabel(tr("Console scrollback lines:"));
+  m_scrollback = new QSpinBox;
+
+  // 0 means that the consoles keep ConsoleView::MaxScrollback lines, like the top of the range
+  m_scrollback->setRange(0, ConsoleView::MaxScrollback);
+  m_scrollback->setSingleStep(10000);
+  m_scrollback->setSpecialValueText(tr("Maximum"));
+  m_scrollback->setValue(m_settings.value("scrollback", 100000).toInt());
+  m_scrollback->setToolTip(tr("The oldest lines of the script output are removed from the consoles "
+    "beyond this number: \"Maximum\" keeps %1 lines").arg(ConsoleView::MaxScrollback));
+  scrollbackHoriz->addWidget(scrollbackLabel);
+  scrollbackHoriz->addWidget(m_scrollback);
+
+  QHBoxLayout* sampleHoriz = new QHBoxLayout;
+  QLabel *sampleLabel = new QLabel(tr("Sample running scripts every (ms):"));
+  m_sampleInterval = new QSpinBox;
+
+  // 0 means that the running scripts are not measured
+  m_sampleInterval->setRange(0, 60000);
+  m_sampleInterval->setSingleStep(250);
+  m_sampleInterval->setSpecialValueText(tr("Never"));
+  m_sampleInterval->setValue(m_settings.value("sampleinterval", 1000).toInt());
+  m_sampleInterval->setToolTip(tr("The CPU and the memory used by the running scripts are shown in the Monitor View and in the tree tooltips"));
+  sampleHoriz->addWidget(sampleLabel);
+  sampleHoriz->addWidget(m_sampleInterval);
+
+  QHBoxLayout* graceHoriz = new QHBoxLayout;
+  QLabel *graceLabel = new QLabel(tr("Kill stopped scripts after (s):"));
+  m_gracePeriod = new QSpinBox;
+
+  // the script gets SIGTERM first and SIGKILL when the grace period ended
+  m_gracePeriod->setRange(0, 3600);
+  m_gracePeriod->setValue(m_settings.value("killgrace", 5).toInt());
+  m_gracePeriod->setToolTip(tr("A stopped or timed out script has this time to end before it's killed"));
+  graceHoriz->addWidget(graceLabel);
+  graceHoriz->addWidget(m_gracePeriod);
+
+  QHBoxLayout* cacheHoriz = new QHBoxLayout;
+  QLabel *cacheLabel = new QLabel(tr("Result cache size (MB):"));
+  m_cacheSize = new QSpinBox;
+
+  // 0 means that the results of the scripts are not cached
+  m_cacheSize->setRange(0, 1024 * 1024);
+  m_cacheSize->setSingleStep(256);
+  m_cacheSize->setSpecialValueText(tr("Disabled"));
+  m_cacheSize->setValue(m_settings.value("cachesize", 1024).toInt());
+  m_cacheSize->setToolTip(tr("The results used less recently are removed from the cache when it grows larger"));
+  cacheHoriz->addWidget(cacheLabel);
+  cacheHoriz->addWidget(m_cacheSize);
+
   QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
   connect(buttonBox, SIGNAL(accepted()), this, SLOT(accepted()));
   connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
@@ -65,6 +131,11 @@ Settings::Settings() : QDialog()
 
   // add the widget and the layout in the vertical layout
   confOptionLayout->addLayout(basedirHoriz);
+  confOptionLayout->addLayout(parallelHoriz);
+  confOptionLayout->addLayout(scrollbackHoriz);
+  confOptionLayout->addLayout(sampleHoriz);
+  confOptionLayout->addLayout(graceHoriz);
+  confOptionLayout->addLayout(cacheHoriz);
   confOptionLayout->addStretch();
   confOptionLayout->addWidget(buttonBox);
   confOptionLayout->addStretch();
@@ -75,6 +146,11 @@ Settings::Settings() : QDialog()
 Settings::~Settings()
 {
   delete m_basedir;
+  delete m_maxParallel;
+  delete m_scrollback;
+  delete m_sampleInterval;
+  delete m_gracePeriod;
+  delete m_cacheSize;
 }
 
 
@@ -82,6 +158,11 @@ Settings::~Settings()
 void Settings::accepted() // SLOT
 {
   m_settings.setValue("basedir", m_basedir->text());
+  m_settings.setValue("maxparallel", m_maxParallel->value());
+  m_settings.setValue("scrollback", m_scrollback->value());
+  m_settings.setValue("sampleinterval", m_sampleInterval->value());
+  m_settings.setValue("killgrace", m_gracePeriod->value());
+  m_settings.setValue("cachesize", m_cacheSize->value());
   accept();
 }
 
@@ -25,6 +25,7 @@
 #include <QtCore/QSettings>
 
 class QLineEdit;
+class QSpinBox;
 
 /**
  * declare Organization and Application Name for this application
@@ -62,6 +63,31 @@ class Settings : public QDialog
      */
     QLineEdit *m_basedir;
 
+    /**
+     * The Spin Box to choose how many scripts can run at the same time
+     */
+    QSpinBox *m_maxParallel;
+
+    /**
+     * The Spin Box to choose how many lines a console keeps
+     */
+    QSpinBox *m_scrollback;
+
+    /**
+     * The Spin Box to choose how often the running scripts are measured
+     */
+    QSpinBox *m_sampleInterval;
+
+    /**
+     * The Spin Box to choose how long a stopped script has before it's killed
+     */
+    QSpinBox *m_gracePeriod;
+
+    /**
+     * The Spin Box to choose the size limit of the result cache
+     */
+    QSpinBox *m_cacheSize;
+
   private slots:
     /**
      * Called when you choose ok button
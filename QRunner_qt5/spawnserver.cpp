@@ -0,0 +1,903 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+#include <QtCore/QFile>
+
+#include <QtCore/QDebug>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#ifdef Q_OS_LINUX
+  #include <sys/prctl.h>
+#endif
+
+#include "spawnserver.h"
+
+#ifndef MSG_NOSIGNAL
+  #define MSG_NOSIGNAL 0
+#endif
+
+extern char **environ;
+
+namespace
+{
+  /**
+   * The messages exchanged with the helper
+   */
+  enum MessageType { Spawn = 1, Spawned, Exited, GroupEnded, Adopted, Signal };
+
+  /**
+   * The fixed part of a message: a Spawn request is followed by "length" bytes
+   * holding the program, the working directory, the arguments and the
+   * environment as NUL terminated strings
+   */
+  struct Message
+  {
+    qint32 type;
+    qint32 argc;
+    qint32 envc;     // -1 to inherit the environment
+    qint32 error;    // errno of a failed spawn
+    qint64 pid;      // the ended group for GroupEnded, the script group for Signal
+    qint64 group;    // process group of an ended program, script group of an adopted orphan
+    qint32 status;   // wait status of an ended program, the signal to send
+    qint32 left;     // an ended script left processes running
+    quint32 length;
+
+    // the resources used by an ended program
+    qint64 userTime;       // microseconds
+    qint64 systemTime;     // microseconds
+    qint64 maxRss;         // KiB
+    qint64 minorFaults;
+    qint64 majorFaults;
+    qint64 readBytes;
+    qint64 writtenBytes;
+  };
+}
+
+/**
+ * The socket connected to the helper, created by \ref SpawnServer::start()
+ */
+static int s_socket = -1;
+
+/**
+ * The connection to the helper
+ */
+static SpawnServer *s_instance = 0;
+
+/**
+ * The helper is told that a program ended by writing into this pipe from the SIGCHLD handler
+ */
+static int s_childPipe[2];
+
+/**
+ * The environment variable that tags the scripts and all their descendants with
+ * their spawn request: it tells the script of an orphan that left its group
+ */
+static const char s_spawnTag[] = "QRUNNER_SPAWN_ID";
+
+
+static bool writeAll(int fd, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+
+static bool readAll(int fd, char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t n = read(fd, data, size);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (n == 0)
+      // the other side closed the connection
+      return false;
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+
+static void setCloseOnExec(int fd)
+{
+  fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+
+/**
+ * Read the disk I/O of an ended program that has not been reaped yet
+ *
+ * @returns false if /proc/<pid>/io cannot be read
+ */
+static bool readProcessIo(pid_t pid, qint64 *readBytes, qint64 *writtenBytes)
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/io", (int)pid);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  char buffer[1024];
+  ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (n <= 0)
+    return false;
+  buffer[n] = '\0';
+
+  // the bytes that really reached the storage layer
+  const char *field = strstr(buffer, "\nread_bytes:");
+  const char *written = strstr(buffer, "\nwrite_bytes:");
+  if (!field || !written)
+    return false;
+  *readBytes = strtoll(field + strlen("\nread_bytes:"), 0, 10);
+  *writtenBytes = strtoll(written + strlen("\nwrite_bytes:"), 0, 10);
+  return true;
+}
+
+
+/**
+ * Find the children of the helper still running: the scripts and the orphans of
+ * the scripts reparented to the helper because it's their subreaper
+ */
+static QList<pid_t> helperChildren()
+{
+  QList<pid_t> found;
+#ifdef Q_OS_LINUX
+  DIR *proc = opendir("/proc");
+  if (!proc)
+    return found;
+
+  pid_t self = getpid();
+  struct dirent *entry;
+  char path[64];
+  char buffer[512];
+  while ((entry = readdir(proc)) != 0)
+  {
+    if ((entry->d_name[0] < '0') || (entry->d_name[0] > '9'))
+      continue;
+
+    snprintf(path, sizeof(path), "/proc/%s/stat", entry->d_name);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      continue;
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (n <= 0)
+      continue;
+    buffer[n] = '\0';
+
+    // the parent comes after the command name, that can contain spaces and parentheses
+    char *fields = strrchr(buffer, ')');
+    char state;
+    int parent;
+    if (fields && (sscanf(fields + 1, " %c %d", &state, &parent) == 2) && (parent == self) &&
+        (state != 'Z'))
+      found.append((pid_t)strtol(entry->d_name, 0, 10));
+  }
+  closedir(proc);
+#endif
+  return found;
+}
+
+
+/**
+ * Kill the children of the helper
+ */
+static void killChildren()
+{
+  QList<pid_t> children = helperChildren();
+  for (int i = 0; i < children.size(); i++)
+    kill(children.at(i), SIGKILL);
+}
+
+
+/**
+ * Read the spawn tag a process inherited from its script
+ *
+ * @returns the spawn request of the script, -1 if the process has no tag
+ */
+static qint64 readSpawnTag(pid_t pid)
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/environ", (int)pid);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return -1;
+
+  QByteArray environment;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+    environment.append(buffer, n);
+  close(fd);
+
+  QByteArray name = QByteArray(s_spawnTag) + '=';
+  int start = 0;
+  if (!environment.startsWith(name))
+  {
+    start = environment.indexOf('\0' + name);
+    if (start < 0)
+      return -1;
+    start++;
+  }
+  return strtoll(environment.constData() + start + name.size(), 0, 10);
+}
+
+
+/**
+ * Adopt the orphans that left the process group of their script with setsid()
+ * and have been reparented to the helper: they are killed and reaped with their
+ * script and QRunner is told about them
+ *
+ * @param socket is the local socket connected to QRunner
+ * @param groups are the process groups of the scripts still running
+ * @param tags are the process groups of the scripts by spawn tag
+ * @param owners are the adopted orphans with the process group of their script
+ *
+ * @returns false if QRunner is gone
+ */
+static bool adoptOrphans(int socket, const QList<pid_t>& groups, const QHash<qint64, pid_t>& tags,
+  QHash<pid_t, pid_t> *owners)
+{
+  QList<pid_t> children = helperChildren();
+  for (int i = 0; i < children.size(); i++)
+  {
+    pid_t pid = children.at(i);
+    if (owners->contains(pid) || groups.contains(getpgid(pid)))
+      // adopted already or still in the group of its script
+      continue;
+
+    qint64 tag = readSpawnTag(pid);
+    if (!tags.contains(tag))
+      continue;
+
+    pid_t group = tags.value(tag);
+    owners->insert(pid, group);
+
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = Adopted;
+    msg.pid = pid;
+    msg.group = group;
+    if (!writeAll(socket, (const char *)&msg, sizeof(msg)))
+      return false;
+  }
+  return true;
+}
+
+
+/**
+ * Send a signal to the process group of a script and to its adopted orphans
+ * with their own process group
+ */
+static void sendSignal(pid_t group, int signal, const QHash<pid_t, pid_t>& owners)
+{
+  kill(-group, signal);
+  QHashIterator<pid_t, pid_t> orphan(owners);
+  while (orphan.hasNext())
+  {
+    orphan.next();
+    if (orphan.value() != group)
+      continue;
+    if (getpgid(orphan.key()) == orphan.key())
+      kill(-orphan.key(), signal);
+    else
+      kill(orphan.key(), signal);
+  }
+}
+
+
+/**
+ * QRunner is gone: kill all the scripts with their descendants, reap them and exit
+ *
+ * @param groups are the process groups of the scripts still running
+ */
+static void endHelper(const QList<pid_t>& groups)
+{
+  for (int i = 0; i < groups.size(); i++)
+    kill(-groups.at(i), SIGKILL);
+
+  // the descendants that left the group of their script become children of the
+  //  helper when their parent dies: kill them until there is nobody left (5 s at most)
+  for (int tries = 0; tries < 500; tries++)
+  {
+    killChildren();
+
+    pid_t pid;
+    while ((pid = waitpid(-1, 0, WNOHANG)) > 0)
+      ;
+    if ((pid < 0) && (errno == ECHILD))
+      break;
+    usleep(10000);
+  }
+  _exit(0);
+}
+
+
+static void childSignal(int)
+{
+  int saved = errno;
+  char c = 0;
+  // if the pipe is full the helper is going to reap anyway
+  ssize_t written = write(s_childPipe[1], &c, 1);
+  Q_UNUSED(written);
+  errno = saved;
+}
+
+
+bool SpawnServer::start()
+{
+  if (s_socket >= 0)
+    return true;
+
+  int sv[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0)
+  {
+    qDebug() << "cannot create the spawn helper socket:" << strerror(errno);
+    return false;
+  }
+
+  pid_t pid = fork();
+  if (pid < 0)
+  {
+    qDebug() << "cannot fork the spawn helper:" << strerror(errno);
+    close(sv[0]);
+    close(sv[1]);
+    return false;
+  }
+  if (pid == 0)
+  {
+    // the helper
+    close(sv[0]);
+    serve(sv[1]);
+  }
+
+  close(sv[1]);
+  setCloseOnExec(sv[0]);
+  s_socket = sv[0];
+  return true;
+}
+
+
+SpawnServer *SpawnServer::instance()
+{
+  if (!s_instance && (s_socket >= 0) && QCoreApplication::instance())
+    s_instance = new SpawnServer(s_socket);
+  return s_instance;
+}
+
+
+SpawnServer::SpawnServer(int socket)
+  : QObject(QCoreApplication::instance()), m_socket(socket)
+{
+  m_gotSpawned = false;
+  m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+  connect(m_notifier, SIGNAL(activated(int)), SLOT(readMessages()));
+}
+
+
+bool SpawnServer::isAvailable() const
+{
+  return m_socket >= 0;
+}
+
+
+qint64 SpawnServer::spawn(const QString& program, const QStringList& args, const QStringList& env,
+  const QString& dir, const int fds[3], int *error)
+{
+  if (m_socket < 0)
+  {
+    *error = ECONNREFUSED;
+    return -1;
+  }
+
+  QByteArray payload;
+  payload += QFile::encodeName(program) + '\0';
+  payload += QFile::encodeName(dir) + '\0';
+  for (int i = 0; i < args.size(); i++)
+    payload += args.at(i).toLocal8Bit() + '\0';
+  for (int i = 0; i < env.size(); i++)
+    payload += env.at(i).toLocal8Bit() + '\0';
+
+  Message msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.type = Spawn;
+  msg.argc = args.size();
+  msg.envc = env.isEmpty() ? -1 : env.size();
+  msg.length = payload.size();
+
+  // the standard channels travel with the request
+  char control[CMSG_SPACE(3 * sizeof(int))];
+  memset(control, 0, sizeof(control));
+  struct iovec iov;
+  iov.iov_base = &msg;
+  iov.iov_len = sizeof(msg);
+  struct msghdr hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.msg_iov = &iov;
+  hdr.msg_iovlen = 1;
+  hdr.msg_control = control;
+  hdr.msg_controllen = sizeof(control);
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(3 * sizeof(int));
+  memcpy(CMSG_DATA(cmsg), fds, 3 * sizeof(int));
+
+  ssize_t sent;
+  do
+    sent = sendmsg(m_socket, &hdr, MSG_NOSIGNAL);
+  while ((sent < 0) && (errno == EINTR));
+
+  // the ancillary data goes with the first byte: the rest of the header can be split
+  bool ok = (sent > 0) && writeAll(m_socket, (const char *)&msg + sent, sizeof(msg) - sent)
+    && writeAll(m_socket, payload.constData(), payload.size());
+
+  // wait for the reply: the programs that end meanwhile are delivered later
+  m_gotSpawned = false;
+  while (ok && !m_gotSpawned)
+    ok = readMessage(true);
+  if (!m_exited.isEmpty())
+    QMetaObject::invokeMethod(this, "deliverExited", Qt::QueuedConnection);
+
+  if (!ok)
+  {
+    qDebug() << "the spawn helper is not available anymore";
+    m_notifier->setEnabled(false);
+    close(m_socket);
+    m_socket = -1;
+    *error = ECONNRESET;
+    return -1;
+  }
+
+  *error = m_spawned.second;
+  return m_spawned.first;
+}
+
+
+bool SpawnServer::signalGroup(qint64 group, int signal)
+{
+  if (m_socket < 0)
+    return false;
+
+  Message msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.type = Signal;
+  msg.pid = group;
+  msg.status = signal;
+  return writeAll(m_socket, (const char *)&msg, sizeof(msg));
+}
+
+
+bool SpawnServer::readMessage(bool wait)
+{
+  if (!wait)
+  {
+    // don't block the event loop if there is nothing to read
+    struct pollfd pfd = { m_socket, POLLIN, 0 };
+    if (poll(&pfd, 1, 0) <= 0)
+      return true;
+  }
+
+  Message msg;
+  if (!readAll(m_socket, (char *)&msg, sizeof(msg)))
+    return false;
+
+  if (msg.type == Spawned)
+  {
+    m_spawned = qMakePair(msg.pid, (int)msg.error);
+    m_gotSpawned = true;
+  }
+  else if (msg.type == GroupEnded)
+  {
+    EndedProgram ended;
+    ended.pid = msg.pid;
+    ended.group = msg.pid;
+    ended.status = 0;
+    ended.left = false;
+    ended.groupEnded = true;
+    ended.adopted = false;
+    m_exited.append(ended);
+  }
+  else if (msg.type == Adopted)
+  {
+    EndedProgram adopted;
+    adopted.pid = msg.pid;
+    adopted.group = msg.group;
+    adopted.status = 0;
+    adopted.left = false;
+    adopted.groupEnded = false;
+    adopted.adopted = true;
+    m_exited.append(adopted);
+  }
+  else if (msg.type == Exited)
+  {
+    EndedProgram ended;
+    ended.pid = msg.pid;
+    ended.group = msg.group;
+    ended.status = msg.status;
+    ended.left = msg.left != 0;
+    ended.groupEnded = false;
+    ended.adopted = false;
+    ended.usage.setCpuTime(msg.userTime, msg.systemTime);
+    ended.usage.setMaxRss(msg.maxRss);
+    ended.usage.setPageFaults(msg.minorFaults, msg.majorFaults);
+    ended.usage.setIo(msg.readBytes, msg.writtenBytes);
+    m_exited.append(ended);
+  }
+
+  return true;
+}
+
+
+void SpawnServer::readMessages() // SLOT
+{
+  if (!readMessage(false))
+  {
+    qDebug() << "the spawn helper is not available anymore";
+    m_notifier->setEnabled(false);
+    close(m_socket);
+    m_socket = -1;
+  }
+  deliverExited();
+}
+
+
+void SpawnServer::setOwner(qint64 group, QObject *owner)
+{
+  if (owner)
+    m_owners.insert(group, owner);
+  else
+    m_owners.remove(group);
+}
+
+
+void SpawnServer::deliverExited() // SLOT
+{
+  while (!m_exited.isEmpty())
+  {
+    EndedProgram ended = m_exited.takeFirst();
+
+    // only the script of the group is told: the others don't care
+    QObject *owner = m_owners.value(ended.group);
+    if (!owner)
+      continue;
+
+    if (ended.groupEnded)
+    {
+      // the owner can start its script again with a new group
+      m_owners.remove(ended.group);
+      QMetaObject::invokeMethod(owner, "spawnedGroupEnded", Qt::DirectConnection,
+        Q_ARG(qint64, ended.group));
+    }
+    else if (ended.adopted)
+      QMetaObject::invokeMethod(owner, "spawnedAdopted", Qt::DirectConnection,
+        Q_ARG(qint64, ended.pid));
+    else
+      QMetaObject::invokeMethod(owner, "spawnedExited", Qt::DirectConnection,
+        Q_ARG(qint64, ended.pid), Q_ARG(qint64, ended.group), Q_ARG(int, ended.status),
+        Q_ARG(bool, ended.left), Q_ARG(ResourceUsage, ended.usage));
+  }
+}
+
+
+void SpawnServer::serve(int socket)
+{
+  setCloseOnExec(socket);
+
+#ifdef Q_OS_LINUX
+  // the orphans of the scripts are reparented to the helper, not to init:
+  //  they are reaped and accounted here and killed with the scripts
+  if (prctl(PR_SET_CHILD_SUBREAPER, 1) < 0)
+    qDebug() << "the spawn helper cannot be a child subreaper:" << strerror(errno);
+#endif
+
+  // the process groups of the running scripts and the scripts not reaped yet
+  QList<pid_t> groups;
+  QList<pid_t> leaders;
+
+  // the process groups of the scripts by spawn tag and the adopted orphans with
+  //  the process group of their script
+  QHash<qint64, pid_t> tags;
+  QHash<pid_t, pid_t> owners;
+  qint64 spawns = 0;
+
+  // SIGCHLD wakes up the loop through a pipe
+  if (pipe(s_childPipe) < 0)
+    _exit(1);
+  for (int i = 0; i < 2; i++)
+  {
+    setCloseOnExec(s_childPipe[i]);
+    fcntl(s_childPipe[i], F_SETFL, fcntl(s_childPipe[i], F_GETFL) | O_NONBLOCK);
+  }
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = childSignal;
+  sa.sa_flags = SA_NOCLDSTOP | SA_RESTART;
+  sigaction(SIGCHLD, &sa, 0);
+
+  // the helper ends when QRunner closes the socket, not when the terminal interrupts it
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGINT, SIG_IGN);
+
+  // ... but the scripts get the default handlers back
+  sigset_t defaults;
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGPIPE);
+  sigaddset(&defaults, SIGINT);
+  sigaddset(&defaults, SIGCHLD);
+
+  for (;;)
+  {
+    // while scripts are running look for their orphans every second
+    struct pollfd pfd[2] = { { socket, POLLIN, 0 }, { s_childPipe[0], POLLIN, 0 } };
+    int ready = poll(pfd, 2, groups.isEmpty() ? -1 : 1000);
+    if (ready < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      _exit(1);
+    }
+    if ((ready == 0) && !adoptOrphans(socket, groups, tags, &owners))
+      endHelper(groups);
+
+    if (pfd[1].revents)
+    {
+      char buffer[64];
+      while (read(s_childPipe[0], buffer, sizeof(buffer)) > 0)
+        ;
+
+      // the processes reparented when their parent ended are adopted before it's reaped
+      if (!adoptOrphans(socket, groups, tags, &owners))
+        endHelper(groups);
+
+      // report all the ended programs with the resources they used
+      siginfo_t info;
+      for (;;)
+      {
+        // look at the ended program without reaping it: its /proc entry is still there
+        memset(&info, 0, sizeof(info));
+        if ((waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT) < 0) || (info.si_pid == 0))
+          break;
+
+        pid_t pid = info.si_pid;
+        qint64 readBytes, writtenBytes;
+        bool io = readProcessIo(pid, &readBytes, &writtenBytes);
+
+        // the group tells the script an orphan belongs to, unless the orphan left it
+        pid_t group = owners.contains(pid) ? owners.value(pid) : getpgid(pid);
+
+        int status;
+        struct rusage usage;
+        if (wait4(pid, &status, 0, &usage) != pid)
+          break;
+        owners.remove(pid);
+
+        Message msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.type = Exited;
+        msg.pid = pid;
+        msg.group = group;
+        msg.status = status;
+        msg.left = leaders.contains(pid) && ((kill(-group, 0) == 0) || (owners.key(group, 0) != 0));
+        msg.userTime = (qint64)usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec;
+        msg.systemTime = (qint64)usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+#ifdef Q_OS_MAC
+        msg.maxRss = usage.ru_maxrss / 1024;
+#else
+        msg.maxRss = usage.ru_maxrss;
+#endif
+        msg.minorFaults = usage.ru_minflt;
+        msg.majorFaults = usage.ru_majflt;
+
+        // without /proc the blocks count of the file system
+        msg.readBytes = io ? readBytes : (qint64)usage.ru_inblock * 512;
+        msg.writtenBytes = io ? writtenBytes : (qint64)usage.ru_oublock * 512;
+        if (!writeAll(socket, (const char *)&msg, sizeof(msg)))
+          endHelper(groups);
+
+        // the script ended when the last process of its group and the last of
+        //  its adopted orphans have been reaped
+        leaders.removeOne(pid);
+        if ((group > 0) && groups.contains(group) && !leaders.contains(group) &&
+            (kill(-group, 0) < 0) && (errno == ESRCH) && (owners.key(group, 0) == 0))
+        {
+          groups.removeOne(group);
+          tags.remove(tags.key(group));
+          memset(&msg, 0, sizeof(msg));
+          msg.type = GroupEnded;
+          msg.pid = group;
+          if (!writeAll(socket, (const char *)&msg, sizeof(msg)))
+            endHelper(groups);
+        }
+      }
+    }
+
+    if (!pfd[0].revents)
+      continue;
+
+    // a spawn request: the header brings the standard channels
+    Message msg;
+    int fds[3] = { -1, -1, -1 };
+    char control[CMSG_SPACE(3 * sizeof(int))];
+    struct iovec iov;
+    iov.iov_base = &msg;
+    iov.iov_len = sizeof(msg);
+    struct msghdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+    hdr.msg_control = control;
+    hdr.msg_controllen = sizeof(control);
+
+    ssize_t got;
+    do
+      got = recvmsg(socket, &hdr, 0);
+    while ((got < 0) && (errno == EINTR));
+    if (got <= 0)
+      // QRunner is gone
+      endHelper(groups);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+    if (cmsg && (cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_RIGHTS))
+    {
+      memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+      for (int i = 0; i < 3; i++)
+        setCloseOnExec(fds[i]);
+    }
+
+    if (!readAll(socket, (char *)&msg + got, sizeof(msg) - got))
+      endHelper(groups);
+    QByteArray payload(msg.length, '\0');
+    if (!readAll(socket, payload.data(), payload.size()))
+      endHelper(groups);
+
+    if (msg.type == Signal)
+    {
+      // the orphans found so far are signalled with their script: QRunner doesn't wait for a reply
+      for (int i = 0; i < 3; i++)
+        if (fds[i] >= 0)
+          close(fds[i]);
+      if (!adoptOrphans(socket, groups, tags, &owners))
+        endHelper(groups);
+      if ((msg.pid > 0) && groups.contains((pid_t)msg.pid))
+        sendSignal((pid_t)msg.pid, msg.status, owners);
+      continue;
+    }
+
+    // split the payload: program, directory, arguments, environment
+    QVector<char *> strings;
+    int start = 0;
+    while (start < payload.size())
+    {
+      int end = payload.indexOf('\0', start);
+      if (end < 0)
+        break;
+      strings.append(payload.data() + start);
+      start = end + 1;
+    }
+
+    Message reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = Spawned;
+    reply.pid = -1;
+
+    int envc = qMax(msg.envc, 0);
+    if ((msg.type != Spawn) || (fds[0] < 0) || (strings.size() != 2 + msg.argc + envc))
+      reply.error = EINVAL;
+    else if ((strings.at(1)[0] != '\0') && (chdir(strings.at(1)) < 0))
+      reply.error = errno;
+    else
+    {
+      QVector<char *> argv;
+      argv.append(strings.at(0));
+      for (int i = 0; i < msg.argc; i++)
+        argv.append(strings.at(2 + i));
+      argv.append(0);
+
+      // the script and its descendants inherit the tag: the tag of a QRunner
+      //  that started this QRunner is replaced
+      QByteArray tag = QByteArray(s_spawnTag) + '=' + QByteArray::number(++spawns);
+      QByteArray name = QByteArray(s_spawnTag) + '=';
+      QVector<char *> envp;
+      envp.append(tag.data());
+      if (msg.envc < 0)
+      {
+        for (char **variable = environ; *variable; variable++)
+          if (strncmp(*variable, name.constData(), name.size()) != 0)
+            envp.append(*variable);
+      }
+      else
+      {
+        for (int i = 0; i < envc; i++)
+          if (strncmp(strings.at(2 + msg.argc + i), name.constData(), name.size()) != 0)
+            envp.append(strings.at(2 + msg.argc + i));
+      }
+      envp.append(0);
+
+      posix_spawn_file_actions_t actions;
+      posix_spawn_file_actions_init(&actions);
+      for (int i = 0; i < 3; i++)
+        posix_spawn_file_actions_adddup2(&actions, fds[i], i);
+
+      posix_spawnattr_t attr;
+      posix_spawnattr_init(&attr);
+      posix_spawnattr_setsigdefault(&attr, &defaults);
+
+      // each script leads its own process group: it's signalled with all its descendants
+      posix_spawnattr_setpgroup(&attr, 0);
+      posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+      pid_t pid;
+      int err = posix_spawnp(&pid, argv.at(0), &actions, &attr, argv.data(), envp.data());
+      if (err == 0)
+      {
+        reply.pid = pid;
+        groups.append(pid);
+        leaders.append(pid);
+        tags.insert(spawns, pid);
+      }
+      else
+        reply.error = err;
+
+      posix_spawnattr_destroy(&attr);
+      posix_spawn_file_actions_destroy(&actions);
+    }
+
+    for (int i = 0; i < 3; i++)
+      if (fds[i] >= 0)
+        close(fds[i]);
+
+    if (!writeAll(socket, (const char *)&reply, sizeof(reply)))
+      endHelper(groups);
+  }
+}
@@ -0,0 +1,194 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef SPAWNSERVER_H
+#define SPAWNSERVER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QHash>
+
+#include "resourceusage.h"
+
+class QSocketNotifier;
+
+/**
+ * This class starts the scripts from a small helper process. Forking the GUI
+ * to start a script copies its whole address space (the project tree, the
+ * consoles, ...), so the helper is forked at launch, when QRunner is still
+ * tiny, and it receives the spawn requests (program, arguments, environment,
+ * working directory and the pipes to use as standard channels) through a
+ * local socket. Each script leads its own process group and the helper is the
+ * child subreaper of the scripts (Linux): it reaps the scripts and their
+ * orphans, sends back their exit status and the resources they used, tells
+ * when the last process of a script group ended and kills all of them if
+ * QRunner goes away. The orphans that left the group of their script with
+ * setsid() are recognized by a tag in their environment: the helper adopts
+ * them, signals them with their script and waits for them too before the
+ * group is over.
+ *
+ * @author Giovanni Venturi
+ */
+class SpawnServer : public QObject
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * Fork the helper process. It has to be called at the beginning of main(),
+     * before the application object and any thread are created
+     *
+     * @returns true if the helper is running
+     */
+    static bool start();
+
+    /**
+     * @returns the connection to the helper process, 0 if the helper is not running
+     */
+    static SpawnServer *instance();
+
+    /**
+     * @returns true if the helper can still accept spawn requests
+     */
+    bool isAvailable() const;
+
+    /**
+     * Ask the helper to start a program
+     *
+     * @param program is the program to execute
+     * @param args are the program arguments
+     * @param env is the program environment ("NAME=value"): if empty the program
+     *   inherits the QRunner environment
+     * @param dir is the working directory of the program
+     * @param fds are the file descriptors to use as standard input, output and error
+     * @param error is set to the errno value if the program cannot be started
+     *
+     * @returns the PID of the started program or -1 on error
+     */
+    qint64 spawn(const QString& program, const QStringList& args, const QStringList& env,
+      const QString& dir, const int fds[3], int *error);
+
+    /**
+     * Ask the helper to send a signal to the process group of a script and to
+     * the orphans of the script that left the group
+     *
+     * @param group is the process group: the PID returned by \ref spawn()
+     * @param signal is the signal to send
+     *
+     * @returns false if the helper is not available
+     */
+    bool signalGroup(qint64 group, int signal);
+
+    /**
+     * Deliver the end of the programs of a script group to their owner only.
+     * The owner gets spawnedExited(qint64 pid, qint64 group, int status, bool left,
+     * const ResourceUsage& usage) when the script or one of its orphans ended ("left" is true
+     * if the script left processes running), spawnedAdopted(qint64 pid) when an orphan that
+     * left the group has been adopted by the helper and spawnedGroupEnded(qint64 group) when the
+     * last process of the group ended: then the owner is forgotten
+     *
+     * @param group is the process group: the PID returned by \ref spawn()
+     * @param owner is the object that started the script, 0 to forget the owner of the group
+     */
+    void setOwner(qint64 group, QObject *owner);
+
+  private:
+    /**
+     * Create the connection to the helper
+     *
+     * @param socket is the local socket connected to the helper
+     */
+    SpawnServer(int socket);
+
+    /**
+     * Read a message sent by the helper
+     *
+     * @returns false if the helper is gone
+     */
+    bool readMessage(bool wait);
+
+    /**
+     * The helper loop: execute the spawn requests and report the exit status
+     * of the started programs. It never returns
+     *
+     * @param socket is the local socket connected to QRunner
+     */
+    static void serve(int socket);
+
+  private slots:
+    /**
+     * Read the messages the helper sent
+     */
+    void readMessages();
+
+    /**
+     * Tell their owners about the programs that ended
+     */
+    void deliverExited();
+
+  private:
+    /**
+     * A program that ended, or an orphan that has been adopted
+     */
+    struct EndedProgram
+    {
+      qint64 pid;
+      qint64 group;
+      int status;             // the wait status
+      bool left;              // the script ended leaving processes running
+      ResourceUsage usage;
+      bool groupEnded;        // the last process of the group ended: nothing else is set
+      bool adopted;           // the orphan left the group and it's still running: pid and group are set
+    };
+
+    /**
+     * The local socket connected to the helper, -1 if the helper is not available
+     */
+    int m_socket;
+
+    /**
+     * Watch the socket for messages from the helper
+     */
+    QSocketNotifier *m_notifier;
+
+    /**
+     * The programs that ended (and the orphans adopted) while waiting for a spawn reply
+     */
+    QList<EndedProgram> m_exited;
+
+    /**
+     * The object that started each script group, by process group
+     */
+    QHash<qint64, QObject *> m_owners;
+
+    /**
+     * The reply to the last spawn request: PID (or -1) and errno
+     */
+    QPair<qint64, int> m_spawned;
+
+    /**
+     * true when the reply to the last spawn request has been read
+     */
+    bool m_gotSpawned;
+};
+
+#endif
@@ -0,0 +1,266 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#include <QtCore/QSaveFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonArray>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+
+#include "sweep.h"
+
+Sweep::Sweep()
+{
+  m_mode = Product;
+}
+
+
+bool Sweep::parseMode(const QString& name, Mode *mode)
+{
+  if (name.isEmpty() || (name == "product"))
+    *mode = Product;
+  else if (name == "list")
+    *mode = List;
+  else
+    return false;
+  return true;
+}
+
+
+QString Sweep::modeName(Mode mode)
+{
+  return (mode == List) ? "list" : "product";
+}
+
+
+void Sweep::setMode(Mode mode)
+{
+  m_mode = mode;
+}
+
+
+Sweep::Mode Sweep::mode() const
+{
+  return m_mode;
+}
+
+
+void Sweep::addParameters(const QStringList& values)
+{
+  m_axes.append(qMakePair(QString(), values));
+}
+
+
+void Sweep::addEnvironment(const QString& name, const QStringList& values)
+{
+  m_axes.append(qMakePair(name, values));
+}
+
+
+bool Sweep::isEmpty() const
+{
+  return m_axes.isEmpty();
+}
+
+
+int Sweep::axisCount() const
+{
+  return m_axes.size();
+}
+
+
+QString Sweep::axisName(int axis) const
+{
+  return m_axes.at(axis).first;
+}
+
+
+QStringList Sweep::axisValues(int axis) const
+{
+  return m_axes.at(axis).second;
+}
+
+
+int Sweep::count() const
+{
+  if (m_axes.isEmpty())
+    return 0;
+
+  int count = (m_mode == Product) ? 1 : m_axes.first().second.size();
+  for (int i = 0; i < m_axes.size(); i++)
+  {
+    if (m_mode == Product)
+      count *= m_axes.at(i).second.size();
+    else
+      // the values beyond the shortest axis have no point
+      count = qMin(count, m_axes.at(i).second.size());
+  }
+  return count;
+}
+
+
+QStringList Sweep::point(int index) const
+{
+  QStringList values;
+  if (m_mode == List)
+  {
+    for (int i = 0; i < m_axes.size(); i++)
+      values << m_axes.at(i).second.at(index);
+    return values;
+  }
+
+  // the last axis changes first, like the innermost of nested loops
+  for (int i = m_axes.size() - 1; i >= 0; i--)
+  {
+    int size = m_axes.at(i).second.size();
+    values.prepend(m_axes.at(i).second.at(index % size));
+    index /= size;
+  }
+  return values;
+}
+
+
+QString Sweep::label(int index) const
+{
+  QStringList values = point(index);
+  QStringList label;
+  for (int i = 0; i < m_axes.size(); i++)
+  {
+    if (m_axes.at(i).first.isEmpty())
+      label << values.at(i);
+    else
+      label << m_axes.at(i).first + "=" + values.at(i);
+  }
+  return label.join(" ");
+}
+
+
+
+SweepReport::SweepReport(const QString& fileName, const QString& script, int count)
+  : m_points(count)
+{
+  m_fileName = fileName;
+  m_script = script;
+  m_ended = 0;
+}
+
+
+QString SweepReport::fileName() const
+{
+  return m_fileName;
+}
+
+
+void SweepReport::setOutcome(int index, const QString& label, RunState::Status status, int code, qint64 duration, double median)
+{
+  if ((index < 0) || (index >= m_points.size()))
+    return;
+
+  Point& point = m_points[index];
+  if (point.status == RunState::NotRun)
+    m_ended++;
+  point.status = status;
+  point.code = code;
+  point.duration = duration;
+  point.median = median;
+  point.label = label;
+}
+
+
+bool SweepReport::complete() const
+{
+  return m_ended == m_points.size();
+}
+
+
+int SweepReport::count(RunState::Status status) const
+{
+  int count = 0;
+  for (int i = 0; i < m_points.size(); i++)
+  {
+    if (m_points.at(i).status == status)
+      count++;
+  }
+  return count;
+}
+
+
+RunState::Status SweepReport::outcome() const
+{
+  if (count(RunState::Failed))
+    return RunState::Failed;
+  if (count(RunState::TimedOut))
+    return RunState::TimedOut;
+  if (count(RunState::Skipped))
+    return RunState::Skipped;
+  return RunState::Passed;
+}
+
+
+QString SweepReport::summary() const
+{
+  QString summary = QCoreApplication::translate("SweepReport", "%1 jobs: %2 passed, %3 failed")
+    .arg(m_points.size()).arg(count(RunState::Passed)).arg(count(RunState::Failed));
+  if (count(RunState::TimedOut))
+    summary += QCoreApplication::translate("SweepReport", ", %1 timed out").arg(count(RunState::TimedOut));
+  if (count(RunState::Skipped))
+    summary += QCoreApplication::translate("SweepReport", ", %1 skipped").arg(count(RunState::Skipped));
+  return summary;
+}
+
+
+bool SweepReport::save() const
+{
+  QJsonArray points;
+  for (int i = 0; i < m_points.size(); i++)
+  {
+    const Point& point = m_points.at(i);
+    QJsonObject json;
+    json.insert("task_id", i);
+    json.insert("point", point.label);
+    json.insert("status", RunState::statusName(point.status));
+    if ((point.status != RunState::NotRun) && (point.status != RunState::Skipped))
+    {
+      json.insert("exit_code", point.code);
+      json.insert("duration_ms", point.duration);
+    }
+    if (point.median >= 0)
+      json.insert("median_ms", point.median);
+    points.append(json);
+  }
+
+  QJsonObject json;
+  json.insert("script", m_script);
+  json.insert("jobs", m_points.size());
+  json.insert("passed", count(RunState::Passed));
+  json.insert("failed", count(RunState::Failed));
+  json.insert("timed_out", count(RunState::TimedOut));
+  json.insert("skipped", count(RunState::Skipped));
+  json.insert("points", points);
+
+  QSaveFile file(m_fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << "cannot create file in writing: " << m_fileName;
+    return false;
+  }
+  file.write(QJsonDocument(json).toJson());
+  return file.commit();
+}
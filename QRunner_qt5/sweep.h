@@ -0,0 +1,251 @@
+/***************************************************************************
+ *   Copyright (C) 2007-2022 by Giovanni Venturi                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Steet, Fifth Floor, Boston, MA  02110-1301, USA.          *
+ ***************************************************************************/
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QVector>
+
+#include "runstate.h"
+
+/**
+ * This class describes a parameter sweep: the same script is executed once
+ * for each point of the sweep. Each axis of the sweep is a list of values for
+ * the parameters line or for an environment variable. The points are all the
+ * combinations of the values (\ref Product) or the values at the same position
+ * of each axis (\ref List).
+ *
+ * The points are numbered from 0: with the Product mode the last axis changes
+ * first (see \ref ScriptJob::expandSweep())
+ *
+ * @author Giovanni Venturi
+ */
+class Sweep
+{
+  public:
+    /**
+     * How the values of the axes are combined
+     */
+    enum Mode
+    {
+      Product,        // every combination of the values
+      List            // the i-th value of every axis
+    };
+
+    /**
+     * Create an empty sweep: the script is executed just once
+     */
+    Sweep();
+
+    /**
+     * Convert the name of a mode: "product" or "list"
+     *
+     * @param name is the name of the mode
+     * @param mode is set to the mode if the name is valid
+     *
+     * @returns false if the name is not valid
+     */
+    static bool parseMode(const QString& name, Mode *mode);
+
+    /**
+     * @returns the name of a mode: "product" or "list"
+     */
+    static QString modeName(Mode mode);
+
+    /**
+     * Assign how the values of the axes are combined
+     */
+    void setMode(Mode mode);
+
+    /**
+     * @returns how the values of the axes are combined
+     */
+    Mode mode() const;
+
+    /**
+     * Add an axis of values appended to the parameters line
+     *
+     * @param values are the values, each one with one or more parameters
+     */
+    void addParameters(const QStringList& values);
+
+    /**
+     * Add an axis of values of an environment variable
+     *
+     * @param name is the environment variable name
+     * @param values are the values of the variable
+     */
+    void addEnvironment(const QString& name, const QStringList& values);
+
+    /**
+     * @returns true if the sweep has no axis
+     */
+    bool isEmpty() const;
+
+    /**
+     * @returns the number of axes
+     */
+    int axisCount() const;
+
+    /**
+     * @returns the environment variable name of an axis, empty for the parameters line
+     */
+    QString axisName(int axis) const;
+
+    /**
+     * @returns the values of an axis
+     */
+    QStringList axisValues(int axis) const;
+
+    /**
+     * @returns the number of points: with the List mode the shortest axis counts
+     */
+    int count() const;
+
+    /**
+     * @returns the value of each axis at a point
+     *
+     * @param index is the point number, from 0 to \ref count() - 1
+     */
+    QStringList point(int index) const;
+
+    /**
+     * @returns a point in a readable form: "-O2 THREADS=4"
+     *
+     * @param index is the point number, from 0 to \ref count() - 1
+     */
+    QString label(int index) const;
+
+  private:
+    /**
+     * How the values are combined
+     */
+    Mode m_mode;
+
+    /**
+     * The axes: environment variable name (empty for the parameters line) and values
+     */
+    QList<QPair<QString, QStringList> > m_axes;
+};
+
+
+/**
+ * This class collects the outcome of every point of a sweep, and saves them
+ * together beside the logs of the points when the last one ends
+ *
+ * @author Giovanni Venturi
+ */
+class SweepReport
+{
+  public:
+    /**
+     * Create the report of a sweep whose points are not ended yet
+     *
+     * @param fileName is the file where the report is saved
+     * @param script is the absolute file path of the script
+     * @param count is the number of points
+     */
+    SweepReport(const QString& fileName, const QString& script, int count);
+
+    /**
+     * @returns the file where the report is saved
+     */
+    QString fileName() const;
+
+    /**
+     * Record how a point ended
+     *
+     * @param index is the point number
+     * @param label is the point in a readable form (see \ref Sweep::label())
+     * @param status is the outcome: passed, failed, timed out or skipped
+     * @param code is the exit code of the script
+     * @param duration is the milliseconds the point took
+     * @param median is the median elapsed time in benchmark mode, a negative value otherwise
+     */
+    void setOutcome(int index, const QString& label, RunState::Status status, int code, qint64 duration, double median);
+
+    /**
+     * @returns true if all the points ended
+     */
+    bool complete() const;
+
+    /**
+     * @returns the number of the ended points with an outcome
+     */
+    int count(RunState::Status status) const;
+
+    /**
+     * @returns the outcome of the whole sweep: failed, timed out or skipped if a point
+     * was, in this order, else passed
+     */
+    RunState::Status outcome() const;
+
+    /**
+     * @returns the outcomes in a readable form: "64 jobs: 60 passed, 4 failed"
+     */
+    QString summary() const;
+
+    /**
+     * Write the report: the script, the counts and the outcome of each point
+     *
+     * @returns false if the file cannot be written
+     */
+    bool save() const;
+
+  private:
+    /**
+     * The outcome of a point
+     */
+    struct Point
+    {
+      Point() : status(RunState::NotRun), code(0), duration(0), median(-1) {}
+
+      RunState::Status status;  // NotRun until the point ends
+      int code;                 // the exit code
+      qint64 duration;          // the milliseconds the point took
+      double median;            // the benchmark median, negative if not a benchmark
+      QString label;            // the values of the point
+    };
+
+    /**
+     * The report file
+     */
+    QString m_fileName;
+
+    /**
+     * The absolute file path of the script
+     */
+    QString m_script;
+
+    /**
+     * The outcome of each point
+     */
+    QVector<Point> m_points;
+
+    /**
+     * The number of ended points
+     */
+    int m_ended;
+};
+
+#endif
@@ -24,11 +24,15 @@
 
 #include "textedit.h"
 #include "scriptprocess.h"
+#include "outputcoalescer.h"
 
 TextEdit::TextEdit(ScriptProcess* proc, QWidget *parent)
-  : QTextEdit(parent), m_proc(proc)
+  : ConsoleView(parent), m_proc(proc)
 {
   setFont( QFont("Courier", 10) ); //Tahoma
+
+  // the console reloads the whole output when it's shown: nothing to keep while it's hidden
+  m_output = new OutputCoalescer(this, true);
 }
 
 
@@ -40,7 +44,7 @@ ScriptProcess *TextEdit::process() const
 
 void TextEdit::mousePressEvent( QMouseEvent* event )
 {
-  QTextEdit::mousePressEvent(event);
+  ConsoleView::mousePressEvent(event);
   if ((event->button() == Qt::LeftButton) && (m_proc->isRunning()))
   {
     bool ok;
@@ -48,9 +52,10 @@ void TextEdit::mousePressEvent( QMouseEvent* event )
       tr("Type the text you want to send to the script"), QLineEdit::Normal, "", &ok);
     if (ok && !text.isEmpty() && m_proc)
     {
+      m_output->flush();
       append( text );
       text += "\n";
-      qint64 err = m_proc->write(text.toLocal8Bit());
+      qint64 err = m_proc->sendInput(text.toLocal8Bit());
       if (err == -1)
         QMessageBox::critical(0, tr("Writing Error"),
           tr("An error occurred writing to %1 script stdout").arg(m_proc->name()));
@@ -61,5 +66,49 @@ void TextEdit::mousePressEvent( QMouseEvent* event )
 
 void TextEdit::assignScriptProcess(ScriptProcess* script)
 {
+  // stop showing the output of the previous script
+  if (m_proc)
+  {
+    disconnect(m_proc, SIGNAL(outputText(QString)), m_output, SLOT(append(QString)));
+    disconnect(m_proc, SIGNAL(executed(ScriptProcess*)), this, SLOT(showUsage()));
+  }
+  m_output->clear();
+
   m_proc = script;
+  if (m_proc)
+  {
+    connect(m_proc, SIGNAL(outputText(QString)), m_output, SLOT(append(QString)));
+    connect(m_proc, SIGNAL(executed(ScriptProcess*)), SLOT(showUsage()));
+  }
+  showUsage();
+}
+
+
+void TextEdit::showUsage() // SLOT
+{
+  // nothing to show until an execution ended
+  if (!m_proc || (m_proc->usage().wallTime() == 0))
+  {
+    setHeader(QString());
+    return;
+  }
+
+  ResourceUsage usage = m_proc->usage();
+  QString text = tr("Run %1 of %2: exit code %3, %4 s elapsed")
+    .arg(m_proc->executedTimes()).arg(m_proc->times()).arg(m_proc->returnCode())
+    .arg(usage.wallTime() / 1000.0, 0, 'f', 3);
+  if (usage.isValid())
+    text += tr(", CPU %1 s user + %2 s system, max RSS %3 MiB, page faults %4 minor + %5 major, "
+               "disk %6 KiB read + %7 KiB written")
+      .arg(usage.userTime() / 1000000.0, 0, 'f', 3).arg(usage.systemTime() / 1000000.0, 0, 'f', 3)
+      .arg(usage.maxRss() / 1024.0, 0, 'f', 1)
+      .arg(usage.minorFaults()).arg(usage.majorFaults())
+      .arg(usage.readBytes() / 1024).arg(usage.writtenBytes() / 1024);
+  else
+    text += tr(", CPU and memory usage not available");
+
+  // the statistics are ready after the last run
+  if (m_proc->isBenchmark() && (m_proc->executedTimes() == m_proc->times()))
+    text += "\n" + m_proc->benchmark().summary();
+  setHeader(text);
 }
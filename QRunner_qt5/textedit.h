@@ -20,9 +20,10 @@
 #ifndef TEXTEDIT_H
 #define TEXTEDIT_H
 
-#include <QtWidgets/QTextEdit>
+#include "consoleview.h"
 
 class ScriptProcess;
+class OutputCoalescer;
 
 /**
  * This class define Text Area that show the temporary standard output
@@ -30,7 +31,7 @@ class ScriptProcess;
  *
  * @author Giovanni Venturi
  */
-class TextEdit : public QTextEdit
+class TextEdit : public ConsoleView
 {
   Q_OBJECT
   public:
@@ -43,7 +44,7 @@ class TextEdit : public QTextEdit
     TextEdit(ScriptProcess* proc = 0, QWidget *parent = 0);
 
     /**
-     * Assign the Scrip Process to the Text Area
+     * Assign the Scrip Process to the Text Area: its new output is appended to the area
      *
      * @param script is the script that need to show its error/output messages
      */
@@ -60,11 +61,22 @@ class TextEdit : public QTextEdit
      */
     virtual void mousePressEvent( QMouseEvent* event );
 
+  private slots:
+    /**
+     * Show in the header the resources used by the last execution of the script
+     */
+    void showUsage();
+
   private:
     /**
      * The Process Script reference
      */
     ScriptProcess* m_proc;
+
+    /**
+     * Collect the script output and show it once per frame
+     */
+    OutputCoalescer *m_output;
 };
 
 #endif
@@ -23,21 +23,83 @@
 #include <QtCore/QDebug>
 
 #include "texteditmonitor.h"
-#include "treewidgetitem.h"
+#include "scriptmodel.h"
 #include "scripttree.h"
+#include "outputcoalescer.h"
+#include "scriptprocess.h"
+#include "processsampler.h"
 
 TextEditMonitor::TextEditMonitor(QWidget *parent)
-  : QTextEdit(parent)
+  : ConsoleView(parent)
 {
   setFont(QFont("Courier", 20));
+  setAcceptDrops(true);
+  viewport()->setAcceptDrops(true);
+
+  // the output received while the Monitor View is closed is shown when it's opened
+  m_output = new OutputCoalescer(this, false);
+
+  // the sampler tells from its thread: the header is updated in the GUI one
+  connect(ProcessSampler::instance(), SIGNAL(sampled()), this, SLOT(showSample()), Qt::QueuedConnection);
 }
 
 
-void TextEditMonitor::dropEvent(QDropEvent* event)
+void TextEditMonitor::monitorProcess(ScriptProcess *proc)
+{
+  if (!m_process.isNull())
+    disconnect(m_process, SIGNAL(executed(ScriptProcess*)), this, SLOT(showSample()));
+
+  // the header is cleared as soon as an execution ends
+  m_process = proc;
+  connect(m_process, SIGNAL(executed(ScriptProcess*)), this, SLOT(showSample()));
+  showSample();
+}
+
+
+void TextEditMonitor::appendOutput(const QString& text) // SLOT
+{
+  m_output->append(text);
+}
+
+
+void TextEditMonitor::showSample() // SLOT
+{
+  ProcessSampler::Sample sample;
+  if (m_process.isNull() || !ProcessSampler::instance()->sample(m_process->pid(), &sample))
+  {
+    setHeader(QString());
+    return;
+  }
+
+  setHeader(tr("%1: CPU %2%, RSS %3 MiB, %4 threads, %5 processes")
+    .arg(m_process->name())
+    .arg(sample.cpu, 0, 'f', 1)
+    .arg(sample.rss / 1048576.0, 0, 'f', 1)
+    .arg(sample.threads)
+    .arg(sample.processes));
+}
+
+
+void TextEditMonitor::dragEnterEvent(QDragEnterEvent* event)
+{
+  if (event->source() != NULL)
+    event->acceptProposedAction();
+}
+
+
+void TextEditMonitor::dragMoveEvent(QDragMoveEvent* event)
 {
   if (event->source() != NULL)
+    event->acceptProposedAction();
+}
+
+
+void TextEditMonitor::dropEvent(QDropEvent* event)
+{
+  ScriptTree *tree = qobject_cast<ScriptTree*>(event->source());
+  if (tree != NULL)
   {
-    if (((ScriptTree*)event->source())->draggingItem()->isFile())
-      emit droppedTreeWidgetItem(((ScriptTree*)event->source())->draggingItem(), this);
+    if (tree->scriptModel()->isFile(tree->draggingNode()))
+      emit droppedScript(tree->draggingNode(), this);
   }
 }
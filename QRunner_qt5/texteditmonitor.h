@@ -20,9 +20,12 @@
 #ifndef TEXTEDITMONITOR_H
 #define TEXTEDITMONITOR_H
 
-#include <QtWidgets/QTextEdit>
+#include <QtCore/QPointer>
 
-class TreeWidgetItem;
+#include "consoleview.h"
+
+class OutputCoalescer;
+class ScriptProcess;
 
 /**
  * This class define Text Area that show the temporary standard output and
@@ -30,7 +33,7 @@ class TreeWidgetItem;
  *
  * @author Giovanni Venturi
  */
-class TextEditMonitor : public QTextEdit
+class TextEditMonitor : public ConsoleView
 {
   Q_OBJECT
   public:
@@ -41,14 +44,56 @@ class TextEditMonitor : public QTextEdit
      */
     TextEditMonitor(QWidget *parent = 0);
 
+    /**
+     * Show above the output the CPU and the memory the script is using while it runs
+     *
+     * @param proc is the monitored Script Process
+     */
+    void monitorProcess(ScriptProcess *proc);
+
+  public slots:
+    /**
+     * Show the output of the monitored script: it's inserted once per frame
+     *
+     * @param text is the text written by the script
+     */
+    void appendOutput(const QString& text);
+
+  private slots:
+    /**
+     * Show the last values measured for the monitored script
+     */
+    void showSample();
+
   protected:
+    /**
+     * Accept the scripts dragged from the Script Tree
+     */
+    virtual void dragEnterEvent( QDragEnterEvent* event );
+
+    /**
+     * Accept the scripts dragged from the Script Tree
+     */
+    virtual void dragMoveEvent( QDragMoveEvent* event );
+
     /**
      * Capture the mouse drop events of the widget
      */
     virtual void dropEvent( QDropEvent* event );
 
+  private:
+    /**
+     * Collect the script output and show it once per frame
+     */
+    OutputCoalescer *m_output;
+
+    /**
+     * The monitored Script Process, null when it has been deleted
+     */
+    QPointer<ScriptProcess> m_process;
+
   signals:
-    void droppedTreeWidgetItem(TreeWidgetItem*, TextEditMonitor*);
+    void droppedScript(int, TextEditMonitor*);
 };
 
 #endif